@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 outColor;
+
+uniform sampler2D textureSampler;
+
+in vec2 textureCoord;
+// Sky and block light from 0 to 1
+in vec2 light;
+// 0 for a corner hidden between blocks to 1 for an open one
+in float occlusion;
+
+void main(){
+	// Every light level is 80% as bright as the one above it, with a little ambient light in the dark
+	float level = max(light.x, light.y);
+	float brightness = mix(0.05, 1.0, pow(0.8, 15.0 * (1.0 - level)));
+	brightness *= mix(0.45, 1.0, occlusion);
+
+	vec4 color = texture(textureSampler, textureCoord);
+	outColor = vec4(color.rgb * brightness, color.a);
+}
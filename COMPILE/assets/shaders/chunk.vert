@@ -0,0 +1,45 @@
+#version 330
+
+#extension GL_ARB_enhanced_layouts : enable
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+// Position in the section in xyz and the face in w, axis * 2 + 1 when looking along +axis
+layout(location = 0) in uvec4 inPosition;
+// Sky light, block light and ambient occlusion
+layout(location = 1) in vec3 inLight;
+// Position of the section in sections, once per instance
+layout(location = 2) in ivec4 inSection;
+
+out vec2 textureCoord;
+out vec2 light;
+out float occlusion;
+
+layout(binding = 1) uniform VP{
+	mat4 view;
+	mat4 proj;
+}vp;
+
+
+void main(){  
+	vec3 position = vec3(inPosition.xyz);
+	gl_Position = vp.proj * vp.view * vec4(position + vec3(inSection.xyz * 16), 1.0);
+
+	// The texture repeats once per block across the two axes spanning the face
+	uint axis = inPosition.w >> 1u;
+	if (axis == 0u)
+	{
+		textureCoord = position.yz;
+	}
+	else if (axis == 1u)
+	{
+		textureCoord = position.zx;
+	}
+	else
+	{
+		textureCoord = position.xy;
+	}
+
+	light = inLight.xy;
+	occlusion = inLight.z;
+}
@@ -14,13 +14,36 @@ layout(binding = 1) uniform VP{
 	mat4 proj;
 }vp;
 
+// One matrix per instance, the renderer defines which kind of buffer holds them
+#if defined(VIKING_INSTANCE_SSBO)
+layout(std430, binding = 2) readonly buffer Model{
+	mat4 model[];
+}model;
+
+mat4 getModel(){
+	return model.model[gl_InstanceID];
+}
+#elif defined(VIKING_INSTANCE_TBO)
+// Four RGBA32F texels per matrix, one per column
+layout(binding = 2) uniform samplerBuffer model;
+
+mat4 getModel(){
+	int base = gl_InstanceID * 4;
+	return mat4(texelFetch(model, base), texelFetch(model, base + 1), texelFetch(model, base + 2), texelFetch(model, base + 3));
+}
+#else
 layout(binding = 2) uniform Model{
 	mat4 model[512];
 }model;
 
+mat4 getModel(){
+	return model.model[gl_InstanceID];
+}
+#endif
+
 
 void main(){  
-	mat4 MVP = vp.proj * vp.view * model.model[gl_InstanceID];
+	mat4 MVP = vp.proj * vp.view * getModel();
 	gl_Position = MVP * vec4(inPosition, 1.0);
 
 	textureCoord = inTextureCoord;
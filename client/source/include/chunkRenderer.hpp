@@ -0,0 +1,147 @@
+#pragma once
+
+#include <viking/IRenderer.hpp>
+#include <viking/IGraphicsPipeline.hpp>
+
+#include <world/chunk.hpp>
+#include <world/world.hpp>
+#include <world/meshingPool.hpp>
+#include <world/chunkManager.hpp>
+#include <util/frustum.hpp>
+
+#include <glm/glm.hpp>
+
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Owns the GPU side of every chunk section, meshes are built on worker threads
+// and handed to the renderer a few at a time, which uploads them when it next draws.
+// All section meshes share one mesh batch on the chunk pipeline, every frame it is
+// handed just the sections that are inside the view frustum and can be seen from the
+// camera through open sections, so caves behind solid ground are never drawn.
+class ChunkRenderer
+{
+  public:
+	struct CullingStats
+	{
+		unsigned int tested;
+		// Sections the search from the camera reached, 0 when it was skipped
+		unsigned int reachable;
+		unsigned int visible;
+		float cull_ms;
+	};
+
+	// max_meshing limits how many sections are meshed at once, which also bounds how many
+	// finished meshes can be waiting to be uploaded
+	ChunkRenderer(viking::IRenderer *renderer, viking::IGraphicsPipeline *pipeline, viking::VertexBufferBase *vertex,
+				  viking::ITextureBuffer *texture, viking::IUniformBuffer *camera, unsigned int max_meshing = 64);
+	~ChunkRenderer();
+
+	// Queue every section the world has marked dirty since the last call for meshing and start meshing
+	// the ones nearest to the viewer while there is room, returns immediately
+	void remeshDirty(qore::world::World &world, const glm::vec3 &viewer);
+
+	// Upload finished meshes until the budget (in milliseconds) is used up, call once per frame
+	void uploadMeshes(float budget_ms);
+
+	// Stop drawing an unloaded chunk, each section's mesh is removed from the batch and its range in the
+	// batch's arenas freed. If every section of the chunk is up to date its meshes are handed to the cache.
+	void removeChunk(qore::world::ChunkPos position, qore::world::ChunkCache *cache = nullptr);
+
+	// Queue the meshes of a chunk restored from the cache for upload instead of remeshing it
+	void restoreChunk(qore::world::RestoredMeshes &restored);
+
+	// Submit the sections that intersect the frustum of projection * view and are not hidden behind
+	// solid sections, call once per frame before rendering
+	void cull(const glm::mat4 &view_projection, const qore::world::World &world, const glm::vec3 &camera_position);
+
+	// Occlusion culling can be turned off to compare against frustum culling alone
+	void setOcclusionCulling(bool enabled);
+
+	// Sections waiting to be meshed or uploaded
+	unsigned int getPendingCount() const;
+
+	// Results of the last call to cull
+	const CullingStats &getCullingStats() const;
+
+  private:
+	// Per instance data of a section pool, the section's position in sections rather than a model matrix
+	struct SectionInstance
+	{
+		int16_t x;
+		int16_t y;
+		int16_t z;
+		// Keeps the attribute 8 byte aligned
+		int16_t padding;
+	};
+
+	struct SectionRenderData
+	{
+		qore::world::SectionPos position;
+		qore::world::ChunkMesh mesh;
+		SectionInstance instance;
+		// Id of the section's mesh in m_batch while attached
+		unsigned int batch_mesh;
+		bool attached;
+		// Position in m_drawable and m_bounds while attached
+		size_t draw_index;
+	};
+
+	void upload(qore::world::MeshResult &result);
+	void attach(SectionRenderData *section, const glm::vec3 &min, const glm::vec3 &max);
+	void detach(SectionRenderData *section);
+
+	qore::world::SectionVisibility getVisibility(const qore::world::SectionPos &position) const;
+	void setVisibility(const qore::world::SectionPos &position, qore::world::SectionVisibility visibility);
+	// Fills m_reachable, returns false if the camera is not in a loaded section
+	bool findReachable(const qore::util::Frustum &frustum, const qore::world::World &world, const glm::vec3 &camera_position);
+	bool isChunkPending(qore::world::ChunkPos position) const;
+
+	viking::IRenderer *m_renderer;
+	viking::IGraphicsPipeline *m_pipeline;
+	viking::VertexBufferBase *m_vertex;
+	viking::VertexBufferBase m_instance;
+	viking::ITextureBuffer *m_texture;
+	viking::IUniformBuffer *m_camera;
+
+	qore::world::MeshingPool m_meshing_pool;
+	unsigned int m_max_meshing;
+	// Dirty sections that have not been handed to the meshing pool yet
+	std::unordered_set<qore::world::SectionPos, qore::world::SectionPosHash> m_waiting;
+
+	std::unordered_map<qore::world::SectionPos, SectionRenderData *, qore::world::SectionPosHash> m_sections;
+	// Holds the meshes of every attached section, drawn together
+	viking::IMeshBatch *m_batch;
+	viking::RenderQueue::Recorder *m_recorder;
+
+	// Sections with something to draw and their world space bounds, kept densely packed for culling
+	std::vector<SectionRenderData *> m_drawable;
+	qore::util::AabbList m_bounds;
+	std::vector<uint32_t> m_visible;
+	std::vector<unsigned int> m_draw_list;
+	CullingStats m_culling_stats;
+
+	// Only sections that block some line of sight are stored, anything else sees through every face
+	std::unordered_map<qore::world::SectionPos, qore::world::SectionVisibility, qore::world::SectionPosHash> m_visibility;
+	bool m_occlusion_culling;
+
+	struct SearchStep
+	{
+		qore::world::SectionPos position;
+		// Face the search came in through, -1 for the camera's section
+		int entered;
+		// Bit per Face the search has moved towards so far, it never turns back
+		unsigned int directions;
+	};
+	std::vector<SearchStep> m_search;
+	std::unordered_set<qore::world::SectionPos, qore::world::SectionPosHash> m_reachable;
+	// The ticket of the newest mesh requested for each section, older results are thrown away
+	std::unordered_map<qore::world::SectionPos, std::uint64_t, qore::world::SectionPosHash> m_tickets;
+
+	// Meshes restored from the cache, uploaded before anything from the meshing pool
+	std::deque<qore::world::MeshResult> m_restored;
+	// Restored meshes get tickets from the top half of the range so they never match a meshing pool ticket
+	std::uint64_t m_next_restored_ticket;
+};
@@ -0,0 +1,397 @@
+#include <chunkRenderer.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace viking;
+using namespace qore;
+
+ChunkRenderer::ChunkRenderer(IRenderer *renderer, IGraphicsPipeline *pipeline, VertexBufferBase *vertex,
+							 ITextureBuffer *texture, IUniformBuffer *camera, unsigned int max_meshing)
+	: m_renderer(renderer), m_pipeline(pipeline), m_vertex(vertex), m_texture(texture), m_camera(camera),
+	  m_max_meshing(max_meshing), m_culling_stats(), m_occlusion_culling(true),
+	  m_next_restored_ticket(std::uint64_t(1) << 63)
+{
+	// Read by chunk.vert as an ivec4 at location 2
+	m_instance = {{{2, sizeof(SectionInstance), 0, VertexType::SHORT, VertexMode::INTEGER}}, sizeof(SectionInstance)};
+
+	m_batch = m_renderer->createMeshBatch(m_vertex, &m_instance);
+	m_batch->attachBuffer(m_texture);
+	m_batch->attachBuffer(m_camera);
+
+	// The batch is submitted by cull each frame instead of staying attached to the pipeline
+	m_recorder = m_renderer->getRenderQueue()->createRecorder();
+}
+
+ChunkRenderer::~ChunkRenderer()
+{
+	for (auto section : m_sections)
+	{
+		delete section.second;
+	}
+	delete m_batch;
+}
+
+void ChunkRenderer::remeshDirty(world::World &world, const glm::vec3 &viewer)
+{
+	for (const world::SectionPos &position : world.takeDirtySections())
+	{
+		m_waiting.insert(position);
+	}
+
+	const unsigned int in_flight = m_meshing_pool.getInFlightCount();
+	if (m_waiting.empty() || in_flight >= m_max_meshing)
+	{
+		return;
+	}
+
+	std::vector<world::SectionPos> order(m_waiting.begin(), m_waiting.end());
+	const size_t count = std::min<size_t>(order.size(), m_max_meshing - in_flight);
+
+	auto distance = [&viewer](const world::SectionPos &position) {
+		const glm::vec3 centre = (glm::vec3(position.x, position.y, position.z) + 0.5f) * float(world::SECTION_SIZE);
+		const glm::vec3 offset = centre - viewer;
+		return glm::dot(offset, offset);
+	};
+	std::partial_sort(order.begin(), order.begin() + count, order.end(),
+					  [&distance](const world::SectionPos &a, const world::SectionPos &b) { return distance(a) < distance(b); });
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const world::SectionPos &position = order[i];
+		m_waiting.erase(position);
+
+		const world::ChunkNeighbourhood neighbourhood = world.getNeighbourhood({position.x, position.z});
+		if (neighbourhood.centre == nullptr)
+		{
+			continue;
+		}
+
+		// An empty section with nothing on screen has nothing to update
+		if (neighbourhood.centre->getSection(position.y).isEmpty() && m_sections.find(position) == m_sections.end())
+		{
+			m_tickets.erase(position);
+			m_visibility.erase(position);
+			continue;
+		}
+
+		m_tickets[position] = m_meshing_pool.submit(neighbourhood, position.y);
+	}
+}
+
+void ChunkRenderer::uploadMeshes(float budget_ms)
+{
+	typedef std::chrono::steady_clock clock;
+	const clock::time_point deadline = clock::now() + std::chrono::microseconds(static_cast<long long>(budget_ms * 1000.0f));
+
+	while (clock::now() < deadline && !m_restored.empty())
+	{
+		upload(m_restored.front());
+		m_restored.pop_front();
+	}
+
+	world::MeshResult result;
+	while (clock::now() < deadline && m_meshing_pool.popCompleted(result))
+	{
+		upload(result);
+	}
+}
+
+void ChunkRenderer::removeChunk(world::ChunkPos position, world::ChunkCache *cache)
+{
+	// Meshes are only worth keeping if none of them is about to be replaced
+	const bool keep_meshes = cache != nullptr && !isChunkPending(position);
+	std::array<world::ChunkMesh, world::SECTION_COUNT> meshes;
+
+	for (int y = 0; y < world::SECTION_COUNT; y++)
+	{
+		const world::SectionPos section_position = {position.x, y, position.z};
+		m_waiting.erase(section_position);
+		// Meshes still being built for the chunk are thrown away when they arrive
+		m_tickets.erase(section_position);
+
+		if (keep_meshes)
+		{
+			meshes[y].visibility = getVisibility(section_position);
+		}
+		m_visibility.erase(section_position);
+
+		auto existing = m_sections.find(section_position);
+		if (existing == m_sections.end())
+		{
+			continue;
+		}
+
+		SectionRenderData *section = existing->second;
+		if (section->attached)
+		{
+			detach(section);
+		}
+		if (keep_meshes)
+		{
+			meshes[y].vertices = std::move(section->mesh.vertices);
+			meshes[y].indices = std::move(section->mesh.indices);
+		}
+		delete section;
+		m_sections.erase(existing);
+	}
+
+	if (keep_meshes)
+	{
+		cache->insertMeshes(position, std::move(meshes));
+	}
+}
+
+void ChunkRenderer::restoreChunk(world::RestoredMeshes &restored)
+{
+	for (int y = 0; y < world::SECTION_COUNT; y++)
+	{
+		const world::SectionPos position = {restored.position.x, y, restored.position.z};
+
+		// Solid sections have no geometry but still hide what is behind them
+		setVisibility(position, restored.meshes[y].visibility);
+		if (restored.meshes[y].isEmpty())
+		{
+			continue;
+		}
+		world::MeshResult result;
+		result.chunk = restored.position;
+		result.section = y;
+		result.ticket = m_next_restored_ticket++;
+		result.mesh = std::move(restored.meshes[y]);
+
+		m_tickets[position] = result.ticket;
+		m_restored.push_back(std::move(result));
+	}
+}
+
+unsigned int ChunkRenderer::getPendingCount() const
+{
+	return static_cast<unsigned int>(m_waiting.size() + m_restored.size()) + m_meshing_pool.getInFlightCount();
+}
+
+bool ChunkRenderer::isChunkPending(world::ChunkPos position) const
+{
+	for (int y = 0; y < world::SECTION_COUNT; y++)
+	{
+		const world::SectionPos section_position = {position.x, y, position.z};
+		if (m_waiting.count(section_position) != 0 || m_tickets.count(section_position) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ChunkRenderer::upload(world::MeshResult &result)
+{
+	const world::SectionPos position = {result.chunk.x, result.section, result.chunk.z};
+
+	// Skip meshes that were replaced by a newer request while they were being built
+	auto ticket = m_tickets.find(position);
+	if (ticket == m_tickets.end() || ticket->second != result.ticket)
+	{
+		return;
+	}
+	m_tickets.erase(ticket);
+
+	setVisibility(position, result.mesh.visibility);
+
+	auto existing = m_sections.find(position);
+	SectionRenderData *section = existing == m_sections.end() ? nullptr : existing->second;
+
+	if (result.mesh.isEmpty())
+	{
+		// Keep the section around in case blocks are placed here again, just stop drawing it
+		if (section != nullptr)
+		{
+			section->mesh.clear();
+			if (section->attached)
+			{
+				detach(section);
+			}
+		}
+		return;
+	}
+
+	if (section == nullptr)
+	{
+		section = new SectionRenderData();
+		section->position = position;
+		section->instance = {static_cast<int16_t>(position.x), static_cast<int16_t>(position.y), static_cast<int16_t>(position.z), 0};
+		section->attached = false;
+		m_sections[position] = section;
+	}
+
+	// The old mesh is replaced by the new one, drawing stays attached
+	if (section->attached)
+	{
+		m_batch->removeMesh(section->batch_mesh);
+	}
+	section->mesh = std::move(result.mesh);
+	section->batch_mesh = m_batch->addMesh(section->mesh.vertices.data(), static_cast<unsigned int>(section->mesh.vertices.size()),
+										   section->mesh.indices.data(), static_cast<unsigned int>(section->mesh.indices.size()),
+										   &section->instance);
+
+	glm::vec3 min(world::SECTION_SIZE);
+	glm::vec3 max(0.0f);
+	for (const world::ChunkVertex &vertex : section->mesh.vertices)
+	{
+		min = glm::min(min, vertex.getPosition());
+		max = glm::max(max, vertex.getPosition());
+	}
+	const glm::vec3 origin = glm::vec3(position.x, position.y, position.z) * float(world::SECTION_SIZE);
+	attach(section, origin + min, origin + max);
+}
+
+void ChunkRenderer::attach(SectionRenderData *section, const glm::vec3 &min, const glm::vec3 &max)
+{
+	if (section->attached)
+	{
+		m_bounds.set(section->draw_index, min, max);
+		return;
+	}
+
+	section->attached = true;
+	section->draw_index = m_drawable.size();
+	m_drawable.push_back(section);
+	m_bounds.add(min, max);
+}
+
+void ChunkRenderer::detach(SectionRenderData *section)
+{
+	// The last section takes the place of the removed one in both arrays
+	SectionRenderData *last = m_drawable.back();
+	m_drawable[section->draw_index] = last;
+	last->draw_index = section->draw_index;
+	m_drawable.pop_back();
+	m_bounds.removeSwap(section->draw_index);
+
+	m_batch->removeMesh(section->batch_mesh);
+	section->attached = false;
+}
+
+void ChunkRenderer::cull(const glm::mat4 &view_projection, const world::World &world, const glm::vec3 &camera_position)
+{
+	typedef std::chrono::steady_clock clock;
+	const clock::time_point start = clock::now();
+
+	const util::Frustum frustum(view_projection);
+	const bool occlusion = m_occlusion_culling && findReachable(frustum, world, camera_position);
+
+	m_visible.clear();
+	util::cullAabbs(frustum, m_bounds, m_visible);
+
+	m_draw_list.clear();
+	for (uint32_t index : m_visible)
+	{
+		const SectionRenderData *section = m_drawable[index];
+		if (!occlusion || m_reachable.count(section->position) != 0)
+		{
+			m_draw_list.push_back(section->batch_mesh);
+		}
+	}
+	m_batch->setVisible(m_draw_list);
+	if (!m_draw_list.empty())
+	{
+		// The batch is one opaque draw covering sections at every distance, so it has no depth of its own and
+		// depth 0 sorts it ahead of other draws sharing its pipeline and texture
+		const uint64_t key = RenderQueue::MakeKey(0, m_pipeline->getSortId(), m_batch->GetSortTexture(), 0);
+		m_recorder->draw(key, m_pipeline, m_batch);
+	}
+
+	m_culling_stats.tested = static_cast<unsigned int>(m_drawable.size());
+	m_culling_stats.reachable = occlusion ? static_cast<unsigned int>(m_reachable.size()) : 0;
+	m_culling_stats.visible = static_cast<unsigned int>(m_draw_list.size());
+	m_culling_stats.cull_ms = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+}
+
+void ChunkRenderer::setOcclusionCulling(bool enabled)
+{
+	m_occlusion_culling = enabled;
+}
+
+world::SectionVisibility ChunkRenderer::getVisibility(const world::SectionPos &position) const
+{
+	auto found = m_visibility.find(position);
+	return found == m_visibility.end() ? world::SectionVisibility::all() : found->second;
+}
+
+void ChunkRenderer::setVisibility(const world::SectionPos &position, world::SectionVisibility visibility)
+{
+	if (visibility.isAll())
+	{
+		m_visibility.erase(position);
+	}
+	else
+	{
+		m_visibility[position] = visibility;
+	}
+}
+
+bool ChunkRenderer::findReachable(const util::Frustum &frustum, const world::World &world, const glm::vec3 &camera_position)
+{
+	const glm::ivec3 camera_block = glm::floor(camera_position);
+	const world::ChunkPos camera_chunk = world::World::toChunkPos(camera_block.x, camera_block.z);
+	const world::SectionPos camera_section = {camera_chunk.x, camera_block.y >> 4, camera_chunk.z};
+
+	// Above or below the world, or somewhere not loaded yet, there is nothing to start from
+	if (camera_section.y < 0 || camera_section.y >= world::SECTION_COUNT || world.getChunk(camera_chunk) == nullptr)
+	{
+		return false;
+	}
+
+	static const glm::ivec3 offsets[world::FACE_COUNT] = {
+		{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+	m_reachable.clear();
+	m_search.clear();
+	m_reachable.insert(camera_section);
+	m_search.push_back({camera_section, -1, 0});
+
+	// Breadth first from the camera, a section is only entered through a face that the
+	// section before it can see from the face the search came in through
+	for (size_t next = 0; next < m_search.size(); next++)
+	{
+		const SearchStep step = m_search[next];
+		const world::SectionVisibility visibility = getVisibility(step.position);
+
+		for (int face = 0; face < world::FACE_COUNT; face++)
+		{
+			if ((step.directions & (1u << world::getOppositeFace(face))) != 0)
+			{
+				continue;
+			}
+			if (step.entered >= 0 && !visibility.canSee(step.entered, face))
+			{
+				continue;
+			}
+
+			const world::SectionPos neighbour = {step.position.x + offsets[face].x, step.position.y + offsets[face].y,
+												 step.position.z + offsets[face].z};
+			if (neighbour.y < 0 || neighbour.y >= world::SECTION_COUNT || m_reachable.count(neighbour) != 0)
+			{
+				continue;
+			}
+			if ((neighbour.x != step.position.x || neighbour.z != step.position.z) && world.getChunk({neighbour.x, neighbour.z}) == nullptr)
+			{
+				continue;
+			}
+
+			const glm::vec3 min = glm::vec3(neighbour.x, neighbour.y, neighbour.z) * float(world::SECTION_SIZE);
+			if (!frustum.intersects(min, min + float(world::SECTION_SIZE)))
+			{
+				continue;
+			}
+
+			m_reachable.insert(neighbour);
+			m_search.push_back({neighbour, world::getOppositeFace(face), step.directions | (1u << face)});
+		}
+	}
+	return true;
+}
+
+const ChunkRenderer::CullingStats &ChunkRenderer::getCullingStats() const
+{
+	return m_culling_stats;
+}
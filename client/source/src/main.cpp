@@ -6,46 +6,49 @@
 #include <viking/IUniformBuffer.hpp>
 #include <viking/IComputePipeline.hpp>
 #include <viking/IComputeProgram.hpp>
+#include <viking/null/NullWindow.hpp>
+#include <viking/null/NullRenderer.hpp>
+
+#include <world/world.hpp>
+#include <world/chunkManager.hpp>
+#include <world/regionFile.hpp>
+#include <world/terrainGenerator.hpp>
+#include <gameIOManager.hpp>
+
+#include <chunkRenderer.hpp>
 
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <algorithm>
-#include <experimental/filesystem>
+#include <cstring>
 
 using namespace viking;
-
-struct Vertex
-{
-	Vertex() {}
-	Vertex(glm::vec3 position, glm::vec2 uv) : position(position), uv(uv) {}
-	glm::vec3 position;
-	glm::vec2 uv;
-
-	bool operator==(Vertex v)
-	{
-		return v.position == position && v.uv == uv;
-	}
-};
+using namespace qore;
 
 struct Camera
 {
 	glm::mat4 view;
 	glm::mat4 projection;
+
+	// The view matrix takes world space into camera space, so its inverse places the camera in the world
+	glm::vec3 getPosition() const { return glm::vec3(glm::inverse(view)[3]); }
+	glm::vec3 getForward() const { return -glm::vec3(glm::inverse(view)[2]); }
 };
 
 IRenderer *renderer;
 Camera camera;
-IModelPool *model_pool;
+IGraphicsPipeline *chunk_pipeline;
+VertexBufferBase chunk_vertex;
+ITextureBuffer *texture_buffer;
+IUniformBuffer *camera_buffer;
 
 void SetupCamera()
 {
 	camera.projection = glm::perspective(glm::radians(45.0f), (float)800 / (float)600, 0.1f, 1000.0f);
 
 	camera.view = glm::mat4(1.0f);
-	camera.view = glm::translate(camera.view, glm::vec3(-8.0f, 0.0f, 25.0f));
+	camera.view = glm::translate(camera.view, glm::vec3(8.0f, 80.0f, 8.0f));
 	camera.view = glm::rotate(camera.view, glm::radians(-45.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-	camera.view = glm::rotate(camera.view, glm::radians(80.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	camera.view = glm::rotate(camera.view, glm::radians(-20.0f), glm::vec3(1.0f, 0.0f, 0.0f));
 	camera.view = glm::inverse(camera.view);
 }
 
@@ -95,219 +98,143 @@ ITextureBuffer *loadTexture(const char *path)
 	return renderer->createTextureBuffer(data, width, height);
 }
 
-std::vector<std::string> Split(std::string dec, std::string str)
-{
-	std::vector<std::string> parts;
-	while (true)
-	{
-		int index = static_cast<int>(str.find(dec));
-		if (index == std::string::npos)
-			break;
-		parts.push_back(str.substr(0, index));
-		str.replace(0, index + dec.length(), "");
-	}
-	parts.push_back(str);
-	return parts;
-}
-
-std::vector<std::string> Split(const char *dec, std::string str)
-{
-	std::string s(dec);
-	return Split(s, str);
-}
-
-void LoadOBJ(std::string location, std::vector<uint16_t> &out_vertex_index,
-			 std::vector<Vertex> &out_vertices)
+bool HasArgument(int argc, char *argv[], const char *argument)
 {
-	std::ifstream myfile(location);
-	if (myfile.is_open())
+	for (int i = 1; i < argc; i++)
 	{
-		std::string line;
-		std::vector<glm::vec3> temp_vertices;
-		std::vector<glm::vec2> temp_uvs;
-		std::vector<glm::vec3> temp_normals;
-		std::vector<std::vector<std::string>> temp_faces;
-		while (getline(myfile, line))
-		{
-			std::vector<std::string> parts = Split(" ", line);
-
-			if (line.find("v ") == 0)
-			{
-				if (parts.size() >= 4)
-				{
-					glm::vec3 vertex(::atof(parts[parts.size() - 3].c_str()), ::atof(parts[parts.size() - 2].c_str()), ::atof(parts[parts.size() - 1].c_str()));
-					temp_vertices.push_back(vertex);
-				}
-				else
-				{
-					assert(0 && "Malformed Vertex, attempting to continue");
-				}
-			}
-			else if (line.find("vt ") == 0)
-			{
-				if (parts.size() >= 3)
-				{
-					glm::vec2 vt(::atof(parts[parts.size() - 2].c_str()), ::atof(parts[parts.size() - 1].c_str()));
-					temp_uvs.push_back(vt);
-				}
-				else
-				{
-					assert(0 && "Malformed Vertex Texture, attempting to continue");
-				}
-			}
-			else if (line.find("vn ") == 0)
-			{
-				if (parts.size() >= 4)
-				{
-					glm::vec3 vn(::atof(parts[parts.size() - 3].c_str()), ::atof(parts[parts.size() - 2].c_str()), ::atof(parts[parts.size() - 1].c_str()));
-					temp_normals.push_back(vn);
-				}
-				else
-				{
-					assert(0 && "Malformed Vertex Normal, attempting to continue");
-				}
-			}
-			else if (line.find("f ") == 0)
-			{
-				temp_faces.push_back(parts);
-			}
-		}
-		for (auto parts : temp_faces)
+		if (strcmp(argv[i], argument) == 0)
 		{
-			if (parts.size() >= 4)
-			{
-				std::vector<std::string> face_parts = {parts[1], parts[2], parts[3]};
-				for (int j = 4; j < parts.size(); j++)
-				{
-					face_parts.push_back(parts[1]);
-					face_parts.push_back(parts[j - 1]);
-					face_parts.push_back(parts[j]);
-				}
-
-				for (int j = 0; j < face_parts.size(); j++)
-				{
-					std::vector<std::string> parts2 = Split("/", face_parts[j]);
-					if (parts2.size() != 0)
-					{
-						int requested_vertex = static_cast<int>(::atof(parts2[0].c_str()) - 1);
-						int requested_texture = static_cast<int>((parts2.size() > 1) ? ::atof(parts2[1].c_str()) - 1 : 0);
-						int requested_normal = static_cast<int>((parts2.size() > 2) ? ::atof(parts2[2].c_str()) - 1 : 0);
-
-						auto pair = std::make_pair(requested_texture, requested_normal);
-						glm::vec2 textureCoord(1.0f);
-						if (temp_uvs.size() > requested_texture)
-							textureCoord = temp_uvs[requested_texture];
-
-						Vertex v = {temp_vertices[requested_vertex], textureCoord};
-						auto it = std::find(out_vertices.begin(), out_vertices.end(), v);
-						if (it == out_vertices.end())
-						{
-							out_vertex_index.push_back(static_cast<uint32_t>(out_vertices.size()));
-							out_vertices.push_back(v);
-						}
-						else
-						{
-							int pos = static_cast<int>(std::distance(out_vertices.begin(), it));
-							out_vertex_index.push_back(pos);
-						}
-					}
-				}
-			}
+			return true;
 		}
 	}
+	return false;
 }
 
-class Chunk
-{
-  public:
-	Chunk()
-	{
-		block_buffer = renderer->createUniformBuffer(&block_positions, sizeof(glm::mat4), 16 * 16 * 256, ShaderStage::VERTEX_SHADER, 2);
-
-		model_pool->attachBuffer(0, block_buffer);
-
-		for (int x = 0; x < 16; x++)
-		{
-			for (int y = 0; y < 256; y++)
-			{
-				for (int z = 0; z < 16; z++)
-				{
-					// Create a position for the model
-					glm::mat4 model_position = glm::mat4(1.0f);
-					// Move the model to a location
-					model_position = glm::translate(model_position, glm::vec3(x, y, z));
-
-					// Create a model
-					IModel *model = model_pool->createModel();
-					// Set its data to buffer 0
-					model->SetData(0, &model_position);
-					models.push_back(model);
-				}
-			}
-		}
-	}
-	void Update()
-	{
-		block_buffer->setData();
-	}
-	glm::mat4 block_positions[16 * 16 * 256];
-	IUniformBuffer *block_buffer;
-	std::vector<IModel *> models;
-};
-
 int main(int argc, char *argv[])
 {
 	SetupCamera();
 
-	const RenderingAPI renderingAPI = RenderingAPI::GL3;
-	const WindowingAPI windowAPI = WindowingAPI::SDL;
+	// With --headless nothing is drawn, the null backend only records what would have been sent to the GPU,
+	// so the game side of a frame can be measured without a display
+	const bool headless = HasArgument(argc, argv, "--headless");
+	const RenderingAPI renderingAPI = headless ? RenderingAPI::Null : RenderingAPI::GL3;
+	const WindowingAPI windowAPI = headless ? WindowingAPI::Null : WindowingAPI::SDL;
 
 	IWindow *window = IWindow::createWindow(WindowDescriptor("Sandblox Client", 1280, 720), windowAPI, renderingAPI);
+	if (headless)
+	{
+		static_cast<null::NullWindow *>(window)->setFrameLimit(600);
+	}
 
 	renderer = IRenderer::createRenderer(renderingAPI);
+	renderer->addWindow(window);
 	renderer->start();
 
-	IGraphicsPipeline *pipeline = renderer->createGraphicsPipeline({{ShaderStage::VERTEX_SHADER, "../assets/shaders/shader.vert"},
-																	{ShaderStage::FRAGMENT_SHADER, "../assets/shaders/shader.frag"}});
+	chunk_pipeline = renderer->createGraphicsPipeline({{ShaderStage::VERTEX_SHADER, "../assets/shaders/chunk.vert"},
+													   {ShaderStage::FRAGMENT_SHADER, "../assets/shaders/chunk.frag"}});
+
+	// Chunk vertices are packed bytes, the position and face stay integers while the light
+	// and occlusion reach the shader as 0..1 floats
+	chunk_vertex = {
+		{{0, 4, offsetof(world::ChunkVertex, x), VertexType::UNSIGNED_BYTE, VertexMode::INTEGER},
+		 {1, 3, offsetof(world::ChunkVertex, skyLight), VertexType::UNSIGNED_BYTE, VertexMode::NORMALIZED}},
+		sizeof(world::ChunkVertex)};
 
-	VertexBufferBase vertex = {
-		{{0, sizeof(glm::vec3), offsetof(Vertex, position)},
-		 {1, sizeof(glm::vec2), offsetof(Vertex, uv)}},
-		sizeof(Vertex)};
+	chunk_pipeline->attachVertexBinding(chunk_vertex);
 
-	pipeline->attachVertexBinding(vertex);
+	chunk_pipeline->build();
 
-	pipeline->build();
+	texture_buffer = loadTexture("../assets/textures/cobble.bmp");
 
-	std::vector<Vertex> vertex_data;
-	std::vector<uint16_t> index_data;
+	camera_buffer = renderer->createUniformBuffer(&camera, sizeof(Camera), 1, ShaderStage::VERTEX_SHADER, 1);
 
-	LoadOBJ("../assets/models/cube.obj", index_data, vertex_data);
+	ChunkRenderer *chunk_renderer = new ChunkRenderer(renderer, chunk_pipeline, &chunk_vertex, texture_buffer, camera_buffer);
 
-	IBuffer *vertex_buffer = renderer->createBuffer(vertex_data.data(), sizeof(Vertex), vertex_data.size());
-	IBuffer *index_buffer = renderer->createBuffer(index_data.data(), sizeof(uint16_t), index_data.size());
+	world::World *world = new world::World();
 
-	model_pool = renderer->createModelPool(&vertex, vertex_buffer, index_buffer);
+	// Chunks are generated from the seed alone, so the same seed always gives the same world
+	world::TerrainSettings terrain_settings;
+	terrain_settings.seed = 1;
+	world::TerrainGenerator terrain(terrain_settings);
+	world::ChunkGenerator generator = [&terrain](world::Chunk &chunk) {
+		terrain.generate(chunk);
+	};
 
-	ITextureBuffer *texture_buffer = loadTexture("../assets/textures/cobble.bmp");
-	model_pool->attachBuffer(texture_buffer);
+	world::StreamingSettings streaming;
+	streaming.renderDistance = 8;
+	streaming.unloadMargin = 2;
+	world::ChunkManager *chunk_manager = new world::ChunkManager(*world, generator, streaming);
 
-	IUniformBuffer *camera_buffer = renderer->createUniformBuffer(&camera, sizeof(Camera), 1, ShaderStage::VERTEX_SHADER, 1);
-	model_pool->attachBuffer(camera_buffer);
+	// Chunks that leave the render distance are kept around, compressed once they have been gone a while
+	world::ChunkCache *chunk_cache = new world::ChunkCache(64 * 1024 * 1024);
+	chunk_manager->setCache(chunk_cache);
+
+	// Chunks are saved to region files as they unload and read back before anything is generated
+	game::GameIOManager io;
+	io.init("..");
+	world::RegionStorage *region_storage = new world::RegionStorage(io.getRegionPath("world"));
+	chunk_manager->setStorage(region_storage);
+
+	// With --render-thread the next frame is simulated while the last one is drawn, everything the renderer
+	// needs has been created by now
+	const bool render_thread = HasArgument(argc, argv, "--render-thread");
+	if (render_thread && !renderer->startRenderThread())
+	{
+		std::cout << "Could not start the render thread, rendering on the main thread" << std::endl;
+	}
 
-	Chunk *chunk = new Chunk();
+	// Frame time percentiles and where the time went, logged every 5 seconds
+	FrameProfiler profiler;
+	profiler.setLogInterval(5.0f);
+	renderer->setFrameProfiler(&profiler);
 
-	pipeline->attachModelPool(model_pool);
-	float rot = 0.5f;
 	while (window->isRunning())
 	{
-		chunk->Update();
+		profiler.nextFrame();
+
+		profiler.beginPhase(FramePhase::UPDATE);
+		// Load the chunks around the camera and forget the ones it has moved away from
+		chunk_manager->update(camera.getPosition(), camera.getForward());
+		for (const world::ChunkPos &unloaded : chunk_manager->takeUnloaded())
+		{
+			chunk_renderer->removeChunk(unloaded, chunk_cache);
+		}
+		for (world::RestoredMeshes &restored : chunk_manager->takeRestoredMeshes())
+		{
+			chunk_renderer->restoreChunk(restored);
+		}
+
+		// Block edits and new chunks since the last frame are remeshed together
+		chunk_renderer->remeshDirty(*world, camera.getPosition());
+		// Spend at most a couple of milliseconds a frame uploading new chunk meshes
+		chunk_renderer->uploadMeshes(2.0f);
+		profiler.endPhase(FramePhase::UPDATE);
+
+		// Only sections inside the view frustum that are not buried behind solid ground are drawn
+		profiler.beginPhase(FramePhase::CULL);
+		chunk_renderer->cull(camera.projection * camera.view, *world, camera.getPosition());
+		profiler.endPhase(FramePhase::CULL);
 
 		window->poll();
-		renderer->render();
-		window->swapBuffers();
+		renderer->submitFrame();
+	}
+
+	// GPU resources are freed below, which needs the context back on this thread
+	renderer->stopRenderThread();
+	renderer->setFrameProfiler(nullptr);
+	profiler.log(std::cout);
+	chunk_manager->saveAll();
+
+	if (headless)
+	{
+		static_cast<null::NullRenderer *>(renderer)->dumpLastFrame(std::cout);
 	}
 
+	delete chunk_manager;
+	delete region_storage;
+	delete chunk_cache;
+	delete chunk_renderer;
+	delete world;
 	delete window;
 	delete renderer;
 
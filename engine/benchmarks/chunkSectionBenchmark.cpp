@@ -0,0 +1,218 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "world/chunk.hpp"
+#include <random>
+#include <vector>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Block get, set and fill throughput of palette compressed sections with palettes of
+ * different sizes, next to a flat BlockId array, and the bytes a chunk takes for a few
+ * typical kinds of chunk.
+ */
+
+namespace
+{
+
+const int OPERATIONS = 1 << 20;
+
+struct Position
+{
+    int x;
+    int y;
+    int z;
+};
+
+// Uniform in [0, bound).
+int nextInt(std::mt19937& random, int bound)
+{
+    return std::uniform_int_distribution<int>(0, bound - 1)(random);
+}
+
+// A section holding blockTypes different blocks spread randomly through it.
+void fillRandom(ChunkSection& section, int blockTypes, std::mt19937& random)
+{
+    for (int y = 0; y < SECTION_SIZE; y++)
+    {
+        for (int z = 0; z < SECTION_SIZE; z++)
+        {
+            for (int x = 0; x < SECTION_SIZE; x++)
+            {
+                section.setBlock(x, y, z, static_cast<BlockId>(nextInt(random, blockTypes)));
+            }
+        }
+    }
+}
+
+void benchmarkSection(int blockTypes, const std::vector<Position>& positions, const std::vector<BlockId>& ids)
+{
+    std::mt19937 random(blockTypes);
+    ChunkSection section;
+    fillRandom(section, blockTypes, random);
+
+    const double getMs = bench::timeBest(5, [&]() {
+        unsigned int sum = 0;
+        for (const Position& p : positions)
+        {
+            sum += section.getBlock(p.x, p.y, p.z);
+        }
+        bench::keep(sum);
+    });
+
+    // Only sets blocks already in the palette, so the section keeps its bits per block.
+    const double setMs = bench::timeBest(5, [&]() {
+        for (int i = 0; i < OPERATIONS; i++)
+        {
+            const Position& p = positions[i];
+            section.setBlock(p.x, p.y, p.z, static_cast<BlockId>(ids[i] % blockTypes));
+        }
+    });
+
+    std::printf("%5d block types  %2u bits  get %7.1f M/s  set %7.1f M/s  %6zu bytes\n", blockTypes,
+                section.getBitsPerBlock(), OPERATIONS / getMs / 1000.0, OPERATIONS / setMs / 1000.0,
+                section.getMemoryUsage());
+}
+
+void benchmarkFlat(const std::vector<Position>& positions, const std::vector<BlockId>& ids)
+{
+    std::vector<BlockId> blocks(SECTION_VOLUME);
+
+    const double getMs = bench::timeBest(5, [&]() {
+        unsigned int sum = 0;
+        for (const Position& p : positions)
+        {
+            sum += blocks[ChunkSection::getIndex(p.x, p.y, p.z)];
+        }
+        bench::keep(sum);
+    });
+
+    const double setMs = bench::timeBest(5, [&]() {
+        for (int i = 0; i < OPERATIONS; i++)
+        {
+            const Position& p = positions[i];
+            blocks[ChunkSection::getIndex(p.x, p.y, p.z)] = ids[i];
+        }
+        bench::keep(blocks[0]);
+    });
+
+    std::printf("flat BlockId array      get %7.1f M/s  set %7.1f M/s  %6zu bytes\n", OPERATIONS / getMs / 1000.0,
+                OPERATIONS / setMs / 1000.0, SECTION_VOLUME * sizeof(BlockId));
+}
+
+void benchmarkFill()
+{
+    Chunk chunk({0, 0});
+    const int fills = 1000;
+
+    // Whole sections are replaced without touching single blocks.
+    const double sectionMs = bench::timeBest(5, [&]() {
+        for (int i = 0; i < fills; i++)
+        {
+            chunk.fill(0, 0, 0, 15, 63, 15, static_cast<BlockId>(i % 2 ? STONE : DIRT));
+        }
+    });
+
+    // A box not lined up with the sections takes the per block path.
+    const double boxMs = bench::timeBest(5, [&]() {
+        for (int i = 0; i < fills; i++)
+        {
+            chunk.fill(2, 3, 2, 13, 60, 13, static_cast<BlockId>(i % 2 ? COBBLESTONE : GRASS));
+        }
+    });
+
+    std::printf("fill 16x64x16 (whole sections)  %10.1f ns\n", sectionMs * 1000000.0 / fills);
+    std::printf("fill 12x58x12 (per block)       %10.1f ns\n", boxMs * 1000000.0 / fills);
+}
+
+void reportChunk(const char* name, const Chunk& chunk)
+{
+    std::size_t blockBytes = 0;
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        blockBytes += chunk.getSection(i).getMemoryUsage();
+    }
+    std::printf("%-28s %8zu bytes of blocks  %8zu bytes with light\n", name, blockBytes, chunk.getMemoryUsage());
+}
+
+void benchmarkChunkMemory()
+{
+    Chunk empty({0, 0});
+    reportChunk("empty", empty);
+
+    // Stone, dirt and grass layers under air, like flat generated terrain.
+    Chunk layered({0, 0});
+    layered.fill(0, 0, 0, 15, 59, 15, STONE);
+    layered.fill(0, 60, 0, 15, 62, 15, DIRT);
+    layered.fill(0, 63, 0, 15, 63, 15, GRASS);
+    reportChunk("layered terrain", layered);
+
+    // Every block of the lower half picked at random from the built in types.
+    std::mt19937 random(1);
+    Chunk noisy({0, 0});
+    for (int s = 0; s < SECTION_COUNT / 2; s++)
+    {
+        fillRandom(noisy.getSection(s), BLOCK_COUNT, random);
+    }
+    reportChunk("random lower half", noisy);
+
+    std::printf("%-28s %8zu bytes of blocks\n", "flat BlockId array", CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT * sizeof(BlockId));
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 random(42);
+    std::vector<Position> positions(OPERATIONS);
+    std::vector<BlockId> ids(OPERATIONS);
+    for (int i = 0; i < OPERATIONS; i++)
+    {
+        positions[i] = {nextInt(random, SECTION_SIZE), nextInt(random, SECTION_SIZE), nextInt(random, SECTION_SIZE)};
+        ids[i] = static_cast<BlockId>(nextInt(random, 1 << 16));
+    }
+
+    std::printf("random get/set over %d blocks\n", OPERATIONS);
+    benchmarkFlat(positions, ids);
+    for (int blockTypes : {1, 2, 16, 200, 4096})
+    {
+        benchmarkSection(blockTypes, positions, ids);
+    }
+
+    std::printf("\n");
+    benchmarkFill();
+
+    std::printf("\n");
+    benchmarkChunkMemory();
+    return 0;
+}
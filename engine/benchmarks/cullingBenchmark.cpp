@@ -0,0 +1,120 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "util/frustum.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+
+using namespace qore;
+
+/*
+ * Boxes culled per millisecond by cullAabbs, against testing the same boxes one at a time
+ * with Frustum::intersects. The boxes are chunk sections scattered around the camera, so
+ * roughly a fifth of them end up visible.
+ */
+
+namespace
+{
+
+std::size_t cullScalar(const util::Frustum& frustum, const util::AabbList& boxes, std::vector<std::uint32_t>& visible)
+{
+    const std::size_t before = visible.size();
+    for (std::size_t i = 0; i < boxes.size(); i++)
+    {
+        const glm::vec3 min(boxes.minX[i], boxes.minY[i], boxes.minZ[i]);
+        const glm::vec3 max(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]);
+        if (frustum.intersects(min, max))
+        {
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    return visible.size() - before;
+}
+
+void benchmarkCount(const util::Frustum& frustum, int count)
+{
+    std::mt19937 random(count);
+    std::uniform_int_distribution<int> column(0, 63);
+    std::uniform_int_distribution<int> section(0, 15);
+    util::AabbList boxes;
+    for (int i = 0; i < count; i++)
+    {
+        const int x = column(random) * 16 - 512;
+        const int y = section(random) * 16;
+        const int z = column(random) * 16 - 512;
+        const glm::vec3 min(x, y, z);
+        boxes.add(min, min + glm::vec3(16.0f));
+    }
+
+    std::vector<std::uint32_t> scalarVisible;
+    std::vector<std::uint32_t> simdVisible;
+    scalarVisible.reserve(count);
+    simdVisible.reserve(count);
+
+    // Enough repeats that every measurement covers about a million boxes.
+    const int repeats = std::max(1, (1 << 20) / count);
+    const double scalarMs = bench::timeBest(5, [&]() {
+        for (int r = 0; r < repeats; r++)
+        {
+            scalarVisible.clear();
+            cullScalar(frustum, boxes, scalarVisible);
+        }
+    });
+    const double simdMs = bench::timeBest(5, [&]() {
+        for (int r = 0; r < repeats; r++)
+        {
+            simdVisible.clear();
+            util::cullAabbs(frustum, boxes, simdVisible);
+        }
+    });
+
+    const double scalarRate = double(count) * repeats / scalarMs;
+    const double simdRate = double(count) * repeats / simdMs;
+    std::printf("%7d boxes  %6zu visible  scalar %8.0f boxes/ms  %-6s %8.0f boxes/ms  %5.2fx%s\n", count,
+                simdVisible.size(), scalarRate, util::getCullingBackend(), simdRate, simdRate / scalarRate,
+                simdVisible == scalarVisible ? "" : "  RESULTS DIFFER");
+}
+
+} // namespace
+
+int main()
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 80.0f, 0.0f), glm::vec3(100.0f, 60.0f, 30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const util::Frustum frustum(projection * view);
+
+    for (int count : {256, 4096, 65536, 1 << 20})
+    {
+        benchmarkCount(frustum, count);
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "world/world.hpp"
+#include <algorithm>
+#include <memory>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Relighting after a torch is placed in and then removed from a cave that is already lit by
+ * other torches and by sky light coming down a shaft, the removal search has to hand the
+ * edge of the cleared area back to the light that was already there.
+ */
+
+namespace
+{
+
+const int SIDE = 5;
+const int GROUND = 100;
+
+// The cave in world block coordinates, inclusive.
+const int CAVE_MIN = 8;
+const int CAVE_MAX = SIDE * 16 - 9;
+const int CAVE_FLOOR = 40;
+const int CAVE_ROOF = 52;
+// On the border between chunks, so light around it spreads into four of them.
+const int MIDDLE = (SIDE / 2 + 1) * 16;
+
+// Fills the local box of the chunk that the world box covers, if any.
+void carve(Chunk& chunk, int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockId id)
+{
+    const int baseX = chunk.getPosition().x * 16;
+    const int baseZ = chunk.getPosition().z * 16;
+    const int localMinX = std::max(minX - baseX, 0);
+    const int localMaxX = std::min(maxX - baseX, 15);
+    const int localMinZ = std::max(minZ - baseZ, 0);
+    const int localMaxZ = std::min(maxZ - baseZ, 15);
+    if (localMinX <= localMaxX && localMinZ <= localMaxZ)
+    {
+        chunk.fill(localMinX, minY, localMinZ, localMaxX, maxY, localMaxZ, id);
+    }
+}
+
+void buildCave(World& world)
+{
+    for (int cz = 0; cz < SIDE; cz++)
+    {
+        for (int cx = 0; cx < SIDE; cx++)
+        {
+            std::unique_ptr<Chunk> chunk(new Chunk({cx, cz}));
+            chunk->fill(0, 0, 0, 15, GROUND, 15, STONE);
+            carve(*chunk, CAVE_MIN, CAVE_FLOOR, CAVE_MIN, CAVE_MAX, CAVE_ROOF, CAVE_MAX, AIR);
+            // A shaft up to the sky in one corner, and torches near the middle whose light overlaps
+            // the light of the torch placed by the benchmark
+            carve(*chunk, CAVE_MIN, CAVE_ROOF, CAVE_MIN, CAVE_MIN + 2, GROUND, CAVE_MIN + 2, AIR);
+            for (const int offset : {-7, 7})
+            {
+                carve(*chunk, MIDDLE + offset, CAVE_FLOOR, MIDDLE, MIDDLE + offset, CAVE_FLOOR, MIDDLE, TORCH);
+                carve(*chunk, MIDDLE, CAVE_FLOOR, MIDDLE + offset, MIDDLE, CAVE_FLOOR, MIDDLE + offset, TORCH);
+            }
+            // As the chunk manager does on its workers before handing chunks to the World
+            LightEngine::lightChunk(*chunk);
+            world.addChunk(std::move(chunk));
+        }
+    }
+    world.takeDirtySections();
+}
+
+} // namespace
+
+int main()
+{
+    World world;
+    buildCave(world);
+
+    const int x = MIDDLE;
+    const int z = MIDDLE;
+    const int y = CAVE_FLOOR + 1;
+    const int cycles = 100;
+
+    LightStats placed;
+    LightStats removed;
+    std::size_t placedDirty = 0;
+    std::size_t removedDirty = 0;
+    double placeMs = 0.0;
+    double removeMs = 0.0;
+    const double totalMs = bench::timeBest(5, [&]() {
+        placeMs = 0.0;
+        removeMs = 0.0;
+        for (int i = 0; i < cycles; i++)
+        {
+            placeMs += bench::timeBest(1, [&]() { world.setBlock(x, y, z, TORCH); });
+            placed = world.getLightEngine().getStats();
+            placedDirty = world.takeDirtySections().size();
+
+            removeMs += bench::timeBest(1, [&]() { world.setBlock(x, y, z, AIR); });
+            removed = world.getLightEngine().getStats();
+            removedDirty = world.takeDirtySections().size();
+        }
+    });
+    bench::keep(world.getBlock(x, y, z));
+
+    std::printf("torch in a lit cave, %d place and remove cycles, %.2f ms\n", cycles, totalMs);
+    std::printf("place   %7.1f us  %6zu lit  %6zu darkened  %3zu sections dirty\n", placeMs * 1000.0 / cycles,
+                placed.lit, placed.darkened, placedDirty);
+    std::printf("remove  %7.1f us  %6zu lit  %6zu darkened  %3zu sections dirty\n", removeMs * 1000.0 / cycles,
+                removed.lit, removed.darkened, removedDirty);
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "world/world.hpp"
+#include "world/chunkMesher.hpp"
+#include "world/terrainGenerator.hpp"
+#include <memory>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Greedy meshing against one quad per face over generated, lit terrain: the vertices,
+ * triangles and bytes of the meshes and the time taken to build them.
+ */
+
+namespace
+{
+
+// Chunks meshed along each axis, the world is one chunk wider on every side for the neighbours.
+const int MESHED = 5;
+
+struct MeshTotals
+{
+    std::size_t vertices = 0;
+    std::size_t triangles = 0;
+    std::size_t bytes = 0;
+    double ms = 0.0;
+};
+
+MeshTotals meshAll(World& world, MeshingMode mode)
+{
+    const int radius = MESHED / 2;
+    for (int x = -radius - 1; x <= radius + 1; x++)
+    {
+        for (int z = -radius - 1; z <= radius + 1; z++)
+        {
+            world.getChunk({x, z})->setMeshingMode(mode);
+        }
+    }
+
+    MeshTotals totals;
+    ChunkMesh mesh;
+    totals.ms = bench::timeBest(3, [&]() {
+        totals.vertices = totals.triangles = totals.bytes = 0;
+        for (int x = -radius; x <= radius; x++)
+        {
+            for (int z = -radius; z <= radius; z++)
+            {
+                const ChunkNeighbourhood neighbourhood = world.getNeighbourhood({x, z});
+                for (int section = 0; section < SECTION_COUNT; section++)
+                {
+                    ChunkMesher::meshSection(neighbourhood, section, mesh);
+                    totals.vertices += mesh.vertices.size();
+                    totals.triangles += mesh.getTriangleCount();
+                    totals.bytes += mesh.vertices.size() * sizeof(ChunkVertex) + mesh.indices.size() * sizeof(std::uint16_t);
+                }
+            }
+        }
+    });
+    return totals;
+}
+
+void report(const char* name, const MeshTotals& totals)
+{
+    const int sections = MESHED * MESHED * SECTION_COUNT;
+    std::printf("%-14s %9zu vertices %9zu triangles %8.1f KB  %7.2f ms  %6.1f us/section\n", name, totals.vertices,
+                totals.triangles, totals.bytes / 1024.0, totals.ms, totals.ms * 1000.0 / sections);
+}
+
+} // namespace
+
+int main()
+{
+    TerrainSettings settings;
+    settings.seed = 1;
+    TerrainGenerator generator(settings);
+
+    World world;
+    const int radius = MESHED / 2 + 1;
+    for (int x = -radius; x <= radius; x++)
+    {
+        for (int z = -radius; z <= radius; z++)
+        {
+            std::unique_ptr<Chunk> chunk(new Chunk({x, z}));
+            generator.generate(*chunk);
+            world.addChunk(std::move(chunk), false);
+        }
+    }
+
+    std::printf("meshing %dx%d generated chunks, %d sections\n", MESHED, MESHED, MESHED * MESHED * SECTION_COUNT);
+    const MeshTotals faces = meshAll(world, MeshingMode::FACE_CULLING);
+    const MeshTotals greedy = meshAll(world, MeshingMode::GREEDY);
+    report("face culling", faces);
+    report("greedy", greedy);
+    std::printf("greedy keeps %.1f%% of the vertices and takes %.2fx the time\n",
+                100.0 * greedy.vertices / faces.vertices, greedy.ms / faces.ms);
+    return 0;
+}
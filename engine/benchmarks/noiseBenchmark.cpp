@@ -0,0 +1,130 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "util/noise.hpp"
+#include <glm/gtc/noise.hpp>
+#include <vector>
+
+using namespace qore;
+using namespace qore::util;
+
+/*
+ * Noise grids filled by the SIMD kernels, against the same grid through the scalar reference
+ * path and against calling glm::perlin once per sample and octave, the way noise was sampled
+ * before the fill functions existed.
+ */
+
+namespace
+{
+
+const int REPEATS = 50;
+
+// Fractal glm::perlin over the grid one sample at a time.
+void fillGlm(const NoiseGrid& grid, const FractalSettings& settings, bool volume, float* out)
+{
+    const int height = volume ? grid.height : 1;
+    int i = 0;
+    for (int y = 0; y < height; y++)
+    {
+        for (int z = 0; z < grid.depth; z++)
+        {
+            for (int x = 0; x < grid.width; x++)
+            {
+                const glm::vec3 position(grid.x + x * grid.stepX, grid.y + y * grid.stepY, grid.z + z * grid.stepZ);
+                float frequency = 1.0f;
+                float amplitude = 1.0f;
+                float total = 0.0f;
+                for (int octave = 0; octave < settings.octaves; octave++)
+                {
+                    total += amplitude * (volume ? glm::perlin(position * frequency)
+                                                 : glm::perlin(glm::vec2(position.x, position.z) * frequency));
+                    frequency *= settings.lacunarity;
+                    amplitude *= settings.gain;
+                }
+                out[i++] = total;
+            }
+        }
+    }
+}
+
+void benchmarkGrid(const char* name, const NoiseGrid& grid, const FractalSettings& settings, bool volume)
+{
+    const Noise noise(1);
+    const int samples = grid.width * grid.depth * (volume ? grid.height : 1);
+    std::vector<float> out(samples);
+
+    const double simdMs = bench::timeBest(5, [&]() {
+        for (int r = 0; r < REPEATS; r++)
+        {
+            volume ? noise.fill3D(grid, settings, out.data()) : noise.fill2D(grid, settings, out.data());
+        }
+        bench::keep(out[samples - 1]);
+    });
+    const double referenceMs = bench::timeBest(5, [&]() {
+        for (int r = 0; r < REPEATS; r++)
+        {
+            volume ? noise.fill3D(grid, settings, out.data(), true) : noise.fill2D(grid, settings, out.data(), true);
+        }
+        bench::keep(out[samples - 1]);
+    });
+    const double glmMs = bench::timeBest(5, [&]() {
+        for (int r = 0; r < REPEATS; r++)
+        {
+            fillGlm(grid, settings, volume, out.data());
+        }
+        bench::keep(out[samples - 1]);
+    });
+
+    std::printf("%-22s %-6s %8.1f us   scalar %8.1f us   glm::perlin %8.1f us   %5.1fx over glm\n", name,
+                getNoiseBackend(), simdMs * 1000.0 / REPEATS, referenceMs * 1000.0 / REPEATS,
+                glmMs * 1000.0 / REPEATS, glmMs / simdMs);
+}
+
+} // namespace
+
+int main()
+{
+    NoiseGrid grid;
+    grid.x = 103.5f;
+    grid.y = 7.25f;
+    grid.z = -58.75f;
+    grid.stepX = grid.stepY = grid.stepZ = 1.0f / 32.0f;
+
+    FractalSettings single;
+    FractalSettings octaves;
+    octaves.octaves = 4;
+
+    benchmarkGrid("16x16 2D, 1 octave", grid, single, false);
+    benchmarkGrid("16x16 2D, 4 octaves", grid, octaves, false);
+    benchmarkGrid("16x16x16 3D, 1 octave", grid, single, true);
+    benchmarkGrid("16x16x16 3D, 4 octaves", grid, octaves, true);
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "world/regionFile.hpp"
+#include "world/chunkCodec.hpp"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Save and load throughput of RegionStorage over a few thousand chunks spread across four
+ * region files. The chunks are layered hills with scattered blocks under ground, a few hundred
+ * distinct ones saved at every position, so the records have realistic sizes.
+ *
+ * Saves include encoding the chunk and loads include decoding it, so both directions do the
+ * same work as ChunkManager. The codec is also timed on its own to show what is left for I/O.
+ */
+
+namespace
+{
+
+const char* DIRECTORY = "regionBenchmark";
+// 64x64 chunks, four region files.
+const int SIDE = 64;
+const int DISTINCT = 256;
+
+// Stone under dirt and grass, with one block in 32 under ground replaced by another type.
+void buildChunk(Chunk& chunk, std::mt19937& random)
+{
+    std::uniform_int_distribution<int> scatter(0, 31);
+    std::uniform_int_distribution<int> block(STONE, BLOCK_COUNT - 1);
+    const ChunkPos position = chunk.getPosition();
+    for (int z = 0; z < CHUNK_WIDTH; z++)
+    {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            const float wx = static_cast<float>(position.x * CHUNK_WIDTH + x);
+            const float wz = static_cast<float>(position.z * CHUNK_WIDTH + z);
+            const int height = 64 + static_cast<int>(10.0f * std::sin(wx * 0.11f) * std::cos(wz * 0.07f));
+            chunk.fill(x, 0, z, x, height - 4, z, STONE);
+            chunk.fill(x, height - 3, z, x, height - 1, z, DIRT);
+            chunk.setBlock(x, height, z, GRASS);
+            for (int y = 0; y < height - 4; y++)
+            {
+                if (scatter(random) == 0)
+                {
+                    chunk.setBlock(x, y, z, static_cast<BlockId>(block(random)));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 random(1);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::size_t encodedBytes = 0;
+    std::vector<std::uint8_t> data;
+    for (int i = 0; i < DISTINCT; i++)
+    {
+        chunks.emplace_back(new Chunk({i % 16, i / 16}));
+        buildChunk(*chunks.back(), random);
+        data.clear();
+        ChunkCodec::encode(*chunks.back(), data);
+        encodedBytes += data.size();
+    }
+
+    const int count = SIDE * SIDE;
+    std::printf("%d chunks, %.1f KB each on average\n", count, encodedBytes / 1024.0 / DISTINCT);
+    const double megabytes = count * (encodedBytes / double(DISTINCT)) / (1024.0 * 1024.0);
+
+    // The codec alone, the same number of chunks as the storage runs below.
+    std::vector<std::vector<std::uint8_t>> encoded(DISTINCT);
+    const double encodeMs = bench::timeBest(1, [&]() {
+        for (int i = 0; i < count; i++)
+        {
+            encoded[i % DISTINCT].clear();
+            ChunkCodec::encode(*chunks[i % DISTINCT], encoded[i % DISTINCT]);
+        }
+    });
+    const double decodeMs = bench::timeBest(1, [&]() {
+        Chunk chunk({0, 0});
+        for (int i = 0; i < count; i++)
+        {
+            const std::vector<std::uint8_t>& record = encoded[i % DISTINCT];
+            bench::keep(ChunkCodec::decode(record.data(), record.size(), chunk));
+        }
+    });
+
+    double firstMs = 0.0;
+    double rewriteMs = 0.0;
+    double loadMs = 0.0;
+    {
+        RegionStorage storage(DIRECTORY);
+        firstMs = bench::timeBest(1, [&]() {
+            for (int i = 0; i < count; i++)
+            {
+                data.clear();
+                ChunkCodec::encode(*chunks[i % DISTINCT], data);
+                storage.saveChunk({i % SIDE, i / SIDE}, data);
+            }
+        });
+
+        // Every chunk moves to a new record, shifted so the sizes change too.
+        rewriteMs = bench::timeBest(1, [&]() {
+            for (int i = 0; i < count; i++)
+            {
+                data.clear();
+                ChunkCodec::encode(*chunks[(i + 1) % DISTINCT], data);
+                storage.saveChunk({i % SIDE, i / SIDE}, data);
+            }
+        });
+    }
+
+    {
+        // Opened again so loading starts from freshly mapped files.
+        RegionStorage storage(DIRECTORY);
+        Chunk chunk({0, 0});
+        int loaded = 0;
+        loadMs = bench::timeBest(1, [&]() {
+            for (int i = 0; i < count; i++)
+            {
+                loaded += storage.loadChunk({i % SIDE, i / SIDE}, chunk) ? 1 : 0;
+            }
+        });
+        if (loaded != count)
+        {
+            std::printf("only %d of %d chunks loaded\n", loaded, count);
+        }
+    }
+
+    std::printf("encode      %8.0f chunks/s  %7.1f MB/s\n", count * 1000.0 / encodeMs, megabytes * 1000.0 / encodeMs);
+    std::printf("decode      %8.0f chunks/s  %7.1f MB/s\n", count * 1000.0 / decodeMs, megabytes * 1000.0 / decodeMs);
+    std::printf("first save  %8.0f chunks/s  %7.1f MB/s  (encode included)\n", count * 1000.0 / firstMs,
+                megabytes * 1000.0 / firstMs);
+    std::printf("rewrite     %8.0f chunks/s  %7.1f MB/s  (encode included)\n", count * 1000.0 / rewriteMs,
+                megabytes * 1000.0 / rewriteMs);
+    std::printf("load        %8.0f chunks/s  %7.1f MB/s  (checksum and decode included)\n", count * 1000.0 / loadMs,
+                megabytes * 1000.0 / loadMs);
+    std::printf("I/O share   save %.0f%%  load %.0f%%\n", 100.0 * (firstMs - encodeMs) / firstMs,
+                100.0 * (loadMs - decodeMs) / loadMs);
+
+    for (int x = 0; x < SIDE / REGION_SIZE; x++)
+    {
+        for (int z = 0; z < SIDE / REGION_SIZE; z++)
+        {
+            std::remove((string_t(DIRECTORY) + "/" + RegionStorage::getRegionFileName(x, z)).c_str());
+        }
+    }
+    std::remove(DIRECTORY);
+    return 0;
+}
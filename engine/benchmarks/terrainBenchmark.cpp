@@ -0,0 +1,83 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+#include "world/terrainGenerator.hpp"
+#include "util/jobPool.hpp"
+#include "util/noise.hpp"
+#include <algorithm>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Chunks generated per second on one worker and on one worker per core.
+ */
+
+namespace
+{
+
+const int SIDE = 16;
+
+double generateRegion(const TerrainGenerator& generator, unsigned int threads)
+{
+    util::JobPool pool(threads);
+    return bench::timeBest(3, [&]() {
+        for (int i = 0; i < SIDE * SIDE; i++)
+        {
+            pool.submit([&generator, i]() {
+                Chunk chunk({i % SIDE, i / SIDE});
+                generator.generate(chunk);
+                bench::keep(chunk.getBlock(0, 64, 0));
+            });
+        }
+        pool.waitIdle();
+    });
+}
+
+} // namespace
+
+int main()
+{
+    TerrainSettings settings;
+    settings.seed = 1;
+    const TerrainGenerator generator(settings);
+
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("generating %d chunks, noise backend %s\n", SIDE * SIDE, util::getNoiseBackend());
+    const double serialMs = generateRegion(generator, 1);
+    std::printf("1 worker    %7.0f chunks/s\n", SIDE * SIDE * 1000.0 / serialMs);
+    if (cores > 1)
+    {
+        const double parallelMs = generateRegion(generator, cores);
+        std::printf("%u workers  %7.0f chunks/s  %.2fx\n", cores, SIDE * SIDE * 1000.0 / parallelMs, serialMs / parallelMs);
+    }
+    return 0;
+}
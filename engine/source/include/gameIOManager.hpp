@@ -68,6 +68,11 @@ public:
     string_t getAssetsPath(AssetType type);
     string_t getConfigurationPath();
     string_t getTexturePath(TextureType type);
+    string_t getSavesPath();
+    // Folder holding everything saved for one world.
+    string_t getWorldPath(const string_t& worldName);
+    // Folder holding the region files of one world.
+    string_t getRegionPath(const string_t& worldName);
     
 private:
     // We will be using this as the game's root folder path
@@ -0,0 +1,94 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace qore
+{
+namespace util
+{
+
+/*
+ * The six planes bounding what a camera can see.
+ * Planes point inwards, a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0.
+ */
+class Frustum
+{
+public:
+    Frustum();
+    // Takes projection * view, with OpenGL's -w to w clip space depth.
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    void setMatrix(const glm::mat4& viewProjection);
+    const glm::vec4& getPlane(int index) const;
+
+    // True if the box is at least partly inside the frustum.
+    bool intersects(const glm::vec3& min, const glm::vec3& max) const;
+
+private:
+    glm::vec4 m_planes[6];
+};
+
+/*
+ * Axis aligned boxes stored as one array per coordinate, so several boxes can be
+ * loaded into a SIMD register and tested at once.
+ */
+class AabbList
+{
+public:
+    // Returns the index of the new box.
+    std::size_t add(const glm::vec3& min, const glm::vec3& max);
+    void set(std::size_t index, const glm::vec3& min, const glm::vec3& max);
+    // Moves the last box into index, so indices above it are not disturbed.
+    void removeSwap(std::size_t index);
+    void clear();
+
+    std::size_t size() const;
+
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+};
+
+/*
+ * Appends the indices of the boxes that are at least partly inside the frustum to visible
+ * and returns how many were added. Boxes are tested 8 at a time with AVX, 4 at a time with
+ * SSE or one at a time when neither is available, all three give the same result.
+ */
+std::size_t cullAabbs(const Frustum& frustum, const AabbList& boxes, std::vector<std::uint32_t>& visible);
+
+// The instruction set cullAabbs was built for, "AVX", "SSE" or "scalar".
+const char* getCullingBackend();
+
+} // namespace util
+
+} // namespace qore
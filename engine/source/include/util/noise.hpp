@@ -0,0 +1,131 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace qore
+{
+namespace util
+{
+
+/*
+ * A regular grid of sample positions. Samples are stored x first, then z, then y,
+ * the same order as ChunkSection::getIndex, so a 16x16x16 grid lines up with a section.
+ */
+struct NoiseGrid
+{
+    // Position of the first sample and the distance between neighbouring samples, in noise space.
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float stepX = 1.0f;
+    float stepY = 1.0f;
+    float stepZ = 1.0f;
+
+    // 2D grids ignore y and height.
+    int width = 16;
+    int height = 16;
+    int depth = 16;
+};
+
+enum class FractalType
+{
+    // Octaves are summed as they are, like Noise::fractal.
+    FBM,
+    // Octaves are folded into ridges, like Noise::ridged.
+    RIDGED
+};
+
+struct FractalSettings
+{
+    FractalType type = FractalType::FBM;
+    int octaves = 1;
+    float lacunarity = 2.0f;
+    float gain = 0.5f;
+    // Sample positions are first pushed around by this much single octave noise, which bends
+    // straight features into more natural shapes. 0 turns warping off.
+    float warpStrength = 0.0f;
+};
+
+/*
+ * Seeded gradient noise, Perlin's improved noise in 2D and 3D.
+ * Values are roughly within -1 to 1 and are 0 at every integer coordinate.
+ * Sampling only reads the permutation table, so one Noise can be shared between threads.
+ *
+ * The fill functions evaluate a whole grid at once, 8 samples at a time with AVX2 or
+ * 4 at a time with SSE2. Every sample goes through the same instructions whatever its
+ * place in the grid, so a point gives the same value in a 1x1 grid as in a 16x16 one.
+ */
+class Noise
+{
+public:
+    explicit Noise(std::uint64_t seed = 0);
+
+    float sample(float x, float y) const;
+    float sample(float x, float y, float z) const;
+
+    // Octaves of noise, each at lacunarity times the frequency and gain times the amplitude of
+    // the last, scaled back to roughly -1 to 1.
+    float fractal(float x, float y, int octaves, float lacunarity = 2.0f, float gain = 0.5f) const;
+    float fractal(float x, float y, float z, int octaves, float lacunarity = 2.0f, float gain = 0.5f) const;
+
+    // Like fractal but every octave is folded to 1 - |noise|, giving sharp ridges.
+    // Values are within 0 to 1, octaves are weighted by the ones before them so valleys stay smooth.
+    float ridged(float x, float y, int octaves, float lacunarity = 2.0f, float gain = 0.5f) const;
+
+    // Fills out with width * depth samples of 2D noise, taking noise x from the grid's x and noise y from its z.
+    // With reference set every sample is taken with sample() one at a time instead, which is what the
+    // SIMD kernels are checked against.
+    void fill2D(const NoiseGrid& grid, const FractalSettings& settings, float* out, bool reference = false) const;
+    // Fills out with width * height * depth samples of 3D noise.
+    void fill3D(const NoiseGrid& grid, const FractalSettings& settings, float* out, bool reference = false) const;
+
+private:
+    // Samples count points whose coordinates are given in separate arrays, padded to a multiple of 8.
+    void sampleBatch(const float* x, const float* y, int count, float* out, bool reference) const;
+    void sampleBatch(const float* x, const float* y, const float* z, int count, float* out, bool reference) const;
+
+    // The grid positions in x, y and z (nullptr for 2D) have already been filled in.
+    void fillFractal(float* x, float* y, float* z, int count, const FractalSettings& settings, float* out,
+                     bool reference) const;
+
+    // Doubled so lookups of a wrapped index plus one never need another wrap.
+    std::uint8_t m_permutation[512];
+    // The same table widened to 32 bits, so AVX2 can gather from it.
+    std::int32_t m_permutation32[512];
+};
+
+// The instruction set the fill functions were built for, "AVX2", "SSE2" or "scalar".
+const char* getNoiseBackend();
+
+} // namespace util
+
+} // namespace qore
@@ -0,0 +1,102 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace qore
+{
+namespace util
+{
+
+// Mixes a 64 bit value so every input bit affects every output bit, the SplitMix64 finaliser.
+inline std::uint64_t mix64(std::uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/*
+ * A counter based random number generator, the n-th number it gives only depends on its key and n.
+ * Keying it with the world seed and a chunk position gives every chunk its own stream of numbers,
+ * no matter in which order or on which thread the chunks are generated.
+ */
+class CounterRandom
+{
+public:
+    explicit CounterRandom(std::uint64_t key) : m_key(mix64(key)), m_counter(0)
+    {
+    }
+
+    // Different streams of the same chunk are independent, so one stage can draw more numbers
+    // without changing what the next stage gets.
+    CounterRandom(std::uint64_t seed, std::int32_t x, std::int32_t z, std::uint32_t stream = 0)
+        : m_key(mix64(mix64(seed) ^ mix64((std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(z)) ^ mix64(stream + 1))),
+          m_counter(0)
+    {
+    }
+
+    // The number drawn at any position of the stream, does not move the counter.
+    std::uint64_t at(std::uint64_t counter) const
+    {
+        return mix64(m_key + counter * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::uint32_t next()
+    {
+        return static_cast<std::uint32_t>(at(m_counter++) >> 32);
+    }
+
+    // Uniform in [0, 1).
+    float nextFloat()
+    {
+        return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Uniform in [0, bound), bound must be greater than 0.
+    int nextInt(int bound)
+    {
+        return static_cast<int>((std::uint64_t(next()) * std::uint32_t(bound)) >> 32);
+    }
+
+    std::uint64_t getCounter() const
+    {
+        return m_counter;
+    }
+
+private:
+    std::uint64_t m_key;
+    std::uint64_t m_counter;
+};
+
+} // namespace util
+
+} // namespace qore
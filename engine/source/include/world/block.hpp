@@ -0,0 +1,86 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace qore
+{
+namespace world
+{
+
+// Every block type in the world is referred to by a 16 bit ID.
+typedef std::uint16_t BlockId;
+
+// The built in block types, AIR must always be 0 so freshly created sections are empty.
+enum Blocks : BlockId
+{
+    AIR = 0,
+    STONE,
+    DIRT,
+    GRASS,
+    COBBLESTONE,
+    SAND,
+    SNOW,
+    LOG,
+    LEAVES,
+    BEDROCK,
+    TORCH,
+
+    BLOCK_COUNT
+};
+
+// Dimensions of the world storage units.
+const int SECTION_SIZE   = 16;
+const int SECTION_AREA   = SECTION_SIZE * SECTION_SIZE;
+const int SECTION_VOLUME = SECTION_SIZE * SECTION_SIZE * SECTION_SIZE;
+
+const int CHUNK_WIDTH    = 16;
+const int CHUNK_HEIGHT   = 256;
+const int SECTION_COUNT  = CHUNK_HEIGHT / SECTION_SIZE;
+
+// Light levels run from 0 for darkness to 15 for direct sunlight.
+const int MAX_LIGHT = 15;
+
+// Opaque blocks hide the faces of the blocks next to them and stop light.
+inline bool isOpaque(BlockId id)
+{
+    return id != AIR;
+}
+
+// Block light given off by a block, light sources light themselves even though they are opaque.
+inline int getLightEmission(BlockId id)
+{
+    return id == TORCH ? 14 : 0;
+}
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,185 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/block.hpp"
+#include "world/chunkSection.hpp"
+#include "world/nibbleArray.hpp"
+#include <array>
+#include <functional>
+
+namespace qore
+{
+namespace world
+{
+
+// Position of a chunk in chunk coordinates, block coordinates are 16 times larger.
+struct ChunkPos
+{
+    int x;
+    int z;
+
+    bool operator==(const ChunkPos& other) const
+    {
+        return x == other.x && z == other.z;
+    }
+    bool operator!=(const ChunkPos& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Position of a chunk section, y is the index of the section within its chunk.
+struct SectionPos
+{
+    int x;
+    int y;
+    int z;
+
+    bool operator==(const SectionPos& other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+    bool operator!=(const SectionPos& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Hash functors so positions can be used as unordered_map keys.
+struct ChunkPosHash
+{
+    std::size_t operator()(const ChunkPos& pos) const
+    {
+        return std::hash<std::uint64_t>()((std::uint64_t(std::uint32_t(pos.x)) << 32) | std::uint32_t(pos.z));
+    }
+};
+
+struct SectionPosHash
+{
+    std::size_t operator()(const SectionPos& pos) const
+    {
+        return ChunkPosHash()({pos.x, pos.z}) * 31 + static_cast<std::size_t>(pos.y);
+    }
+};
+
+// How the sections of a chunk are turned into meshes.
+enum class MeshingMode
+{
+    // One quad per visible block face.
+    FACE_CULLING,
+    // Coplanar faces of the same block type are merged into larger quads.
+    GREEDY
+};
+
+/*
+ * A 16x256x16 column of blocks, made of 16 stacked ChunkSections.
+ */
+class Chunk
+{
+public:
+    explicit Chunk(ChunkPos position);
+
+    ChunkPos getPosition() const;
+
+    // Coordinates are local to the chunk, x/z from 0 to 15 and y from 0 to 255.
+    BlockId getBlock(int x, int y, int z) const;
+    void setBlock(int x, int y, int z, BlockId id);
+
+    // Fill an inclusive box of blocks, whole sections covered by the box skip the per block path.
+    void fill(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockId id);
+
+    ChunkSection& getSection(int index);
+    const ChunkSection& getSection(int index) const;
+
+    // Light levels, coordinates as for getBlock. Kept up to date by the LightEngine.
+    int getSkyLight(int x, int y, int z) const;
+    void setSkyLight(int x, int y, int z, int level);
+    int getBlockLight(int x, int y, int z) const;
+    void setBlockLight(int x, int y, int z, int level);
+
+    NibbleArray& getSkyLightSection(int index);
+    const NibbleArray& getSkyLightSection(int index) const;
+    NibbleArray& getBlockLightSection(int index);
+    const NibbleArray& getBlockLightSection(int index) const;
+
+    // Bytes of memory used to store the blocks and light of this chunk.
+    std::size_t getMemoryUsage() const;
+
+    MeshingMode getMeshingMode() const;
+    void setMeshingMode(MeshingMode mode);
+
+    // Set by World::setBlock, so only chunks that differ from what was generated or last
+    // saved are written back. Cleared when the chunk is saved.
+    bool isModified() const;
+    void setModified(bool modified);
+
+private:
+    ChunkPos m_position;
+    MeshingMode m_meshingMode;
+    bool m_modified;
+    std::array<ChunkSection, SECTION_COUNT> m_sections;
+    std::array<NibbleArray, SECTION_COUNT> m_skyLight;
+    std::array<NibbleArray, SECTION_COUNT> m_blockLight;
+};
+
+inline BlockId Chunk::getBlock(int x, int y, int z) const
+{
+    return m_sections[y >> 4].getBlock(x, y & 15, z);
+}
+
+inline void Chunk::setBlock(int x, int y, int z, BlockId id)
+{
+    m_sections[y >> 4].setBlock(x, y & 15, z, id);
+}
+
+inline int Chunk::getSkyLight(int x, int y, int z) const
+{
+    return m_skyLight[y >> 4].get(ChunkSection::getIndex(x, y & 15, z));
+}
+
+inline void Chunk::setSkyLight(int x, int y, int z, int level)
+{
+    m_skyLight[y >> 4].set(ChunkSection::getIndex(x, y & 15, z), static_cast<std::uint8_t>(level));
+}
+
+inline int Chunk::getBlockLight(int x, int y, int z) const
+{
+    return m_blockLight[y >> 4].get(ChunkSection::getIndex(x, y & 15, z));
+}
+
+inline void Chunk::setBlockLight(int x, int y, int z, int level)
+{
+    m_blockLight[y >> 4].set(ChunkSection::getIndex(x, y & 15, z), static_cast<std::uint8_t>(level));
+}
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,161 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunk.hpp"
+#include "world/chunkMesh.hpp"
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace qore
+{
+namespace world
+{
+
+// A chunk handed back by ChunkCache::take.
+struct CachedChunk
+{
+    // Set when the chunk came from the hot tier, or from the cold tier before it was compressed.
+    std::unique_ptr<Chunk> chunk;
+    // Section meshes from when the chunk was unloaded, only valid if hasMeshes is set.
+    std::array<ChunkMesh, SECTION_COUNT> meshes;
+    bool hasMeshes;
+    // Set instead of chunk when the chunk came from the cold tier, decode it with ChunkCodec.
+    std::vector<std::uint8_t> compressed;
+};
+
+struct ChunkCacheStats
+{
+    std::uint64_t hotHits;
+    std::uint64_t coldHits;
+    std::uint64_t misses;
+    // Hot chunks compressed to make room.
+    std::uint64_t demotions;
+    // Cold chunks dropped from the cache altogether.
+    std::uint64_t evictions;
+
+    std::size_t hotCount;
+    std::size_t coldCount;
+    std::size_t hotBytes;
+    std::size_t coldBytes;
+    // Cold chunks still waiting to be compressed, not counted in coldCount and coldBytes.
+    std::size_t pendingCount;
+    std::size_t pendingBytes;
+};
+
+/*
+ * Keeps unloaded chunks in memory so coming back to them is cheap.
+ *
+ * Recently unloaded chunks are kept as they are, together with their meshes (the hot tier).
+ * When the hot tier outgrows its share of the budget the least recently used chunk is
+ * compressed and moved to the cold tier, and when the whole cache is over budget the least
+ * recently used cold chunk is dropped. The cache never holds more than its byte budget
+ * once an insert has returned.
+ *
+ * With deferred compression the cache leaves compressing demoted chunks to the caller, who
+ * takes them with takePendingCompression() and hands the compressed blocks back to
+ * finishCompression() from the thread using the cache. Until then they stay in the cold tier
+ * as they are and do not count against the budget, so the cache can briefly hold more.
+ */
+class ChunkCache
+{
+public:
+    // hotFraction is the part of the budget the hot tier may use.
+    explicit ChunkCache(std::size_t byteBudget, float hotFraction = 0.5f);
+
+    ChunkCache(const ChunkCache&) = delete;
+    ChunkCache& operator=(const ChunkCache&) = delete;
+
+    // Takes ownership of an unloaded chunk, replacing any copy already in the cache.
+    void insert(std::unique_ptr<Chunk> chunk);
+    // Keeps the meshes of a chunk that is still in the hot tier, ignored otherwise.
+    void insertMeshes(ChunkPos position, std::array<ChunkMesh, SECTION_COUNT>&& meshes);
+
+    // Removes the chunk from the cache and hands it back, returns false on a miss.
+    bool take(ChunkPos position, CachedChunk& cached);
+    bool contains(ChunkPos position) const;
+
+    void setDeferredCompression(bool deferred);
+    // Chunks demoted since the last call, to be compressed with ChunkCodec on any thread.
+    std::vector<std::shared_ptr<const Chunk>> takePendingCompression();
+    // Ignored when the chunk has left the cache or been replaced in the meantime.
+    void finishCompression(const std::shared_ptr<const Chunk>& chunk, std::vector<std::uint8_t>&& compressed);
+
+    void clear();
+
+    std::size_t getBudget() const;
+    void setBudget(std::size_t byteBudget, float hotFraction = 0.5f);
+
+    const ChunkCacheStats& getStats() const;
+
+private:
+    struct Entry
+    {
+        ChunkPos position;
+        bool hot;
+        // Hot entries own the chunk, cold entries only the compressed blocks.
+        std::unique_ptr<Chunk> chunk;
+        // One mesh per section, or empty if the meshes were not kept.
+        std::vector<ChunkMesh> meshes;
+        std::vector<std::uint8_t> compressed;
+        // Cold entries waiting for their compressed blocks keep the chunk here instead.
+        std::shared_ptr<const Chunk> pending;
+        std::size_t bytes;
+    };
+    typedef std::list<Entry> EntryList;
+
+    static std::size_t getHotSize(const Entry& entry);
+
+    void erase(EntryList::iterator entry);
+    void demote(EntryList::iterator entry);
+    void setCompressed(Entry& entry, std::vector<std::uint8_t>&& compressed);
+    void enforceBudget();
+
+    std::size_t m_budget;
+    std::size_t m_hotBudget;
+
+    // Most recently used first.
+    EntryList m_hot;
+    EntryList m_cold;
+    std::unordered_map<ChunkPos, EntryList::iterator, ChunkPosHash> m_entries;
+
+    bool m_deferred;
+    std::vector<std::shared_ptr<const Chunk>> m_pending;
+
+    ChunkCacheStats m_stats;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,62 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunk.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace qore
+{
+namespace world
+{
+
+/*
+ * Compact binary form of a chunk's blocks.
+ *
+ * The chunk is stored as runs of identical blocks in section, y, z, x order, each run
+ * being a block ID and a length written as variable length integers. Terrain is mostly
+ * long runs of air and stone, so a typical chunk shrinks to a few hundred bytes and a
+ * section of a single block type costs a couple of bytes.
+ */
+class ChunkCodec
+{
+public:
+    // Appends the encoded blocks of the chunk to out.
+    static void encode(const Chunk& chunk, std::vector<std::uint8_t>& out);
+
+    // Overwrites every block of the chunk. Returns false if the data is malformed,
+    // in which case the chunk is left partially filled.
+    static bool decode(const std::uint8_t* data, std::size_t size, Chunk& chunk);
+};
+
+} // namespace world
+
+} // namespace qore
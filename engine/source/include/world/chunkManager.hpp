@@ -0,0 +1,178 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/world.hpp"
+#include "world/chunkCache.hpp"
+#include "world/regionFile.hpp"
+#include "util/jobPool.hpp"
+#include "util/mpscQueue.hpp"
+#include <glm/glm.hpp>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace qore
+{
+namespace world
+{
+
+// Fills in the blocks of a newly created chunk.
+// Called on worker threads, possibly several at once for different chunks.
+typedef std::function<void(Chunk&)> ChunkGenerator;
+
+struct StreamingSettings
+{
+    // Radius in chunks of the circle kept loaded around the viewer.
+    int renderDistance = 8;
+    // Chunks are only unloaded once they are this many chunks outside of the render distance,
+    // so walking back and forth over a chunk border does not load and unload the same chunks.
+    int unloadMargin = 2;
+    // Chunks being generated at once, more chunks are not started until some have finished.
+    unsigned int maxGenerating = 16;
+    // Finished chunks added to the world per update, each one queues its sections for meshing.
+    unsigned int maxLoadsPerUpdate = 4;
+};
+
+// Meshes of a chunk that came back from the hot tier of a ChunkCache.
+struct RestoredMeshes
+{
+    ChunkPos position;
+    std::array<ChunkMesh, SECTION_COUNT> meshes;
+};
+
+/*
+ * Keeps the chunks around a moving viewer loaded.
+ *
+ * Missing chunks inside the render distance are generated and lit on worker threads, nearest
+ * first and with chunks in front of the viewer before those behind it. Finished chunks
+ * are added to the World on the thread calling update(), a few per call, and chunks
+ * that fall outside the render distance plus the unload margin are removed again.
+ *
+ * update() never waits for a chunk to be generated, so it is cheap enough to call every frame.
+ *
+ * With a ChunkCache set, unloaded chunks are handed to the cache and chunks found in it are
+ * restored instead of being generated again. Chunks restored with their meshes are added
+ * without being remeshed, their meshes are handed out through takeRestoredMeshes(). The cache
+ * is switched to deferred compression and the chunks it demotes are compressed on the workers.
+ *
+ * With a RegionStorage set, unloaded chunks that were modified are saved on the worker threads
+ * and chunks are loaded from disk before falling back to the generator. Chunks that were never
+ * edited are generated again from the seed instead of being stored.
+ */
+class ChunkManager
+{
+public:
+    ChunkManager(World& world, ChunkGenerator generator, const StreamingSettings& settings, unsigned int threadCount = 0);
+
+    ChunkManager(const ChunkManager&) = delete;
+    ChunkManager& operator=(const ChunkManager&) = delete;
+
+    // position and forward are in world block coordinates, only their x and z matter.
+    void update(const glm::vec3& position, const glm::vec3& forward);
+
+    // Chunks removed from the world since the last call, so their meshes can be thrown away too.
+    std::vector<ChunkPos> takeUnloaded();
+    std::vector<RestoredMeshes> takeRestoredMeshes();
+
+    // The cache is not owned and may be nullptr, in which case unloaded chunks are destroyed.
+    void setCache(ChunkCache* cache);
+    // The storage is not owned and may be nullptr, in which case nothing is saved.
+    void setStorage(RegionStorage* storage);
+
+    // Saves every modified loaded chunk and waits until everything queued for saving has been written.
+    void saveAll();
+
+    const StreamingSettings& getSettings() const;
+    void setSettings(const StreamingSettings& settings);
+
+    std::size_t getLoadedCount() const;
+    std::size_t getGeneratingCount() const;
+
+private:
+    void addGenerated();
+    void unloadDistant();
+    void startGeneration(const glm::vec3& position, const glm::vec3& forward);
+    void load(ChunkPos position);
+    // Queues a modified chunk for saving and clears its flag, nothing is saved for unmodified chunks.
+    void save(Chunk& chunk);
+    // Encodes and writes the chunk on a worker, the chunk must not be changed any more.
+    // Saves of the same chunk are written one at a time, in the order they were queued.
+    void write(std::shared_ptr<const Chunk> chunk);
+    void startWrite(ChunkPos position, std::shared_ptr<const Chunk> chunk);
+    // Forgets finished saves and starts the saves queued behind them.
+    void finishSaves();
+    // Hands compressed chunks back to the cache and compresses the ones it demoted since.
+    void compressCached();
+
+    bool isInside(ChunkPos position, int radius) const;
+
+    World& m_world;
+    ChunkGenerator m_generator;
+    StreamingSettings m_settings;
+    ChunkCache* m_cache;
+    RegionStorage* m_storage;
+
+    // The chunk the viewer was in during the last update.
+    ChunkPos m_centre;
+    bool m_hasCentre;
+    // Cleared whenever the set of chunks that should be loaded may have grown.
+    bool m_allLoaded;
+
+    std::unordered_set<ChunkPos, ChunkPosHash> m_loaded;
+    std::unordered_set<ChunkPos, ChunkPosHash> m_generating;
+    std::vector<ChunkPos> m_unloaded;
+    std::vector<RestoredMeshes> m_restored;
+
+    util::MpscQueue<std::unique_ptr<Chunk>> m_generated;
+
+    // The copy of a chunk being written and the newer copy waiting for it to finish, if any.
+    struct PendingSave
+    {
+        std::shared_ptr<const Chunk> writing;
+        std::shared_ptr<const Chunk> next;
+    };
+
+    // Chunks queued for saving, a chunk loaded again before its save has finished is copied
+    // from here rather than read back from a file that may not have it yet.
+    std::unordered_map<ChunkPos, PendingSave, ChunkPosHash> m_saving;
+    // Chunks whose save has finished.
+    util::MpscQueue<ChunkPos> m_saved;
+    // Chunks demoted by the cache along with their compressed blocks.
+    util::MpscQueue<std::pair<std::shared_ptr<const Chunk>, std::vector<std::uint8_t>>> m_compressed;
+    // Declared last so the workers are joined before the queue they push to is destroyed
+    util::JobPool m_jobs;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,97 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/sectionVisibility.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace qore
+{
+namespace world
+{
+
+/*
+ * Vertex layout produced by the chunk mesher, 8 bytes packed into unsigned bytes.
+ * Quad corners always land on whole block positions from 0 to 16 so the position fits a byte,
+ * texture coordinates are not stored as the shader rebuilds them from the position and face.
+ */
+struct ChunkVertex
+{
+    // Position local to the section.
+    std::uint8_t x;
+    std::uint8_t y;
+    std::uint8_t z;
+    // axis * 2 + 1 for faces looking along +axis, 0 for -axis.
+    std::uint8_t face;
+    // Sky and block light at the vertex, 0 for dark to 255 for full light.
+    std::uint8_t skyLight;
+    std::uint8_t blockLight;
+    // Ambient occlusion baked in from the blocks around the corner, 0 when fully hidden to 255 when open.
+    std::uint8_t occlusion;
+    // Block the face belongs to, not read by the shaders yet but ready for per block textures.
+    std::uint8_t block;
+
+    glm::vec3 getPosition() const
+    {
+        return glm::vec3(x, y, z);
+    }
+};
+
+// CPU side geometry for one 16x16x16 chunk section, ready to be uploaded to the renderer.
+struct ChunkMesh
+{
+    std::vector<ChunkVertex> vertices;
+    std::vector<std::uint16_t> indices;
+    // Worked out alongside the geometry, used to skip sections hidden behind solid ground.
+    SectionVisibility visibility;
+
+    void clear()
+    {
+        vertices.clear();
+        indices.clear();
+        visibility = SectionVisibility::all();
+    }
+
+    bool isEmpty() const
+    {
+        return indices.empty();
+    }
+
+    unsigned int getTriangleCount() const
+    {
+        return static_cast<unsigned int>(indices.size() / 3);
+    }
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,117 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunk.hpp"
+#include "world/chunkMesh.hpp"
+
+namespace qore
+{
+namespace world
+{
+
+/*
+ * A chunk and the eight chunks around it.
+ * The mesher needs the neighbours to know whether faces on the chunk border are hidden and
+ * how bright their corners are, neighbours that are not loaded are nullptr and treated as
+ * air open to the sky.
+ */
+struct ChunkNeighbourhood
+{
+    const Chunk* centre;
+    const Chunk* negX;
+    const Chunk* posX;
+    const Chunk* negZ;
+    const Chunk* posZ;
+    const Chunk* negXNegZ;
+    const Chunk* posXNegZ;
+    const Chunk* negXPosZ;
+    const Chunk* posXPosZ;
+
+    // Coordinates are local to the centre chunk, x and z may be one block outside of it.
+    BlockId getBlock(int x, int y, int z) const;
+    // Sky light in the high 4 bits and block light in the low 4.
+    std::uint8_t getLight(int x, int y, int z) const;
+
+    // The chunk holding a block, x and z are moved into its local coordinates.
+    const Chunk* getChunk(int& x, int& z) const;
+};
+
+// The section plus a one block border on every side.
+const int PADDED_SIZE = SECTION_SIZE + 2;
+const int PADDED_VOLUME = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+
+/*
+ * A copy of everything the mesher reads for one section.
+ * Meshing from a copy lets the chunk keep changing while the mesh is built on another thread.
+ */
+struct PaddedSection
+{
+    ChunkPos chunk;
+    int section;
+    MeshingMode mode;
+    BlockId blocks[PADDED_VOLUME];
+    // Sky light in the high 4 bits and block light in the low 4, as ChunkNeighbourhood::getLight.
+    std::uint8_t light[PADDED_VOLUME];
+
+    // Coordinates are local to the section, from -1 to 16 on each axis.
+    static int getIndex(int x, int y, int z)
+    {
+        return ((y + 1) * PADDED_SIZE + (z + 1)) * PADDED_SIZE + (x + 1);
+    }
+};
+
+/*
+ * Turns the blocks of a chunk section into a mesh.
+ * Only faces between a block and a non opaque neighbour are emitted,
+ * faces between two opaque blocks can never be seen.
+ * The chunk's MeshingMode decides whether those faces are merged into larger quads.
+ * Every vertex carries the light at its corner, the average of the open blocks in front of
+ * the face that touch the corner, along with ambient occlusion from the three blocks around
+ * the corner. Faces are only merged when their corners match.
+ * The mesh also records the section's SectionVisibility.
+ */
+class ChunkMesher
+{
+public:
+    static void meshSection(const ChunkNeighbourhood& neighbourhood, int section, ChunkMesh& mesh);
+
+    // The two halves of meshSection, copySection must not run while the chunks are being changed
+    // but meshPadded only touches its arguments and is safe to call from any thread.
+    static void copySection(const ChunkNeighbourhood& neighbourhood, int section, PaddedSection& padded);
+    static void meshPadded(const PaddedSection& padded, ChunkMesh& mesh);
+
+    // Flood fills the non opaque blocks of the section to find which faces can see each other.
+    static SectionVisibility computeVisibility(const PaddedSection& padded);
+};
+
+} // namespace world
+
+} // namespace qore
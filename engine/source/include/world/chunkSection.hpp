@@ -0,0 +1,139 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/block.hpp"
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+namespace qore
+{
+namespace world
+{
+
+/*
+ * A 16x16x16 cube of blocks.
+ *
+ * Blocks are not stored directly, instead each section keeps a palette of the
+ * block IDs it contains and every block stores an index into that palette packed
+ * into as few bits as the palette size allows (1 to 16 bits per block).
+ * A section made of a single block type (usually all air) stores no block data at all.
+ */
+class ChunkSection
+{
+public:
+    ChunkSection();
+
+    // Coordinates are local to the section, 0 to 15 on each axis.
+    BlockId getBlock(int x, int y, int z) const;
+    void setBlock(int x, int y, int z, BlockId id);
+
+    // Replace every block in the section with a single block type.
+    void fill(BlockId id);
+    // Replace every block in the section from SECTION_VOLUME IDs in getIndex order.
+    // Builds the palette in one pass, much faster than setting the blocks one by one.
+    void setBlocks(const BlockId* blocks);
+
+    // True if the section contains nothing but air.
+    bool isEmpty() const;
+    // True if every block in the section is the same type.
+    bool isUniform() const;
+
+    unsigned int getBitsPerBlock() const;
+    std::size_t getPaletteSize() const;
+    // Number of non air blocks in the section.
+    unsigned int getBlockCount() const;
+
+    // Bytes of memory owned by this section, including the object itself.
+    std::size_t getMemoryUsage() const;
+
+    static int getIndex(int x, int y, int z)
+    {
+        return (y * SECTION_SIZE + z) * SECTION_SIZE + x;
+    }
+
+private:
+    unsigned int readIndex(int index) const;
+    void writeIndex(int index, unsigned int value);
+
+    static unsigned int readPacked(const std::vector<std::uint64_t>& data, unsigned int bits, int index);
+    static void writePacked(std::vector<std::uint64_t>& data, unsigned int bits, int index, unsigned int value);
+
+    // Returns the palette slot for a block, adding it (and growing the data) if needed.
+    unsigned int getPaletteSlot(BlockId id);
+    void resize(unsigned int bitsPerBlock);
+
+    // Bits per block, 0 when the section is a single block type.
+    unsigned int m_bits;
+    unsigned int m_nonAirCount;
+
+    std::vector<BlockId> m_palette;
+    // How many blocks reference each palette slot, free slots have a count of 0.
+    std::vector<std::uint16_t> m_paletteCounts;
+    // Reverse lookup, only used once the palette grows too large to search.
+    std::unordered_map<BlockId, std::uint16_t> m_paletteLookup;
+
+    std::vector<std::uint64_t> m_data;
+};
+
+inline BlockId ChunkSection::getBlock(int x, int y, int z) const
+{
+    if (m_bits == 0)
+    {
+        return m_palette[0];
+    }
+    return m_palette[readIndex(getIndex(x, y, z))];
+}
+
+inline unsigned int ChunkSection::readIndex(int index) const
+{
+    return readPacked(m_data, m_bits, index);
+}
+
+inline unsigned int ChunkSection::readPacked(const std::vector<std::uint64_t>& data, unsigned int bits, int index)
+{
+    // Values are tightly packed and may straddle two words
+    const std::size_t bit = static_cast<std::size_t>(index) * bits;
+    const std::size_t word = bit >> 6;
+    const unsigned int offset = bit & 63;
+    const std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+
+    std::uint64_t value = data[word] >> offset;
+    if (offset + bits > 64)
+    {
+        value |= data[word + 1] << (64 - offset);
+    }
+    return static_cast<unsigned int>(value & mask);
+}
+
+} // namespace world
+
+} // namespace qore
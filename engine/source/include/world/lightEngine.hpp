@@ -0,0 +1,122 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunk.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace qore
+{
+namespace world
+{
+
+class World;
+
+// What the last change to the light of the world touched.
+struct LightStats
+{
+    // Blocks whose light went up.
+    std::size_t lit = 0;
+    // Blocks whose light was cleared by a removal search.
+    std::size_t darkened = 0;
+};
+
+/*
+ * Spreads sky light and block light through the world with breadth first searches.
+ *
+ * Light loses one level per block as it spreads through non opaque blocks, except that sky
+ * light at full strength falls straight down without losing any. lightChunk() works out the
+ * light inside a chunk on its own and is safe to run on a worker thread, addChunk() then lets
+ * light flow over the borders once the chunk is part of the World.
+ *
+ * When a block changes only the light around it is redone. Light that came from or through
+ * the old block is cleared by a removal search, which hands the blocks at the edge of the
+ * cleared area, still lit from elsewhere, back to the normal search to fill the gap in again.
+ * Sections whose light changed are marked dirty in the World so they get remeshed.
+ */
+class LightEngine
+{
+public:
+    explicit LightEngine(World& world);
+
+    // Lights a chunk as if it had no neighbours, replacing any light it had.
+    static void lightChunk(Chunk& chunk);
+
+    // Spreads light between a chunk that has just been added to the World and its neighbours.
+    void addChunk(ChunkPos position);
+    // Call after the block at x, y, z, in world block coordinates, has changed from previous.
+    void updateBlock(int x, int y, int z, BlockId previous);
+
+    // Stats of the last addChunk or updateBlock call.
+    const LightStats& getStats() const;
+
+private:
+    enum Channel
+    {
+        SKY,
+        BLOCK
+    };
+
+    struct Node
+    {
+        int x;
+        int y;
+        int z;
+        int level;
+    };
+
+    // Both return nullptr and 0 for blocks outside of the loaded chunks.
+    Chunk* findChunk(int x, int z);
+    int getLight(Channel channel, int x, int y, int z);
+    void setLight(Channel channel, int x, int y, int z, int level);
+
+    // Adds the neighbours of x, y, z that have any light to the add queue.
+    void queueNeighbours(Channel channel, int x, int y, int z);
+
+    // Runs the removal queue and then the add queue.
+    void unpropagate(Channel channel);
+    void propagate(Channel channel);
+
+    World& m_world;
+
+    std::vector<Node> m_addQueue;
+    std::vector<Node> m_removeQueue;
+
+    // Light updates read long runs of blocks from the same chunk
+    Chunk* m_lastChunk;
+    ChunkPos m_lastPosition;
+
+    LightStats m_stats;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,84 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunkMesher.hpp"
+#include "util/jobPool.hpp"
+#include "util/mpscQueue.hpp"
+#include <atomic>
+
+namespace qore
+{
+namespace world
+{
+
+// A finished section mesh, handed back to the thread that owns the renderer.
+struct MeshResult
+{
+    ChunkPos chunk;
+    int section;
+    // Matches the value returned by MeshingPool::submit.
+    std::uint64_t ticket;
+    ChunkMesh mesh;
+};
+
+/*
+ * Builds chunk section meshes on worker threads.
+ *
+ * submit() copies the section on the calling thread, so chunks may be edited as soon as it
+ * returns. Finished meshes are collected through a lock free queue by calling popCompleted(),
+ * which must only ever be called from one thread.
+ *
+ * Meshes can finish out of order, every submit returns a new ticket so callers can tell
+ * whether a result is older than the last mesh they asked for.
+ */
+class MeshingPool
+{
+public:
+    explicit MeshingPool(unsigned int threadCount = 0);
+
+    std::uint64_t submit(const ChunkNeighbourhood& neighbourhood, int section);
+
+    bool popCompleted(MeshResult& result);
+
+    // Meshes that have been submitted but not collected yet.
+    unsigned int getInFlightCount() const;
+
+private:
+    util::MpscQueue<MeshResult> m_completed;
+    std::atomic<unsigned int> m_inFlight;
+    std::uint64_t m_nextTicket;
+    // Declared last so the workers are joined before the queue they push to is destroyed
+    util::JobPool m_jobs;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,124 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/block.hpp"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace qore
+{
+namespace world
+{
+
+/*
+ * One 4 bit value per block of a section, two blocks to a byte.
+ * Like a section of a single block type, an array where every value is the same
+ * stores no data at all until a different value is written.
+ */
+class NibbleArray
+{
+public:
+    explicit NibbleArray(std::uint8_t value = 0) : m_uniform(value)
+    {
+    }
+
+    // Index as given by ChunkSection::getIndex.
+    std::uint8_t get(int index) const
+    {
+        if (m_data.empty())
+        {
+            return m_uniform;
+        }
+        return (m_data[index >> 1] >> ((index & 1) << 2)) & 15;
+    }
+
+    void set(int index, std::uint8_t value)
+    {
+        if (m_data.empty())
+        {
+            if (value == m_uniform)
+            {
+                return;
+            }
+            m_data.assign(SECTION_VOLUME / 2, static_cast<std::uint8_t>(m_uniform | (m_uniform << 4)));
+        }
+
+        const int shift = (index & 1) << 2;
+        std::uint8_t& byte = m_data[index >> 1];
+        byte = static_cast<std::uint8_t>((byte & ~(15 << shift)) | (value << shift));
+    }
+
+    void fill(std::uint8_t value)
+    {
+        m_uniform = value;
+        std::vector<std::uint8_t>().swap(m_data);
+    }
+
+    // Replaces every value from SECTION_VOLUME bytes, going back to no data when they are all the same.
+    void setAll(const std::uint8_t* values)
+    {
+        bool uniform = true;
+        for (int i = 1; i < SECTION_VOLUME && uniform; i++)
+        {
+            uniform = values[i] == values[0];
+        }
+        if (uniform)
+        {
+            fill(values[0]);
+            return;
+        }
+
+        m_data.resize(SECTION_VOLUME / 2);
+        for (int i = 0; i < SECTION_VOLUME / 2; i++)
+        {
+            m_data[i] = static_cast<std::uint8_t>(values[2 * i] | (values[2 * i + 1] << 4));
+        }
+    }
+
+    bool isUniform() const
+    {
+        return m_data.empty();
+    }
+
+    std::size_t getMemoryUsage() const
+    {
+        return sizeof(NibbleArray) + m_data.capacity();
+    }
+
+private:
+    std::uint8_t m_uniform;
+    std::vector<std::uint8_t> m_data;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,157 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "types.hpp"
+#include "world/chunk.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace qore
+{
+namespace world
+{
+
+// Chunks along each side of a region, a region file holds REGION_SIZE x REGION_SIZE chunks.
+const int REGION_SIZE = 32;
+const int REGION_CHUNKS = REGION_SIZE * REGION_SIZE;
+
+/*
+ * One file holding a 32x32 area of chunks.
+ *
+ * The file is split into 4 KB sectors. The first two hold a table with the first sector and
+ * sector count of every chunk, each chunk is stored in a run of whole sectors after that:
+ *
+ *     length (4 bytes), CRC-32 of the data (4), compression (1), padding (3), data
+ *
+ * Chunks are compressed with ChunkCodec. A chunk is never rewritten in place, every write goes
+ * to sectors that are free before it starts and the table entry is only changed once the record
+ * is written, so if the game stops part way through the table still points at the old record.
+ * The old sectors are freed after that and reused before the file is made any longer.
+ * Nothing is flushed to disk, so this does not hold if the whole system goes down.
+ *
+ * Reading maps the file into memory, so readChunk decodes straight out of the page cache
+ * without copying it into a buffer first. Numbers are stored little endian.
+ */
+class RegionFile
+{
+public:
+    RegionFile();
+    ~RegionFile();
+
+    RegionFile(const RegionFile&) = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+
+    // Returns false if the file can not be opened or is not a region file.
+    // A missing file is only created when create is true.
+    bool open(const string_t& path, bool create);
+    void close();
+    bool isOpen() const;
+
+    // Coordinates are local to the region, 0 to 31.
+    bool hasChunk(int x, int z) const;
+    // Returns false if the chunk was never saved, or if its data fails the checksum or does not decode.
+    bool readChunk(int x, int z, Chunk& chunk);
+    // Copies the checked data of the chunk's record, to be decoded with ChunkCodec later on.
+    // Returns false if the chunk was never saved or its data fails the checksum.
+    bool readRecord(int x, int z, std::vector<std::uint8_t>& data);
+    // data is the output of ChunkCodec::encode.
+    bool writeChunk(int x, int z, const std::uint8_t* data, std::size_t size);
+
+private:
+    // The data of the chunk's record in the mapped file, nullptr if it is missing or damaged.
+    const std::uint8_t* findRecord(int x, int z, std::uint32_t& length);
+
+    bool mapFile();
+    void unmapFile();
+    bool writeAt(std::uint64_t offset, const void* data, std::size_t size);
+
+    // Finds count free sectors in a row, growing the file if there are none.
+    std::uint32_t allocateSectors(std::uint32_t count);
+    void setSectorsUsed(std::uint32_t first, std::uint32_t count, bool used);
+
+#ifdef _WIN32
+    // HANDLEs, kept as void* so windows.h stays out of the header
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+    const std::uint8_t* m_view;
+    std::uint64_t m_viewSize;
+    std::uint64_t m_fileSize;
+
+    // First sector << 8 | sector count, 0 for chunks that were never saved
+    std::uint32_t m_entries[REGION_CHUNKS];
+    std::vector<bool> m_usedSectors;
+};
+
+/*
+ * Every region file of a world.
+ *
+ * Region files are opened when first needed and a few are kept open, closing the least
+ * recently used one when another has to be opened. All functions may be called from any thread,
+ * the files are only locked while records are copied in and out, chunks are encoded and decoded
+ * outside of the lock.
+ */
+class RegionStorage
+{
+public:
+    // The folder is created if it does not exist yet.
+    explicit RegionStorage(const string_t& directory, std::size_t maxOpenFiles = 8);
+
+    RegionStorage(const RegionStorage&) = delete;
+    RegionStorage& operator=(const RegionStorage&) = delete;
+
+    // Returns false if the chunk has never been saved.
+    bool loadChunk(ChunkPos position, Chunk& chunk);
+    // data is the output of ChunkCodec::encode.
+    bool saveChunk(ChunkPos position, const std::vector<std::uint8_t>& data);
+    bool saveChunk(const Chunk& chunk);
+
+    static string_t getRegionFileName(int regionX, int regionZ);
+
+private:
+    RegionFile* getRegion(ChunkPos region, bool create);
+
+    string_t m_directory;
+    std::size_t m_maxOpenFiles;
+
+    std::mutex m_mutex;
+    // Most recently used first.
+    std::list<std::pair<ChunkPos, std::unique_ptr<RegionFile>>> m_open;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -0,0 +1,129 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <cstdint>
+
+namespace qore
+{
+namespace world
+{
+
+// The six sides of a chunk section.
+enum Face
+{
+    NEG_X = 0,
+    POS_X,
+    NEG_Y,
+    POS_Y,
+    NEG_Z,
+    POS_Z,
+    FACE_COUNT
+};
+
+inline Face getOppositeFace(int face)
+{
+    // Faces come in negative/positive pairs
+    return static_cast<Face>(face ^ 1);
+}
+
+/*
+ * Which sides of a section can be seen from which other sides by looking through the
+ * non opaque blocks inside it. A section of solid stone connects nothing, an empty section
+ * connects everything, and a cave running through a section connects the faces it touches.
+ *
+ * Each of the 15 pairs of different faces is one bit.
+ */
+class SectionVisibility
+{
+public:
+    SectionVisibility() : m_bits(ALL)
+    {
+    }
+
+    static SectionVisibility all()
+    {
+        return SectionVisibility(ALL);
+    }
+
+    static SectionVisibility none()
+    {
+        return SectionVisibility(0);
+    }
+
+    void connect(int a, int b)
+    {
+        if (a != b)
+        {
+            m_bits |= getBit(a, b);
+        }
+    }
+
+    // A face can always be seen from itself, looking in and back out of the same side.
+    bool canSee(int a, int b) const
+    {
+        return a == b || (m_bits & getBit(a, b)) != 0;
+    }
+
+    bool isAll() const
+    {
+        return m_bits == ALL;
+    }
+
+    bool operator==(const SectionVisibility& other) const
+    {
+        return m_bits == other.m_bits;
+    }
+
+private:
+    static const std::uint16_t ALL = 0x7fff;
+
+    explicit SectionVisibility(std::uint16_t bits) : m_bits(bits)
+    {
+    }
+
+    static std::uint16_t getBit(int a, int b)
+    {
+        if (a > b)
+        {
+            const int swap = a;
+            a = b;
+            b = swap;
+        }
+        // Pairs are numbered (0,1) (0,2) ... (0,5) (1,2) ... (4,5)
+        return static_cast<std::uint16_t>(1u << (a * (11 - a) / 2 + (b - a - 1)));
+    }
+
+    std::uint16_t m_bits;
+};
+
+} // namespace world
+
+} // namespace qore
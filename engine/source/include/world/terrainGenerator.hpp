@@ -0,0 +1,149 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunk.hpp"
+#include "util/noise.hpp"
+#include <cstdint>
+
+namespace qore
+{
+namespace world
+{
+
+enum class Biome : std::uint8_t
+{
+    PLAINS,
+    FOREST,
+    DESERT,
+    MOUNTAINS
+};
+
+struct TerrainSettings
+{
+    std::uint64_t seed = 0;
+    // Height of flat ground, hills and mountains rise above it and valleys dip below.
+    int baseHeight = 64;
+    int hillHeight = 16;
+    int mountainHeight = 72;
+    // Mountains above this height are capped with snow.
+    int snowHeight = 120;
+    // Larger values make more and wider caves, 0 turns them off.
+    float caveSize = 0.08f;
+    // Tree placement attempts per chunk, how many of them succeed depends on the biome.
+    int treeAttempts = 10;
+};
+
+/*
+ * Builds terrain from a world seed in five stages: heightmap, biome, surface, caves and decoration.
+ *
+ * Every stage is a function of the seed and block position only, random numbers come from a
+ * CounterRandom keyed by the chunk position. A chunk therefore comes out the same no matter
+ * how many threads generate the world or in which order, and trees reaching over a chunk
+ * border are placed by working out the trees of the neighbouring chunks as well.
+ *
+ * generate() does not change the generator, so one TerrainGenerator can be used as the
+ * ChunkGenerator of a ChunkManager and run on all of its workers at once.
+ */
+class TerrainGenerator
+{
+public:
+    explicit TerrainGenerator(const TerrainSettings& settings);
+
+    void generate(Chunk& chunk) const;
+
+    // Height of the highest solid block of a column before caves are carved, in world block coordinates.
+    int getHeight(int x, int z) const;
+    Biome getBiome(int x, int z) const;
+
+    const TerrainSettings& getSettings() const;
+
+private:
+    // Height and biome of every column of one chunk, shared between the stages.
+    struct ColumnData
+    {
+        // How mountainous each column is, 0 for lowland and 1 for the middle of a mountain range.
+        float mountainWeights[SECTION_AREA];
+        int heights[SECTION_AREA];
+        Biome biomes[SECTION_AREA];
+    };
+
+    // Cave noise is sampled every CAVE_CELL blocks, corners of the section included,
+    // and interpolated for the blocks in between.
+    static const int CAVE_CELL = 4;
+    static const int CAVE_LATTICE_SIZE = SECTION_SIZE / CAVE_CELL + 1;
+    static const int CAVE_LATTICE_VOLUME = CAVE_LATTICE_SIZE * CAVE_LATTICE_SIZE * CAVE_LATTICE_SIZE;
+
+    struct CaveLattice
+    {
+        // Caves are where both fields are close to 0.
+        float first[CAVE_LATTICE_VOLUME];
+        float second[CAVE_LATTICE_VOLUME];
+    };
+
+    // The stages after the heightmap and biomes write to the blocks of the whole chunk at once,
+    // stored section after section so each section can be handed to ChunkSection::setBlocks.
+    static int getIndex(int x, int y, int z)
+    {
+        return (y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x;
+    }
+
+    void generateHeightmap(ChunkPos position, ColumnData& columns) const;
+    void generateBiomes(ChunkPos position, ColumnData& columns) const;
+    void buildSurface(const ColumnData& columns, BlockId* blocks) const;
+    void carveCaves(ChunkPos position, const ColumnData& columns, BlockId* blocks) const;
+    void decorate(ChunkPos position, BlockId* blocks) const;
+
+    // Places the trees started by the chunk at origin, keeping the blocks that fall inside position.
+    void placeTrees(ChunkPos position, ChunkPos origin, BlockId* blocks) const;
+
+    // Noise for a width by depth area of columns starting at world position x, z. The stages sample
+    // a whole chunk and getHeight() and getBiome() a single column, both get the same values.
+    void sampleMountainWeights(int x, int z, int width, int depth, float* weights) const;
+    void sampleHeights(int x, int z, int width, int depth, const float* weights, int* heights) const;
+    void sampleBiomes(int x, int z, int width, int depth, const float* weights, Biome* biomes) const;
+
+    void sampleCaves(int sectionX, int sectionY, int sectionZ, CaveLattice& lattice) const;
+    // Coordinates are local to the lattice's section.
+    bool isCave(const CaveLattice& lattice, int x, int y, int z) const;
+    // Coordinates are world block coordinates.
+    bool isCave(int x, int y, int z) const;
+
+    TerrainSettings m_settings;
+
+    util::Noise m_heightNoise;
+    util::Noise m_mountainNoise;
+    util::Noise m_climateNoise;
+    util::Noise m_caveNoise;
+};
+
+} // namespace world
+
+} // namespace qore
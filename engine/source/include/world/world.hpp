@@ -0,0 +1,112 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include "world/chunk.hpp"
+#include "world/chunkMesher.hpp"
+#include "world/lightEngine.hpp"
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace qore
+{
+namespace world
+{
+
+/*
+ * All of the loaded chunks, addressed in world block coordinates.
+ *
+ * Every block edit marks the section it lands in as needing a new mesh, along with
+ * any neighbouring section whose faces could have been hidden or revealed by it.
+ * Dirty sections are only collected once, so many edits in one frame cost one remesh.
+ * Edits and newly added chunks also update the light through the World's LightEngine.
+ */
+class World
+{
+public:
+    World();
+
+    Chunk* getChunk(ChunkPos position);
+    const Chunk* getChunk(ChunkPos position) const;
+
+    // Takes ownership of the chunk, replacing any chunk already at its position.
+    // remesh can be false when the chunk's meshes are already known, then only the
+    // sections of the neighbouring chunks that touch it are marked dirty.
+    Chunk* addChunk(std::unique_ptr<Chunk> chunk, bool remesh = true);
+    // Both ways of removing a chunk mark the sections of the neighbouring chunks dirty,
+    // their border faces were hidden by it and now face an unloaded chunk.
+    void removeChunk(ChunkPos position);
+    // Removes the chunk and hands ownership back to the caller, nullptr if it was not loaded.
+    std::unique_ptr<Chunk> takeChunk(ChunkPos position);
+
+    std::size_t getChunkCount() const;
+
+    // Blocks in unloaded chunks, or above or below the world, read as air.
+    BlockId getBlock(int x, int y, int z) const;
+    // Returns false if the block is not in a loaded chunk.
+    bool setBlock(int x, int y, int z, BlockId id);
+
+    ChunkNeighbourhood getNeighbourhood(ChunkPos position) const;
+
+    void markSectionDirty(SectionPos position);
+    // Every section whose mesh could depend on the block, the one it is in and any other
+    // section within one block of it, diagonals included.
+    void markBlockDirty(int x, int y, int z);
+    // Every non empty section in the chunk and the sections next to it in the neighbouring chunks.
+    void markChunkDirty(ChunkPos position);
+    // Only the sections of the eight neighbouring chunks, diagonals included.
+    void markNeighboursDirty(ChunkPos position);
+
+    // Returns the dirty sections of loaded chunks and clears the dirty set.
+    std::vector<SectionPos> takeDirtySections();
+
+    LightEngine& getLightEngine();
+
+    static ChunkPos toChunkPos(int x, int z)
+    {
+        // Arithmetic shift rounds towards negative infinity, so -1 is in chunk -1
+        return {x >> 4, z >> 4};
+    }
+
+private:
+    std::unordered_map<ChunkPos, std::unique_ptr<Chunk>, ChunkPosHash> m_chunks;
+    std::unordered_set<SectionPos, SectionPosHash> m_dirty;
+    // Light updates mark the same section many times in a row
+    SectionPos m_lastDirty;
+    bool m_hasLastDirty;
+
+    LightEngine m_light;
+};
+
+} // namespace world
+
+} // namespace qore
@@ -93,3 +93,18 @@ string_t GameIOManager::getTexturePath( TextureType type )
             return 0;
     }
 }
+
+string_t GameIOManager::getSavesPath( )
+{
+    return m_gamePath + "/Saves";
+}
+
+string_t GameIOManager::getWorldPath( const string_t& worldName )
+{
+    return getSavesPath( ) + "/" + worldName;
+}
+
+string_t GameIOManager::getRegionPath( const string_t& worldName )
+{
+    return getWorldPath( worldName ) + "/Region";
+}
@@ -0,0 +1,241 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "util/frustum.hpp"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define QORE_CULL_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define QORE_CULL_SSE
+#endif
+
+using namespace qore::util;
+
+Frustum::Frustum()
+{
+    for (glm::vec4& plane : m_planes)
+    {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    setMatrix(viewProjection);
+}
+
+void Frustum::setMatrix(const glm::mat4& viewProjection)
+{
+    // Each plane is the last row of the matrix plus or minus one of the others.
+    // glm matrices are column major, so rows have to be gathered by hand.
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    m_planes[0] = rows[3] + rows[0]; // left
+    m_planes[1] = rows[3] - rows[0]; // right
+    m_planes[2] = rows[3] + rows[1]; // bottom
+    m_planes[3] = rows[3] - rows[1]; // top
+    m_planes[4] = rows[3] + rows[2]; // near
+    m_planes[5] = rows[3] - rows[2]; // far
+
+    for (glm::vec4& plane : m_planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+const glm::vec4& Frustum::getPlane(int index) const
+{
+    return m_planes[index];
+}
+
+bool Frustum::intersects(const glm::vec3& min, const glm::vec3& max) const
+{
+    for (const glm::vec4& plane : m_planes)
+    {
+        // The corner furthest along the plane normal, if it is outside the whole box is
+        const glm::vec3 corner(plane.x > 0.0f ? max.x : min.x,
+                               plane.y > 0.0f ? max.y : min.y,
+                               plane.z > 0.0f ? max.z : min.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t AabbList::add(const glm::vec3& min, const glm::vec3& max)
+{
+    minX.push_back(min.x);
+    minY.push_back(min.y);
+    minZ.push_back(min.z);
+    maxX.push_back(max.x);
+    maxY.push_back(max.y);
+    maxZ.push_back(max.z);
+    return minX.size() - 1;
+}
+
+void AabbList::set(std::size_t index, const glm::vec3& min, const glm::vec3& max)
+{
+    minX[index] = min.x;
+    minY[index] = min.y;
+    minZ[index] = min.z;
+    maxX[index] = max.x;
+    maxY[index] = max.y;
+    maxZ[index] = max.z;
+}
+
+void AabbList::removeSwap(std::size_t index)
+{
+    std::vector<float>* arrays[6] = { &minX, &minY, &minZ, &maxX, &maxY, &maxZ };
+    for (std::vector<float>* array : arrays)
+    {
+        (*array)[index] = array->back();
+        array->pop_back();
+    }
+}
+
+void AabbList::clear()
+{
+    std::vector<float>* arrays[6] = { &minX, &minY, &minZ, &maxX, &maxY, &maxZ };
+    for (std::vector<float>* array : arrays)
+    {
+        array->clear();
+    }
+}
+
+std::size_t AabbList::size() const
+{
+    return minX.size();
+}
+
+std::size_t qore::util::cullAabbs(const Frustum& frustum, const AabbList& boxes, std::vector<std::uint32_t>& visible)
+{
+    const std::size_t count = boxes.size();
+    const std::size_t start = visible.size();
+
+    // For every plane, the array holding each coordinate of the corner furthest along its normal.
+    // The choice only depends on the plane, so it is made once instead of once per box.
+    const float* cornerX[6];
+    const float* cornerY[6];
+    const float* cornerZ[6];
+    for (int p = 0; p < 6; p++)
+    {
+        const glm::vec4& plane = frustum.getPlane(p);
+        cornerX[p] = plane.x > 0.0f ? boxes.maxX.data() : boxes.minX.data();
+        cornerY[p] = plane.y > 0.0f ? boxes.maxY.data() : boxes.minY.data();
+        cornerZ[p] = plane.z > 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+    }
+
+    std::size_t i = 0;
+
+#if defined(QORE_CULL_AVX)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; p++)
+        {
+            const glm::vec4& plane = frustum.getPlane(p);
+            __m256 distance = _mm256_set1_ps(plane.w);
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(cornerX[p] + i)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(cornerY[p] + i)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(cornerZ[p] + i)));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        const int inside = ~_mm256_movemask_ps(outside) & 0xff;
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (inside & (1 << lane))
+            {
+                visible.push_back(static_cast<std::uint32_t>(i + lane));
+            }
+        }
+    }
+#elif defined(QORE_CULL_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++)
+        {
+            const glm::vec4& plane = frustum.getPlane(p);
+            __m128 distance = _mm_set1_ps(plane.w);
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(cornerX[p] + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(cornerY[p] + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(cornerZ[p] + i)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+
+        const int inside = ~_mm_movemask_ps(outside) & 0xf;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (inside & (1 << lane))
+            {
+                visible.push_back(static_cast<std::uint32_t>(i + lane));
+            }
+        }
+    }
+#endif
+
+    // Whatever does not fill a whole register, or everything without SIMD
+    for (; i < count; i++)
+    {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++)
+        {
+            const glm::vec4& plane = frustum.getPlane(p);
+            // Same order of operations as the SIMD paths so boxes on a plane are treated alike
+            inside = plane.w + plane.x * cornerX[p][i] + plane.y * cornerY[p][i] + plane.z * cornerZ[p][i] >= 0.0f;
+        }
+        if (inside)
+        {
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    return visible.size() - start;
+}
+
+const char* qore::util::getCullingBackend()
+{
+#if defined(QORE_CULL_AVX)
+    return "AVX";
+#elif defined(QORE_CULL_SSE)
+    return "SSE";
+#else
+    return "scalar";
+#endif
+}
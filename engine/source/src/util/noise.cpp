@@ -0,0 +1,704 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "util/noise.hpp"
+#include "util/random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define QORE_NOISE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QORE_NOISE_SSE2
+#endif
+
+using namespace qore::util;
+
+namespace
+{
+
+inline float fade(float t)
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+inline float lerp(float a, float b, float t)
+{
+    return a + t * (b - a);
+}
+
+// Dot product of the offset with one of 8 directions in 2D, the diagonals and the axes.
+const float GRADIENTS_2D[8][2] = {{1.0f, 1.0f}, {-1.0f, 1.0f}, {1.0f, -1.0f}, {-1.0f, -1.0f},
+                                  {1.0f, 0.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, -1.0f}};
+
+inline float gradient(int hash, float x, float y)
+{
+    const float* g = GRADIENTS_2D[hash & 7];
+    return g[0] * x + g[1] * y;
+}
+
+// Dot product of the offset with one of the 12 edge directions of a cube.
+inline float gradient(int hash, float x, float y, float z)
+{
+    const int h = hash & 15;
+    const float u = h < 8 ? x : y;
+    const float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+inline int floorToInt(float value)
+{
+    const int i = static_cast<int>(value);
+    return value < i ? i - 1 : i;
+}
+
+// Batches are padded to this many samples, enough for the widest kernel.
+const int BATCH_WIDTH = 8;
+
+// Warping samples the noise this far away, so the displacement does not follow the noise itself.
+const float WARP_OFFSET_X = 71.3f;
+const float WARP_OFFSET_Y = 137.9f;
+const float WARP_OFFSET_Z = 213.1f;
+
+#if defined(QORE_NOISE_AVX2)
+
+inline __m256 fade(__m256 t)
+{
+    __m256 r = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+    r = _mm256_add_ps(_mm256_mul_ps(t, r), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), r);
+}
+
+inline __m256 lerp(__m256 a, __m256 b, __m256 t)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+// Splits v into its floor, as integers, and what is left over.
+inline __m256 split(__m256 v, __m256i& floor)
+{
+    const __m256i truncated = _mm256_cvttps_epi32(v);
+    const __m256 rounded = _mm256_cvtepi32_ps(truncated);
+    // Negative values were rounded up, the comparison is all ones (-1) where that happened
+    const __m256 below = _mm256_cmp_ps(v, rounded, _CMP_LT_OQ);
+    floor = _mm256_add_epi32(truncated, _mm256_castps_si256(below));
+    return _mm256_sub_ps(v, _mm256_cvtepi32_ps(floor));
+}
+
+inline __m256 sign(__m256 v, __m256i hash, int bit, int shift)
+{
+    return _mm256_xor_ps(v, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(hash, _mm256_set1_epi32(bit)), shift)));
+}
+
+inline __m256 gradient(__m256i hash, __m256 x, __m256 y)
+{
+    hash = _mm256_and_si256(hash, _mm256_set1_epi32(7));
+    const __m256 diagonal = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), hash));
+    const __m256 bit1 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(hash, _mm256_set1_epi32(2)), _mm256_set1_epi32(2)));
+    const __m256 u = _mm256_blendv_ps(x, y, _mm256_andnot_ps(diagonal, bit1));
+    const __m256 v = _mm256_and_ps(diagonal, y);
+    return _mm256_add_ps(sign(u, hash, 1, 31), sign(v, hash, 2, 30));
+}
+
+inline __m256 gradient(__m256i hash, __m256 x, __m256 y, __m256 z)
+{
+    hash = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    const __m256 below8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), hash));
+    const __m256 below4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), hash));
+    const __m256 useX = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(hash, _mm256_set1_epi32(12)),
+                                                            _mm256_cmpeq_epi32(hash, _mm256_set1_epi32(14))));
+    const __m256 u = _mm256_blendv_ps(y, x, below8);
+    const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, useX), y, below4);
+    return _mm256_add_ps(sign(u, hash, 1, 31), sign(v, hash, 2, 30));
+}
+
+inline __m256i gather(const std::int32_t* table, __m256i index)
+{
+    return _mm256_i32gather_epi32(table, index, 4);
+}
+
+void sampleKernel(const std::int32_t* p, const float* xs, const float* ys, int count, float* out)
+{
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 onef = _mm256_set1_ps(1.0f);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256i xi, yi;
+        const __m256 x = split(_mm256_loadu_ps(xs + i), xi);
+        const __m256 y = split(_mm256_loadu_ps(ys + i), yi);
+        xi = _mm256_and_si256(xi, mask);
+        yi = _mm256_and_si256(yi, mask);
+
+        const __m256i a = _mm256_add_epi32(gather(p, xi), yi);
+        const __m256i b = _mm256_add_epi32(gather(p, _mm256_add_epi32(xi, one)), yi);
+
+        const __m256 u = fade(x);
+        const __m256 v = fade(y);
+        const __m256 x1 = _mm256_sub_ps(x, onef);
+        const __m256 y1 = _mm256_sub_ps(y, onef);
+
+        const __m256 result = lerp(lerp(gradient(gather(p, a), x, y), gradient(gather(p, b), x1, y), u),
+                                   lerp(gradient(gather(p, _mm256_add_epi32(a, one)), x, y1),
+                                        gradient(gather(p, _mm256_add_epi32(b, one)), x1, y1), u),
+                                   v);
+        _mm256_storeu_ps(out + i, result);
+    }
+}
+
+void sampleKernel(const std::int32_t* p, const float* xs, const float* ys, const float* zs, int count, float* out)
+{
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 onef = _mm256_set1_ps(1.0f);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        __m256i xi, yi, zi;
+        const __m256 x = split(_mm256_loadu_ps(xs + i), xi);
+        const __m256 y = split(_mm256_loadu_ps(ys + i), yi);
+        const __m256 z = split(_mm256_loadu_ps(zs + i), zi);
+        xi = _mm256_and_si256(xi, mask);
+        yi = _mm256_and_si256(yi, mask);
+        zi = _mm256_and_si256(zi, mask);
+
+        const __m256i a = _mm256_add_epi32(gather(p, xi), yi);
+        const __m256i aa = _mm256_add_epi32(gather(p, a), zi);
+        const __m256i ab = _mm256_add_epi32(gather(p, _mm256_add_epi32(a, one)), zi);
+        const __m256i b = _mm256_add_epi32(gather(p, _mm256_add_epi32(xi, one)), yi);
+        const __m256i ba = _mm256_add_epi32(gather(p, b), zi);
+        const __m256i bb = _mm256_add_epi32(gather(p, _mm256_add_epi32(b, one)), zi);
+
+        const __m256 u = fade(x);
+        const __m256 v = fade(y);
+        const __m256 w = fade(z);
+        const __m256 x1 = _mm256_sub_ps(x, onef);
+        const __m256 y1 = _mm256_sub_ps(y, onef);
+        const __m256 z1 = _mm256_sub_ps(z, onef);
+
+        const __m256 near = lerp(lerp(gradient(gather(p, aa), x, y, z), gradient(gather(p, ba), x1, y, z), u),
+                                 lerp(gradient(gather(p, ab), x, y1, z), gradient(gather(p, bb), x1, y1, z), u), v);
+        const __m256 far = lerp(lerp(gradient(gather(p, _mm256_add_epi32(aa, one)), x, y, z1),
+                                     gradient(gather(p, _mm256_add_epi32(ba, one)), x1, y, z1), u),
+                                lerp(gradient(gather(p, _mm256_add_epi32(ab, one)), x, y1, z1),
+                                     gradient(gather(p, _mm256_add_epi32(bb, one)), x1, y1, z1), u),
+                                v);
+        _mm256_storeu_ps(out + i, lerp(near, far, w));
+    }
+}
+
+#elif defined(QORE_NOISE_SSE2)
+
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 fade(__m128 t)
+{
+    __m128 r = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+    r = _mm_add_ps(_mm_mul_ps(t, r), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), r);
+}
+
+inline __m128 lerp(__m128 a, __m128 b, __m128 t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+// Splits v into its floor, as integers, and what is left over.
+inline __m128 split(__m128 v, __m128i& floor)
+{
+    const __m128i truncated = _mm_cvttps_epi32(v);
+    const __m128 rounded = _mm_cvtepi32_ps(truncated);
+    // Negative values were rounded up, the comparison is all ones (-1) where that happened
+    const __m128 below = _mm_cmplt_ps(v, rounded);
+    floor = _mm_add_epi32(truncated, _mm_castps_si128(below));
+    return _mm_sub_ps(v, _mm_cvtepi32_ps(floor));
+}
+
+inline __m128 sign(__m128 v, __m128i hash, int bit, int shift)
+{
+    return _mm_xor_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(bit)), shift)));
+}
+
+inline __m128 gradient(__m128i hash, __m128 x, __m128 y)
+{
+    hash = _mm_and_si128(hash, _mm_set1_epi32(7));
+    const __m128 diagonal = _mm_castsi128_ps(_mm_cmplt_epi32(hash, _mm_set1_epi32(4)));
+    const __m128 bit1 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hash, _mm_set1_epi32(2)), _mm_set1_epi32(2)));
+    const __m128 u = select(_mm_andnot_ps(diagonal, bit1), y, x);
+    const __m128 v = _mm_and_ps(diagonal, y);
+    return _mm_add_ps(sign(u, hash, 1, 31), sign(v, hash, 2, 30));
+}
+
+inline __m128 gradient(__m128i hash, __m128 x, __m128 y, __m128 z)
+{
+    hash = _mm_and_si128(hash, _mm_set1_epi32(15));
+    const __m128 below8 = _mm_castsi128_ps(_mm_cmplt_epi32(hash, _mm_set1_epi32(8)));
+    const __m128 below4 = _mm_castsi128_ps(_mm_cmplt_epi32(hash, _mm_set1_epi32(4)));
+    const __m128 useX = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(hash, _mm_set1_epi32(12)),
+                                                      _mm_cmpeq_epi32(hash, _mm_set1_epi32(14))));
+    const __m128 u = select(below8, x, y);
+    const __m128 v = select(below4, y, select(useX, x, z));
+    return _mm_add_ps(sign(u, hash, 1, 31), sign(v, hash, 2, 30));
+}
+
+inline __m128i load(const std::int32_t* values)
+{
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(values));
+}
+
+// SSE2 has no gathers, so the table lookups are done one lane at a time and the rest four at once.
+void sampleKernel(const std::int32_t* p, const float* xs, const float* ys, int count, float* out)
+{
+    const __m128i mask = _mm_set1_epi32(255);
+    const __m128 onef = _mm_set1_ps(1.0f);
+
+    alignas(16) std::int32_t xi[4], yi[4];
+    alignas(16) std::int32_t hashes[4][4];
+
+    for (int i = 0; i < count; i += 4)
+    {
+        __m128i xv, yv;
+        const __m128 x = split(_mm_loadu_ps(xs + i), xv);
+        const __m128 y = split(_mm_loadu_ps(ys + i), yv);
+        _mm_store_si128(reinterpret_cast<__m128i*>(xi), _mm_and_si128(xv, mask));
+        _mm_store_si128(reinterpret_cast<__m128i*>(yi), _mm_and_si128(yv, mask));
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            const int a = p[xi[lane]] + yi[lane];
+            const int b = p[xi[lane] + 1] + yi[lane];
+            hashes[0][lane] = p[a];
+            hashes[1][lane] = p[b];
+            hashes[2][lane] = p[a + 1];
+            hashes[3][lane] = p[b + 1];
+        }
+
+        const __m128 u = fade(x);
+        const __m128 v = fade(y);
+        const __m128 x1 = _mm_sub_ps(x, onef);
+        const __m128 y1 = _mm_sub_ps(y, onef);
+
+        const __m128 result = lerp(lerp(gradient(load(hashes[0]), x, y), gradient(load(hashes[1]), x1, y), u),
+                                   lerp(gradient(load(hashes[2]), x, y1), gradient(load(hashes[3]), x1, y1), u), v);
+        _mm_storeu_ps(out + i, result);
+    }
+}
+
+void sampleKernel(const std::int32_t* p, const float* xs, const float* ys, const float* zs, int count, float* out)
+{
+    const __m128i mask = _mm_set1_epi32(255);
+    const __m128 onef = _mm_set1_ps(1.0f);
+
+    alignas(16) std::int32_t xi[4], yi[4], zi[4];
+    alignas(16) std::int32_t hashes[8][4];
+
+    for (int i = 0; i < count; i += 4)
+    {
+        __m128i xv, yv, zv;
+        const __m128 x = split(_mm_loadu_ps(xs + i), xv);
+        const __m128 y = split(_mm_loadu_ps(ys + i), yv);
+        const __m128 z = split(_mm_loadu_ps(zs + i), zv);
+        _mm_store_si128(reinterpret_cast<__m128i*>(xi), _mm_and_si128(xv, mask));
+        _mm_store_si128(reinterpret_cast<__m128i*>(yi), _mm_and_si128(yv, mask));
+        _mm_store_si128(reinterpret_cast<__m128i*>(zi), _mm_and_si128(zv, mask));
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            const int a = p[xi[lane]] + yi[lane];
+            const int aa = p[a] + zi[lane];
+            const int ab = p[a + 1] + zi[lane];
+            const int b = p[xi[lane] + 1] + yi[lane];
+            const int ba = p[b] + zi[lane];
+            const int bb = p[b + 1] + zi[lane];
+            hashes[0][lane] = p[aa];
+            hashes[1][lane] = p[ba];
+            hashes[2][lane] = p[ab];
+            hashes[3][lane] = p[bb];
+            hashes[4][lane] = p[aa + 1];
+            hashes[5][lane] = p[ba + 1];
+            hashes[6][lane] = p[ab + 1];
+            hashes[7][lane] = p[bb + 1];
+        }
+
+        const __m128 u = fade(x);
+        const __m128 v = fade(y);
+        const __m128 w = fade(z);
+        const __m128 x1 = _mm_sub_ps(x, onef);
+        const __m128 y1 = _mm_sub_ps(y, onef);
+        const __m128 z1 = _mm_sub_ps(z, onef);
+
+        const __m128 near = lerp(lerp(gradient(load(hashes[0]), x, y, z), gradient(load(hashes[1]), x1, y, z), u),
+                                 lerp(gradient(load(hashes[2]), x, y1, z), gradient(load(hashes[3]), x1, y1, z), u), v);
+        const __m128 far = lerp(lerp(gradient(load(hashes[4]), x, y, z1), gradient(load(hashes[5]), x1, y, z1), u),
+                                lerp(gradient(load(hashes[6]), x, y1, z1), gradient(load(hashes[7]), x1, y1, z1), u), v);
+        _mm_storeu_ps(out + i, lerp(near, far, w));
+    }
+}
+
+#endif
+
+} // namespace
+
+Noise::Noise(std::uint64_t seed)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        m_permutation[i] = static_cast<std::uint8_t>(i);
+    }
+
+    CounterRandom random(seed);
+    for (int i = 255; i > 0; i--)
+    {
+        const int j = random.nextInt(i + 1);
+        const std::uint8_t swap = m_permutation[i];
+        m_permutation[i] = m_permutation[j];
+        m_permutation[j] = swap;
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        m_permutation[i + 256] = m_permutation[i];
+    }
+
+    for (int i = 0; i < 512; i++)
+    {
+        m_permutation32[i] = m_permutation[i];
+    }
+}
+
+float Noise::sample(float x, float y) const
+{
+    const int xi = floorToInt(x);
+    const int yi = floorToInt(y);
+    x -= xi;
+    y -= yi;
+    const int X = xi & 255;
+    const int Y = yi & 255;
+
+    const std::uint8_t* p = m_permutation;
+    const int a = p[X] + Y;
+    const int b = p[X + 1] + Y;
+
+    const float u = fade(x);
+    const float v = fade(y);
+
+    return lerp(lerp(gradient(p[a], x, y), gradient(p[b], x - 1.0f, y), u),
+                lerp(gradient(p[a + 1], x, y - 1.0f), gradient(p[b + 1], x - 1.0f, y - 1.0f), u), v);
+}
+
+float Noise::sample(float x, float y, float z) const
+{
+    const int xi = floorToInt(x);
+    const int yi = floorToInt(y);
+    const int zi = floorToInt(z);
+    x -= xi;
+    y -= yi;
+    z -= zi;
+    const int X = xi & 255;
+    const int Y = yi & 255;
+    const int Z = zi & 255;
+
+    const std::uint8_t* p = m_permutation;
+    const int a = p[X] + Y;
+    const int aa = p[a] + Z;
+    const int ab = p[a + 1] + Z;
+    const int b = p[X + 1] + Y;
+    const int ba = p[b] + Z;
+    const int bb = p[b + 1] + Z;
+
+    const float u = fade(x);
+    const float v = fade(y);
+    const float w = fade(z);
+
+    return lerp(lerp(lerp(gradient(p[aa], x, y, z), gradient(p[ba], x - 1.0f, y, z), u),
+                     lerp(gradient(p[ab], x, y - 1.0f, z), gradient(p[bb], x - 1.0f, y - 1.0f, z), u), v),
+                lerp(lerp(gradient(p[aa + 1], x, y, z - 1.0f), gradient(p[ba + 1], x - 1.0f, y, z - 1.0f), u),
+                     lerp(gradient(p[ab + 1], x, y - 1.0f, z - 1.0f), gradient(p[bb + 1], x - 1.0f, y - 1.0f, z - 1.0f), u), v),
+                w);
+}
+
+float Noise::fractal(float x, float y, int octaves, float lacunarity, float gain) const
+{
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int i = 0; i < octaves; i++)
+    {
+        sum += sample(x, y) * amplitude;
+        total += amplitude;
+        amplitude *= gain;
+        x *= lacunarity;
+        y *= lacunarity;
+    }
+    return sum / total;
+}
+
+float Noise::fractal(float x, float y, float z, int octaves, float lacunarity, float gain) const
+{
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int i = 0; i < octaves; i++)
+    {
+        sum += sample(x, y, z) * amplitude;
+        total += amplitude;
+        amplitude *= gain;
+        x *= lacunarity;
+        y *= lacunarity;
+        z *= lacunarity;
+    }
+    return sum / total;
+}
+
+float Noise::ridged(float x, float y, int octaves, float lacunarity, float gain) const
+{
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    float weight = 1.0f;
+    for (int i = 0; i < octaves; i++)
+    {
+        float ridge = 1.0f - std::fabs(sample(x, y));
+        ridge *= ridge * weight;
+        weight = ridge;
+        sum += ridge * amplitude;
+        total += amplitude;
+        amplitude *= gain;
+        x *= lacunarity;
+        y *= lacunarity;
+    }
+    return sum / total;
+}
+
+void Noise::fill2D(const NoiseGrid& grid, const FractalSettings& settings, float* out, bool reference) const
+{
+    const int count = grid.width * grid.depth;
+    const int padded = (count + BATCH_WIDTH - 1) / BATCH_WIDTH * BATCH_WIDTH;
+
+    std::vector<float> buffer(padded * 3, 0.0f);
+    float* x = buffer.data();
+    float* y = x + padded;
+    float* result = y + padded;
+
+    for (int k = 0; k < grid.depth; k++)
+    {
+        for (int i = 0; i < grid.width; i++)
+        {
+            x[k * grid.width + i] = grid.x + i * grid.stepX;
+            y[k * grid.width + i] = grid.z + k * grid.stepZ;
+        }
+    }
+
+    fillFractal(x, y, nullptr, padded, settings, result, reference);
+    std::copy(result, result + count, out);
+}
+
+void Noise::fill3D(const NoiseGrid& grid, const FractalSettings& settings, float* out, bool reference) const
+{
+    const int count = grid.width * grid.height * grid.depth;
+    const int padded = (count + BATCH_WIDTH - 1) / BATCH_WIDTH * BATCH_WIDTH;
+
+    std::vector<float> buffer(padded * 4, 0.0f);
+    float* x = buffer.data();
+    float* y = x + padded;
+    float* z = y + padded;
+    float* result = z + padded;
+
+    int index = 0;
+    for (int j = 0; j < grid.height; j++)
+    {
+        for (int k = 0; k < grid.depth; k++)
+        {
+            for (int i = 0; i < grid.width; i++, index++)
+            {
+                x[index] = grid.x + i * grid.stepX;
+                y[index] = grid.y + j * grid.stepY;
+                z[index] = grid.z + k * grid.stepZ;
+            }
+        }
+    }
+
+    fillFractal(x, y, z, padded, settings, result, reference);
+    std::copy(result, result + count, out);
+}
+
+void Noise::fillFractal(float* x, float* y, float* z, int count, const FractalSettings& settings, float* out,
+                        bool reference) const
+{
+    const bool warp = settings.warpStrength != 0.0f;
+    std::vector<float> buffer(count * (warp ? 8 : 2));
+    float* noise = buffer.data();
+    float* weight = noise + count;
+
+    if (warp)
+    {
+        const int axes = z != nullptr ? 3 : 2;
+        float* coordinates[3] = {x, y, z};
+        float* shifted[3] = {weight + count, weight + 2 * count, weight + 3 * count};
+        float* displacement[3] = {weight + 4 * count, weight + 5 * count, weight + 6 * count};
+        const float offsets[3] = {WARP_OFFSET_X, WARP_OFFSET_Y, WARP_OFFSET_Z};
+
+        // Every displacement is worked out from the unmoved position before any of them is applied
+        for (int axis = 0; axis < axes; axis++)
+        {
+            for (int c = 0; c < axes; c++)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    shifted[c][i] = coordinates[c][i] + offsets[axis];
+                }
+            }
+
+            if (axes == 3)
+            {
+                sampleBatch(shifted[0], shifted[1], shifted[2], count, displacement[axis], reference);
+            }
+            else
+            {
+                sampleBatch(shifted[0], shifted[1], count, displacement[axis], reference);
+            }
+        }
+
+        for (int c = 0; c < axes; c++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                coordinates[c][i] += displacement[c][i] * settings.warpStrength;
+            }
+        }
+    }
+
+    // The same sums as fractal() and ridged(), a whole batch per octave
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = 0.0f;
+        weight[i] = 1.0f;
+    }
+
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int octave = 0; octave < settings.octaves; octave++)
+    {
+        if (z != nullptr)
+        {
+            sampleBatch(x, y, z, count, noise, reference);
+        }
+        else
+        {
+            sampleBatch(x, y, count, noise, reference);
+        }
+
+        if (settings.type == FractalType::RIDGED)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                float ridge = 1.0f - std::fabs(noise[i]);
+                ridge *= ridge * weight[i];
+                weight[i] = ridge;
+                out[i] += ridge * amplitude;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < count; i++)
+            {
+                out[i] += noise[i] * amplitude;
+            }
+        }
+
+        total += amplitude;
+        amplitude *= settings.gain;
+        for (int i = 0; i < count; i++)
+        {
+            x[i] *= settings.lacunarity;
+            y[i] *= settings.lacunarity;
+        }
+        if (z != nullptr)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                z[i] *= settings.lacunarity;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        out[i] /= total;
+    }
+}
+
+void Noise::sampleBatch(const float* x, const float* y, int count, float* out, bool reference) const
+{
+#if defined(QORE_NOISE_AVX2) || defined(QORE_NOISE_SSE2)
+    if (!reference)
+    {
+        sampleKernel(m_permutation32, x, y, count, out);
+        return;
+    }
+#endif
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = sample(x[i], y[i]);
+    }
+}
+
+void Noise::sampleBatch(const float* x, const float* y, const float* z, int count, float* out, bool reference) const
+{
+#if defined(QORE_NOISE_AVX2) || defined(QORE_NOISE_SSE2)
+    if (!reference)
+    {
+        sampleKernel(m_permutation32, x, y, z, count, out);
+        return;
+    }
+#endif
+    for (int i = 0; i < count; i++)
+    {
+        out[i] = sample(x[i], y[i], z[i]);
+    }
+}
+
+const char* qore::util::getNoiseBackend()
+{
+#if defined(QORE_NOISE_AVX2)
+    return "AVX2";
+#elif defined(QORE_NOISE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
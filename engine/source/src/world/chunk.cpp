@@ -0,0 +1,138 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/chunk.hpp"
+#include <algorithm>
+
+using namespace qore::world;
+
+Chunk::Chunk(ChunkPos position) : m_position(position), m_meshingMode(MeshingMode::GREEDY), m_modified(false)
+{
+}
+
+ChunkPos Chunk::getPosition() const
+{
+    return m_position;
+}
+
+void Chunk::fill(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, BlockId id)
+{
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    minZ = std::max(minZ, 0);
+    maxX = std::min(maxX, CHUNK_WIDTH - 1);
+    maxY = std::min(maxY, CHUNK_HEIGHT - 1);
+    maxZ = std::min(maxZ, CHUNK_WIDTH - 1);
+
+    const bool fullColumn = minX == 0 && minZ == 0 && maxX == CHUNK_WIDTH - 1 && maxZ == CHUNK_WIDTH - 1;
+
+    for (int s = minY >> 4; s <= (maxY >> 4) && maxY >= minY; s++)
+    {
+        const int sectionMinY = std::max(minY - s * SECTION_SIZE, 0);
+        const int sectionMaxY = std::min(maxY - s * SECTION_SIZE, SECTION_SIZE - 1);
+
+        if (fullColumn && sectionMinY == 0 && sectionMaxY == SECTION_SIZE - 1)
+        {
+            m_sections[s].fill(id);
+            continue;
+        }
+
+        for (int y = sectionMinY; y <= sectionMaxY; y++)
+        {
+            for (int z = minZ; z <= maxZ; z++)
+            {
+                for (int x = minX; x <= maxX; x++)
+                {
+                    m_sections[s].setBlock(x, y, z, id);
+                }
+            }
+        }
+    }
+}
+
+ChunkSection& Chunk::getSection(int index)
+{
+    return m_sections[index];
+}
+
+const ChunkSection& Chunk::getSection(int index) const
+{
+    return m_sections[index];
+}
+
+NibbleArray& Chunk::getSkyLightSection(int index)
+{
+    return m_skyLight[index];
+}
+
+const NibbleArray& Chunk::getSkyLightSection(int index) const
+{
+    return m_skyLight[index];
+}
+
+NibbleArray& Chunk::getBlockLightSection(int index)
+{
+    return m_blockLight[index];
+}
+
+const NibbleArray& Chunk::getBlockLightSection(int index) const
+{
+    return m_blockLight[index];
+}
+
+std::size_t Chunk::getMemoryUsage() const
+{
+    std::size_t bytes = sizeof(Chunk) - sizeof(m_sections) - sizeof(m_skyLight) - sizeof(m_blockLight);
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        bytes += m_sections[i].getMemoryUsage() + m_skyLight[i].getMemoryUsage() + m_blockLight[i].getMemoryUsage();
+    }
+    return bytes;
+}
+
+MeshingMode Chunk::getMeshingMode() const
+{
+    return m_meshingMode;
+}
+
+void Chunk::setMeshingMode(MeshingMode mode)
+{
+    m_meshingMode = mode;
+}
+
+bool Chunk::isModified() const
+{
+    return m_modified;
+}
+
+void Chunk::setModified(bool modified)
+{
+    m_modified = modified;
+}
@@ -0,0 +1,285 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/chunkCache.hpp"
+#include "world/chunkCodec.hpp"
+#include <iterator>
+
+using namespace qore::world;
+
+ChunkCache::ChunkCache(std::size_t byteBudget, float hotFraction) : m_deferred(false), m_stats()
+{
+    setBudget(byteBudget, hotFraction);
+}
+
+void ChunkCache::insert(std::unique_ptr<Chunk> chunk)
+{
+    const ChunkPos position = chunk->getPosition();
+
+    auto existing = m_entries.find(position);
+    if (existing != m_entries.end())
+    {
+        erase(existing->second);
+    }
+
+    m_hot.emplace_front();
+    Entry& entry = m_hot.front();
+    entry.position = position;
+    entry.hot = true;
+    entry.chunk = std::move(chunk);
+    entry.bytes = getHotSize(entry);
+
+    m_entries[position] = m_hot.begin();
+    m_stats.hotCount++;
+    m_stats.hotBytes += entry.bytes;
+
+    enforceBudget();
+}
+
+void ChunkCache::insertMeshes(ChunkPos position, std::array<ChunkMesh, SECTION_COUNT>&& meshes)
+{
+    auto found = m_entries.find(position);
+    if (found == m_entries.end() || !found->second->hot)
+    {
+        return;
+    }
+
+    Entry& entry = *found->second;
+    m_stats.hotBytes -= entry.bytes;
+    entry.meshes.assign(std::make_move_iterator(meshes.begin()), std::make_move_iterator(meshes.end()));
+    entry.bytes = getHotSize(entry);
+    m_stats.hotBytes += entry.bytes;
+
+    enforceBudget();
+}
+
+bool ChunkCache::take(ChunkPos position, CachedChunk& cached)
+{
+    auto found = m_entries.find(position);
+    if (found == m_entries.end())
+    {
+        m_stats.misses++;
+        return false;
+    }
+
+    Entry& entry = *found->second;
+    if (entry.hot)
+    {
+        m_stats.hotHits++;
+        cached.chunk = std::move(entry.chunk);
+        cached.hasMeshes = !entry.meshes.empty();
+        std::move(entry.meshes.begin(), entry.meshes.end(), cached.meshes.begin());
+        cached.compressed.clear();
+    }
+    else if (entry.pending != nullptr)
+    {
+        // Still being compressed elsewhere, which only reads the chunk
+        m_stats.coldHits++;
+        cached.chunk.reset(new Chunk(*entry.pending));
+        cached.hasMeshes = false;
+        cached.compressed.clear();
+    }
+    else
+    {
+        m_stats.coldHits++;
+        cached.chunk.reset();
+        cached.hasMeshes = false;
+        cached.compressed = std::move(entry.compressed);
+    }
+
+    erase(found->second);
+    return true;
+}
+
+bool ChunkCache::contains(ChunkPos position) const
+{
+    return m_entries.find(position) != m_entries.end();
+}
+
+void ChunkCache::setDeferredCompression(bool deferred)
+{
+    m_deferred = deferred;
+}
+
+std::vector<std::shared_ptr<const Chunk>> ChunkCache::takePendingCompression()
+{
+    std::vector<std::shared_ptr<const Chunk>> pending;
+    pending.swap(m_pending);
+    return pending;
+}
+
+void ChunkCache::finishCompression(const std::shared_ptr<const Chunk>& chunk, std::vector<std::uint8_t>&& compressed)
+{
+    auto found = m_entries.find(chunk->getPosition());
+    if (found == m_entries.end() || found->second->pending != chunk)
+    {
+        return;
+    }
+
+    Entry& entry = *found->second;
+    m_stats.pendingCount--;
+    m_stats.pendingBytes -= entry.bytes;
+    entry.pending.reset();
+    setCompressed(entry, std::move(compressed));
+
+    enforceBudget();
+}
+
+void ChunkCache::clear()
+{
+    m_hot.clear();
+    m_cold.clear();
+    m_entries.clear();
+    m_pending.clear();
+
+    m_stats.hotCount = 0;
+    m_stats.coldCount = 0;
+    m_stats.hotBytes = 0;
+    m_stats.coldBytes = 0;
+    m_stats.pendingCount = 0;
+    m_stats.pendingBytes = 0;
+}
+
+std::size_t ChunkCache::getBudget() const
+{
+    return m_budget;
+}
+
+void ChunkCache::setBudget(std::size_t byteBudget, float hotFraction)
+{
+    m_budget = byteBudget;
+    m_hotBudget = static_cast<std::size_t>(byteBudget * hotFraction);
+    enforceBudget();
+}
+
+const ChunkCacheStats& ChunkCache::getStats() const
+{
+    return m_stats;
+}
+
+std::size_t ChunkCache::getHotSize(const Entry& entry)
+{
+    std::size_t bytes = sizeof(Entry) + entry.chunk->getMemoryUsage();
+    for (const ChunkMesh& mesh : entry.meshes)
+    {
+        bytes += mesh.vertices.capacity() * sizeof(ChunkVertex) + mesh.indices.capacity() * sizeof(std::uint16_t);
+    }
+    return bytes;
+}
+
+void ChunkCache::erase(EntryList::iterator entry)
+{
+    m_entries.erase(entry->position);
+
+    if (entry->hot)
+    {
+        m_stats.hotCount--;
+        m_stats.hotBytes -= entry->bytes;
+        m_hot.erase(entry);
+    }
+    else
+    {
+        if (entry->pending != nullptr)
+        {
+            m_stats.pendingCount--;
+            m_stats.pendingBytes -= entry->bytes;
+        }
+        else
+        {
+            m_stats.coldCount--;
+            m_stats.coldBytes -= entry->bytes;
+        }
+        m_cold.erase(entry);
+    }
+}
+
+void ChunkCache::demote(EntryList::iterator entry)
+{
+    m_stats.hotCount--;
+    m_stats.hotBytes -= entry->bytes;
+
+    entry->hot = false;
+    std::vector<ChunkMesh>().swap(entry->meshes);
+
+    // Demoted chunks are newer than anything already in the cold tier
+    m_cold.splice(m_cold.begin(), m_hot, entry);
+    m_stats.demotions++;
+
+    if (m_deferred)
+    {
+        entry->pending = std::shared_ptr<const Chunk>(std::move(entry->chunk));
+        entry->bytes = sizeof(Entry) + entry->pending->getMemoryUsage();
+        m_pending.push_back(entry->pending);
+        m_stats.pendingCount++;
+        m_stats.pendingBytes += entry->bytes;
+        return;
+    }
+
+    std::vector<std::uint8_t> compressed;
+    ChunkCodec::encode(*entry->chunk, compressed);
+    entry->chunk.reset();
+    setCompressed(*entry, std::move(compressed));
+}
+
+void ChunkCache::setCompressed(Entry& entry, std::vector<std::uint8_t>&& compressed)
+{
+    compressed.shrink_to_fit();
+    entry.compressed = std::move(compressed);
+    entry.bytes = sizeof(Entry) + entry.compressed.capacity();
+
+    m_stats.coldCount++;
+    m_stats.coldBytes += entry.bytes;
+}
+
+void ChunkCache::enforceBudget()
+{
+    while (m_stats.hotBytes > m_hotBudget && !m_hot.empty())
+    {
+        demote(std::prev(m_hot.end()));
+    }
+
+    while (m_stats.hotBytes + m_stats.coldBytes > m_budget)
+    {
+        // Chunks still waiting to be compressed are left alone, they do not count yet
+        auto oldest = m_cold.end();
+        while (oldest != m_cold.begin() && std::prev(oldest)->pending != nullptr)
+        {
+            --oldest;
+        }
+        if (oldest == m_cold.begin())
+        {
+            demote(std::prev(m_hot.end()));
+            continue;
+        }
+
+        m_stats.evictions++;
+        erase(std::prev(oldest));
+    }
+}
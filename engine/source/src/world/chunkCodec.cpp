@@ -0,0 +1,155 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/chunkCodec.hpp"
+#include <algorithm>
+
+using namespace qore::world;
+
+static const int CHUNK_VOLUME = SECTION_VOLUME * SECTION_COUNT;
+
+// LEB128, 7 bits per byte with the high bit set on every byte but the last
+static void writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+static bool readVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        if (data == end)
+        {
+            return false;
+        }
+        const std::uint8_t byte = *data++;
+        value |= std::uint32_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ChunkCodec::encode(const Chunk& chunk, std::vector<std::uint8_t>& out)
+{
+    BlockId current = AIR;
+    std::uint32_t length = 0;
+
+    auto extend = [&](BlockId id, std::uint32_t count)
+    {
+        if (id != current && length > 0)
+        {
+            writeVarint(out, current);
+            writeVarint(out, length);
+            length = 0;
+        }
+        current = id;
+        length += count;
+    };
+
+    for (int s = 0; s < SECTION_COUNT; s++)
+    {
+        const ChunkSection& section = chunk.getSection(s);
+        if (section.isUniform())
+        {
+            extend(section.getBlock(0, 0, 0), SECTION_VOLUME);
+            continue;
+        }
+
+        for (int y = 0; y < SECTION_SIZE; y++)
+        {
+            for (int z = 0; z < SECTION_SIZE; z++)
+            {
+                for (int x = 0; x < SECTION_SIZE; x++)
+                {
+                    extend(section.getBlock(x, y, z), 1);
+                }
+            }
+        }
+    }
+
+    writeVarint(out, current);
+    writeVarint(out, length);
+}
+
+bool ChunkCodec::decode(const std::uint8_t* data, std::size_t size, Chunk& chunk)
+{
+    const std::uint8_t* end = data + size;
+    int position = 0;
+
+    // Sections that are not a single run are collected here and loaded in one go
+    std::vector<BlockId> blocks(SECTION_VOLUME);
+
+    while (position < CHUNK_VOLUME)
+    {
+        std::uint32_t id;
+        std::uint32_t length;
+        if (!readVarint(data, end, id) || !readVarint(data, end, length))
+        {
+            return false;
+        }
+        if (id > 0xffff || length == 0 || length > std::uint32_t(CHUNK_VOLUME - position))
+        {
+            return false;
+        }
+
+        const int runEnd = position + static_cast<int>(length);
+        while (position < runEnd)
+        {
+            ChunkSection& section = chunk.getSection(position / SECTION_VOLUME);
+            const int local = position % SECTION_VOLUME;
+            const int count = std::min(runEnd - position, SECTION_VOLUME - local);
+
+            if (count == SECTION_VOLUME)
+            {
+                section.fill(static_cast<BlockId>(id));
+            }
+            else
+            {
+                std::fill_n(&blocks[local], count, static_cast<BlockId>(id));
+                if (local + count == SECTION_VOLUME)
+                {
+                    section.setBlocks(blocks.data());
+                }
+            }
+            position += count;
+        }
+    }
+
+    return data == end;
+}
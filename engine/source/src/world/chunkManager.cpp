@@ -0,0 +1,397 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/chunkManager.hpp"
+#include "world/chunkCodec.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace qore::world;
+
+ChunkManager::ChunkManager(World& world, ChunkGenerator generator, const StreamingSettings& settings, unsigned int threadCount)
+    : m_world(world), m_generator(std::move(generator)), m_settings(settings), m_cache(nullptr), m_storage(nullptr),
+      m_centre({0, 0}), m_hasCentre(false), m_allLoaded(false), m_jobs(threadCount)
+{
+}
+
+void ChunkManager::update(const glm::vec3& position, const glm::vec3& forward)
+{
+    const ChunkPos centre = World::toChunkPos(static_cast<int>(std::floor(position.x)), static_cast<int>(std::floor(position.z)));
+    const bool moved = !m_hasCentre || centre != m_centre;
+    m_centre = centre;
+    m_hasCentre = true;
+
+    finishSaves();
+    addGenerated();
+
+    if (moved)
+    {
+        unloadDistant();
+        m_allLoaded = false;
+    }
+
+    if (!m_allLoaded)
+    {
+        startGeneration(position, forward);
+    }
+
+    compressCached();
+}
+
+std::vector<ChunkPos> ChunkManager::takeUnloaded()
+{
+    std::vector<ChunkPos> unloaded;
+    unloaded.swap(m_unloaded);
+    return unloaded;
+}
+
+std::vector<RestoredMeshes> ChunkManager::takeRestoredMeshes()
+{
+    std::vector<RestoredMeshes> restored;
+    restored.swap(m_restored);
+    return restored;
+}
+
+void ChunkManager::setCache(ChunkCache* cache)
+{
+    m_cache = cache;
+    if (m_cache != nullptr)
+    {
+        // Chunks pushed out of the hot tier are compressed on the workers instead of in update()
+        m_cache->setDeferredCompression(true);
+    }
+}
+
+void ChunkManager::setStorage(RegionStorage* storage)
+{
+    m_storage = storage;
+}
+
+void ChunkManager::saveAll()
+{
+    for (const ChunkPos& position : m_loaded)
+    {
+        save(*m_world.getChunk(position));
+    }
+
+    // Finishing a save can start the one queued behind it
+    while (!m_saving.empty())
+    {
+        m_jobs.waitIdle();
+        finishSaves();
+    }
+}
+
+const StreamingSettings& ChunkManager::getSettings() const
+{
+    return m_settings;
+}
+
+void ChunkManager::setSettings(const StreamingSettings& settings)
+{
+    m_settings = settings;
+
+    // Force the next update to recheck which chunks should be loaded
+    m_hasCentre = false;
+}
+
+std::size_t ChunkManager::getLoadedCount() const
+{
+    return m_loaded.size();
+}
+
+std::size_t ChunkManager::getGeneratingCount() const
+{
+    return m_generating.size();
+}
+
+void ChunkManager::addGenerated()
+{
+    std::unique_ptr<Chunk> chunk;
+    for (unsigned int i = 0; i < m_settings.maxLoadsPerUpdate && m_generated.pop(chunk); i++)
+    {
+        const ChunkPos position = chunk->getPosition();
+        m_generating.erase(position);
+
+        // The viewer may have moved away while the chunk was being generated
+        if (!isInside(position, m_settings.renderDistance + m_settings.unloadMargin))
+        {
+            if (m_cache != nullptr)
+            {
+                m_cache->insert(std::move(chunk));
+            }
+            continue;
+        }
+
+        m_world.addChunk(std::move(chunk));
+        m_loaded.insert(position);
+    }
+}
+
+void ChunkManager::unloadDistant()
+{
+    const int radius = m_settings.renderDistance + m_settings.unloadMargin;
+
+    for (auto it = m_loaded.begin(); it != m_loaded.end();)
+    {
+        if (isInside(*it, radius))
+        {
+            ++it;
+            continue;
+        }
+
+        if (m_cache != nullptr)
+        {
+            std::unique_ptr<Chunk> chunk = m_world.takeChunk(*it);
+            save(*chunk);
+            m_cache->insert(std::move(chunk));
+        }
+        else if (m_storage != nullptr && m_world.getChunk(*it)->isModified())
+        {
+            // Nothing else needs the chunk, so it is handed to the save without a copy
+            std::shared_ptr<Chunk> chunk = m_world.takeChunk(*it);
+            chunk->setModified(false);
+            write(std::move(chunk));
+        }
+        else
+        {
+            m_world.removeChunk(*it);
+        }
+        m_unloaded.push_back(*it);
+        it = m_loaded.erase(it);
+    }
+}
+
+void ChunkManager::startGeneration(const glm::vec3& position, const glm::vec3& forward)
+{
+    if (m_generating.size() >= m_settings.maxGenerating)
+    {
+        return;
+    }
+
+    // Only the horizontal part of the view direction matters for picking columns
+    glm::vec2 facing(forward.x, forward.z);
+    const float facingLength = glm::length(facing);
+    facing = facingLength > 0.0f ? facing / facingLength : glm::vec2(0.0f);
+
+    struct Candidate
+    {
+        float priority;
+        ChunkPos position;
+    };
+    std::vector<Candidate> candidates;
+
+    const int radius = m_settings.renderDistance;
+    const glm::vec2 viewer(position.x, position.z);
+    for (int dz = -radius; dz <= radius; dz++)
+    {
+        for (int dx = -radius; dx <= radius; dx++)
+        {
+            const ChunkPos chunk = {m_centre.x + dx, m_centre.z + dz};
+            if (!isInside(chunk, radius) || m_loaded.count(chunk) != 0 || m_generating.count(chunk) != 0)
+            {
+                continue;
+            }
+
+            const glm::vec2 offset = glm::vec2((chunk.x + 0.5f) * CHUNK_WIDTH, (chunk.z + 0.5f) * CHUNK_WIDTH) - viewer;
+            const float distance = glm::length(offset);
+            const float alignment = distance > 0.0f ? glm::dot(offset / distance, facing) : 1.0f;
+
+            // Chunks straight behind the viewer count as twice as far away as those straight ahead
+            candidates.push_back({distance * (1.5f - 0.5f * alignment), chunk});
+        }
+    }
+
+    if (candidates.empty())
+    {
+        m_allLoaded = m_generating.empty();
+        return;
+    }
+
+    const std::size_t count = std::min<std::size_t>(candidates.size(), m_settings.maxGenerating - m_generating.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const Candidate& a, const Candidate& b) { return a.priority < b.priority; });
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        load(candidates[i].position);
+    }
+}
+
+void ChunkManager::load(ChunkPos position)
+{
+    std::shared_ptr<std::vector<std::uint8_t>> compressed;
+    std::shared_ptr<const Chunk> saving;
+
+    CachedChunk cached;
+    if (m_cache != nullptr && m_cache->take(position, cached))
+    {
+        if (cached.chunk != nullptr)
+        {
+            // Hot chunks are ready to use straight away
+            m_world.addChunk(std::move(cached.chunk), !cached.hasMeshes);
+            m_loaded.insert(position);
+            if (cached.hasMeshes)
+            {
+                m_restored.push_back({position, std::move(cached.meshes)});
+            }
+            return;
+        }
+
+        compressed = std::make_shared<std::vector<std::uint8_t>>(std::move(cached.compressed));
+    }
+    else
+    {
+        auto it = m_saving.find(position);
+        if (it != m_saving.end())
+        {
+            saving = it->second.next != nullptr ? it->second.next : it->second.writing;
+        }
+    }
+
+    m_generating.insert(position);
+
+    // Cold chunks are decoded on the workers too, so loading never stalls the caller
+    RegionStorage* storage = m_storage;
+    m_jobs.submit([this, position, compressed, saving, storage]
+    {
+        std::unique_ptr<Chunk> chunk;
+        if (saving != nullptr)
+        {
+            // The save may still be writing it, but it only reads the chunk too
+            chunk.reset(new Chunk(*saving));
+        }
+        else
+        {
+            chunk.reset(new Chunk(position));
+            const bool loaded = compressed != nullptr ? ChunkCodec::decode(compressed->data(), compressed->size(), *chunk)
+                                                      : storage != nullptr && storage->loadChunk(position, *chunk);
+            if (!loaded)
+            {
+                chunk.reset(new Chunk(position));
+                m_generator(*chunk);
+            }
+        }
+        // Light inside the chunk is worked out here, only the borders are left for the World
+        LightEngine::lightChunk(*chunk);
+        m_generated.push(std::move(chunk));
+    });
+}
+
+void ChunkManager::save(Chunk& chunk)
+{
+    if (m_storage == nullptr || !chunk.isModified())
+    {
+        return;
+    }
+
+    // Copying the palettes is much cheaper than encoding them, and leaves the chunk free to change
+    chunk.setModified(false);
+    write(std::make_shared<const Chunk>(chunk));
+}
+
+void ChunkManager::write(std::shared_ptr<const Chunk> chunk)
+{
+    const ChunkPos position = chunk->getPosition();
+    auto it = m_saving.find(position);
+    if (it != m_saving.end())
+    {
+        // Two saves of a chunk on different workers could finish in either order, so this one
+        // waits for the one being written. A copy already waiting is older and is dropped.
+        it->second.next = std::move(chunk);
+        return;
+    }
+
+    m_saving[position].writing = chunk;
+    startWrite(position, std::move(chunk));
+}
+
+void ChunkManager::startWrite(ChunkPos position, std::shared_ptr<const Chunk> chunk)
+{
+    RegionStorage* storage = m_storage;
+    m_jobs.submit([this, position, chunk, storage]
+    {
+        storage->saveChunk(*chunk);
+        m_saved.push(position);
+    });
+}
+
+void ChunkManager::finishSaves()
+{
+    ChunkPos position;
+    while (m_saved.pop(position))
+    {
+        auto it = m_saving.find(position);
+        if (it->second.next != nullptr)
+        {
+            it->second.writing = std::move(it->second.next);
+            startWrite(position, it->second.writing);
+        }
+        else
+        {
+            m_saving.erase(it);
+        }
+    }
+}
+
+void ChunkManager::compressCached()
+{
+    std::pair<std::shared_ptr<const Chunk>, std::vector<std::uint8_t>> compressed;
+    while (m_compressed.pop(compressed))
+    {
+        if (m_cache != nullptr)
+        {
+            m_cache->finishCompression(compressed.first, std::move(compressed.second));
+        }
+    }
+
+    if (m_cache == nullptr)
+    {
+        return;
+    }
+
+    // Includes chunks demoted by inserts made since the last update, such as insertMeshes
+    for (std::shared_ptr<const Chunk>& chunk : m_cache->takePendingCompression())
+    {
+        m_jobs.submit([this, chunk]
+        {
+            std::vector<std::uint8_t> data;
+            ChunkCodec::encode(*chunk, data);
+            m_compressed.push(std::make_pair(chunk, std::move(data)));
+        });
+    }
+}
+
+bool ChunkManager::isInside(ChunkPos position, int radius) const
+{
+    const int dx = position.x - m_centre.x;
+    const int dz = position.z - m_centre.z;
+    return dx * dx + dz * dz <= radius * radius;
+}
@@ -0,0 +1,494 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/chunkMesher.hpp"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace qore::world;
+
+const Chunk* ChunkNeighbourhood::getChunk(int& x, int& z) const
+{
+    const int column = x < 0 ? 0 : x >= CHUNK_WIDTH ? 2 : 1;
+    const int row = z < 0 ? 0 : z >= CHUNK_WIDTH ? 2 : 1;
+    x -= (column - 1) * CHUNK_WIDTH;
+    z -= (row - 1) * CHUNK_WIDTH;
+
+    const Chunk* const chunks[3][3] = {
+        {negXNegZ, negZ, posXNegZ},
+        {negX, centre, posX},
+        {negXPosZ, posZ, posXPosZ}
+    };
+    return chunks[row][column];
+}
+
+BlockId ChunkNeighbourhood::getBlock(int x, int y, int z) const
+{
+    if (y < 0 || y >= CHUNK_HEIGHT)
+    {
+        return AIR;
+    }
+
+    const Chunk* chunk = getChunk(x, z);
+    if (chunk == nullptr)
+    {
+        return AIR;
+    }
+    return chunk->getBlock(x, y, z);
+}
+
+std::uint8_t ChunkNeighbourhood::getLight(int x, int y, int z) const
+{
+    const std::uint8_t sky = MAX_LIGHT << 4;
+    if (y < 0)
+    {
+        return 0;
+    }
+    if (y >= CHUNK_HEIGHT)
+    {
+        return sky;
+    }
+
+    const Chunk* chunk = getChunk(x, z);
+    if (chunk == nullptr)
+    {
+        return sky;
+    }
+    return static_cast<std::uint8_t>((chunk->getSkyLight(x, y, z) << 4) | chunk->getBlockLight(x, y, z));
+}
+
+// Distance in the padded array between neighbouring blocks along x, y and z
+static const int STEP[3] = { 1, PADDED_SIZE * PADDED_SIZE, PADDED_SIZE };
+
+// Corner light of a face is kept in quarter levels, 0 to 60, so averages of up to four blocks
+// stay exact enough to tell apart. Each corner takes 12 bits, sky light in the low 6.
+// The ambient occlusion of the corners, 0 for a fully hidden corner to 3 for an open one,
+// takes 2 bits per corner above the light.
+static const int CORNER_BITS = 12;
+static const int OCCLUSION_SHIFT = 4 * CORNER_BITS;
+static const unsigned int QUARTER_LEVELS = 4 * MAX_LIGHT;
+static const unsigned int OCCLUSION_LEVELS = 3;
+
+// The vertex stores the block in a byte.
+static_assert(BLOCK_COUNT <= 256, "ChunkVertex::block is too small for every block");
+
+// Light and ambient occlusion at the four corners of a face, in the order addQuad emits its vertices.
+// front is the padded index of the open block the face looks into, axis the direction it faces.
+static std::uint64_t getFaceLight(const PaddedSection& padded, int front, int axis)
+{
+    const int u = STEP[(axis + 1) % 3];
+    const int v = STEP[(axis + 2) % 3];
+    const int corners[4][2] = {{-u, -v}, {u, -v}, {u, v}, {-u, v}};
+
+    std::uint64_t light = 0;
+    for (int c = 0; c < 4; c++)
+    {
+        const int side1 = front + corners[c][0];
+        const int side2 = front + corners[c][1];
+        const int diagonal = side1 + corners[c][1];
+        const bool open1 = !isOpaque(padded.blocks[side1]);
+        const bool open2 = !isOpaque(padded.blocks[side2]);
+        const bool openDiagonal = !isOpaque(padded.blocks[diagonal]);
+
+        // The classic three block occlusion, a corner between two solid sides is fully hidden
+        // whatever the diagonal holds
+        const std::uint64_t occlusion = !open1 && !open2 ? 0 : open1 + open2 + openDiagonal;
+        light |= occlusion << (OCCLUSION_SHIFT + 2 * c);
+
+        int sky = padded.light[front] >> 4;
+        int block = padded.light[front] & 15;
+        int count = 1;
+        const int samples[3] = {open1 ? side1 : -1, open2 ? side2 : -1,
+                                 (open1 || open2) && openDiagonal ? diagonal : -1};
+        for (int sample : samples)
+        {
+            if (sample >= 0)
+            {
+                sky += padded.light[sample] >> 4;
+                block += padded.light[sample] & 15;
+                count++;
+            }
+        }
+
+        const std::uint64_t skyQuarters = (sky * 4 + count / 2) / count;
+        const std::uint64_t blockQuarters = (block * 4 + count / 2) / count;
+        light |= (skyQuarters | (blockQuarters << 6)) << (c * CORNER_BITS);
+    }
+    return light;
+}
+
+// Quarter light levels and occlusion scaled to the 0..255 range of the vertex bytes.
+static std::uint8_t toByte(unsigned int value, unsigned int levels)
+{
+    return static_cast<std::uint8_t>((value * 255 + levels / 2) / levels);
+}
+
+static int getCornerOcclusion(std::uint64_t light, int corner)
+{
+    return static_cast<int>(light >> (OCCLUSION_SHIFT + 2 * corner)) & 3;
+}
+
+// Emits a width x height quad on one side of the block at position.
+// axis is 0, 1 or 2 for x, y or z and positive selects the +axis side, the quad
+// grows along the two other axes. light comes from getFaceLight, and also decides
+// which way the quad is split into triangles.
+static void addQuad(ChunkMesh& mesh, glm::ivec3 position, int axis, bool positive, int width, int height,
+                    std::uint64_t light, BlockId block)
+{
+    // The two axes spanning the face, chosen so u cross v points along +axis
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+
+    glm::ivec3 origin(position);
+    if (positive)
+    {
+        origin[axis] += 1;
+    }
+    glm::ivec3 du(0);
+    glm::ivec3 dv(0);
+    du[u] = width;
+    dv[v] = height;
+    const glm::ivec3 corners[4] = {origin, origin + du, origin + du + dv, origin + dv};
+
+    int occlusion[4];
+    const std::uint16_t base = static_cast<std::uint16_t>(mesh.vertices.size());
+    for (int c = 0; c < 4; c++)
+    {
+        occlusion[c] = getCornerOcclusion(light, c);
+
+        const unsigned int bits = static_cast<unsigned int>(light >> (c * CORNER_BITS));
+        ChunkVertex vertex;
+        vertex.x = static_cast<std::uint8_t>(corners[c].x);
+        vertex.y = static_cast<std::uint8_t>(corners[c].y);
+        vertex.z = static_cast<std::uint8_t>(corners[c].z);
+        vertex.face = static_cast<std::uint8_t>(axis * 2 + (positive ? 1 : 0));
+        vertex.skyLight = toByte(bits & 63, QUARTER_LEVELS);
+        vertex.blockLight = toByte((bits >> 6) & 63, QUARTER_LEVELS);
+        vertex.occlusion = toByte(occlusion[c], OCCLUSION_LEVELS);
+        vertex.block = static_cast<std::uint8_t>(block);
+        mesh.vertices.push_back(vertex);
+    }
+
+    // The quad is split along the diagonal joining its two brighter corners, otherwise the
+    // shading of a single dark corner is smeared across both triangles
+    const std::uint16_t first = occlusion[0] + occlusion[2] < occlusion[1] + occlusion[3] ? 1 : 0;
+    const std::uint16_t i0 = base + first;
+    const std::uint16_t i1 = base + (first + 1) % 4;
+    const std::uint16_t i2 = base + (first + 2) % 4;
+    const std::uint16_t i3 = base + (first + 3) % 4;
+
+    // Counter clockwise when seen from outside the block
+    if (positive)
+    {
+        mesh.indices.insert(mesh.indices.end(), {i0, i1, i2, i0, i2, i3});
+    }
+    else
+    {
+        mesh.indices.insert(mesh.indices.end(), {i0, i2, i1, i0, i3, i2});
+    }
+}
+
+// One quad for every visible block face.
+static void meshCulled(const PaddedSection& section, ChunkMesh& mesh)
+{
+    const BlockId* padded = section.blocks;
+
+    for (int y = 0; y < SECTION_SIZE; y++)
+    {
+        for (int z = 0; z < SECTION_SIZE; z++)
+        {
+            for (int x = 0; x < SECTION_SIZE; x++)
+            {
+                const int index = PaddedSection::getIndex(x, y, z);
+                if (padded[index] == AIR)
+                {
+                    continue;
+                }
+
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    if (!isOpaque(padded[index - STEP[axis]]))
+                    {
+                        addQuad(mesh, glm::ivec3(x, y, z), axis, false, 1, 1,
+                                getFaceLight(section, index - STEP[axis], axis), padded[index]);
+                    }
+                    if (!isOpaque(padded[index + STEP[axis]]))
+                    {
+                        addQuad(mesh, glm::ivec3(x, y, z), axis, true, 1, 1,
+                                getFaceLight(section, index + STEP[axis], axis), padded[index]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A visible face in a slice, faces are merged when both the block and the corner light match.
+struct FaceKey
+{
+    BlockId block;
+    std::uint64_t light;
+
+    bool operator==(const FaceKey& other) const
+    {
+        return block == other.block && light == other.light;
+    }
+};
+
+// Visible faces in each slice of the section are merged into as few rectangles as possible.
+static void meshGreedy(const PaddedSection& section, ChunkMesh& mesh)
+{
+    const BlockId* padded = section.blocks;
+
+    // The visible face at each position in the current slice, AIR where there is none
+    FaceKey mask[SECTION_AREA];
+    const FaceKey none = {AIR, 0};
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+
+        for (int side = 0; side < 2; side++)
+        {
+            const bool positive = side == 1;
+            const int facing = positive ? STEP[axis] : -STEP[axis];
+
+            for (int slice = 0; slice < SECTION_SIZE; slice++)
+            {
+                glm::ivec3 position;
+                position[axis] = slice;
+
+                for (int j = 0; j < SECTION_SIZE; j++)
+                {
+                    for (int i = 0; i < SECTION_SIZE; i++)
+                    {
+                        position[u] = i;
+                        position[v] = j;
+                        const int index = PaddedSection::getIndex(position.x, position.y, position.z);
+                        const BlockId block = padded[index];
+                        const bool visible = block != AIR && !isOpaque(padded[index + facing]);
+                        mask[j * SECTION_SIZE + i] = visible ? FaceKey{block, getFaceLight(section, index + facing, axis)} : none;
+                    }
+                }
+
+                for (int j = 0; j < SECTION_SIZE; j++)
+                {
+                    for (int i = 0; i < SECTION_SIZE;)
+                    {
+                        const FaceKey face = mask[j * SECTION_SIZE + i];
+                        if (face.block == AIR)
+                        {
+                            i++;
+                            continue;
+                        }
+
+                        // Grow along u as far as the same face continues
+                        int width = 1;
+                        while (i + width < SECTION_SIZE && mask[j * SECTION_SIZE + i + width] == face)
+                        {
+                            width++;
+                        }
+
+                        // Then along v while every face of the next row matches
+                        int height = 1;
+                        for (; j + height < SECTION_SIZE; height++)
+                        {
+                            const FaceKey* row = &mask[(j + height) * SECTION_SIZE + i];
+                            if (std::count(row, row + width, face) != width)
+                            {
+                                break;
+                            }
+                        }
+
+                        position[u] = i;
+                        position[v] = j;
+                        addQuad(mesh, position, axis, positive, width, height, face.light, face.block);
+
+                        for (int h = 0; h < height; h++)
+                        {
+                            std::fill_n(&mask[(j + h) * SECTION_SIZE + i], width, none);
+                        }
+                        i += width;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ChunkMesher::meshSection(const ChunkNeighbourhood& neighbourhood, int section, ChunkMesh& mesh)
+{
+    mesh.clear();
+    if (neighbourhood.centre->getSection(section).isEmpty())
+    {
+        return;
+    }
+
+    std::unique_ptr<PaddedSection> padded(new PaddedSection());
+    copySection(neighbourhood, section, *padded);
+    meshPadded(*padded, mesh);
+}
+
+void ChunkMesher::copySection(const ChunkNeighbourhood& neighbourhood, int section, PaddedSection& padded)
+{
+    padded.chunk = neighbourhood.centre->getPosition();
+    padded.section = section;
+    padded.mode = neighbourhood.centre->getMeshingMode();
+
+    const ChunkSection& blocks = neighbourhood.centre->getSection(section);
+    const NibbleArray& skyLight = neighbourhood.centre->getSkyLightSection(section);
+    const NibbleArray& blockLight = neighbourhood.centre->getBlockLightSection(section);
+    const int baseY = section * SECTION_SIZE;
+    for (int y = -1; y <= SECTION_SIZE; y++)
+    {
+        for (int z = -1; z <= SECTION_SIZE; z++)
+        {
+            for (int x = -1; x <= SECTION_SIZE; x++)
+            {
+                const int index = PaddedSection::getIndex(x, y, z);
+                const bool inside = x >= 0 && y >= 0 && z >= 0 && x < SECTION_SIZE && y < SECTION_SIZE && z < SECTION_SIZE;
+                if (inside)
+                {
+                    const int local = ChunkSection::getIndex(x, y, z);
+                    padded.blocks[index] = blocks.getBlock(x, y, z);
+                    padded.light[index] = static_cast<std::uint8_t>((skyLight.get(local) << 4) | blockLight.get(local));
+                }
+                else
+                {
+                    padded.blocks[index] = neighbourhood.getBlock(x, baseY + y, z);
+                    padded.light[index] = neighbourhood.getLight(x, baseY + y, z);
+                }
+            }
+        }
+    }
+}
+
+void ChunkMesher::meshPadded(const PaddedSection& padded, ChunkMesh& mesh)
+{
+    mesh.clear();
+
+    switch (padded.mode)
+    {
+        case MeshingMode::FACE_CULLING:
+            meshCulled(padded, mesh);
+            break;
+        case MeshingMode::GREEDY:
+            meshGreedy(padded, mesh);
+            break;
+    }
+
+    mesh.visibility = computeVisibility(padded);
+}
+
+SectionVisibility ChunkMesher::computeVisibility(const PaddedSection& padded)
+{
+    // Index of each block within the section, the padding is not part of the fill
+    bool visited[SECTION_VOLUME] = {};
+    int open = 0;
+    for (int i = 0; i < SECTION_VOLUME; i++)
+    {
+        const int x = i & 15;
+        const int z = (i >> 4) & 15;
+        const int y = i >> 8;
+        visited[i] = isOpaque(padded.blocks[PaddedSection::getIndex(x, y, z)]);
+        open += visited[i] ? 0 : 1;
+    }
+
+    if (open == 0)
+    {
+        return SectionVisibility::none();
+    }
+    if (open == SECTION_VOLUME)
+    {
+        return SectionVisibility::all();
+    }
+
+    SectionVisibility visibility = SectionVisibility::none();
+    std::vector<int> stack;
+    stack.reserve(SECTION_VOLUME);
+
+    for (int start = 0; start < SECTION_VOLUME; start++)
+    {
+        if (visited[start])
+        {
+            continue;
+        }
+
+        // The faces touched by this pocket of open blocks
+        unsigned int faces = 0;
+        visited[start] = true;
+        stack.push_back(start);
+
+        while (!stack.empty())
+        {
+            const int index = stack.back();
+            stack.pop_back();
+
+            const int x = index & 15;
+            const int z = (index >> 4) & 15;
+            const int y = index >> 8;
+
+            const int neighbours[FACE_COUNT] = {
+                x > 0 ? index - 1 : -1, x < SECTION_SIZE - 1 ? index + 1 : -1,
+                y > 0 ? index - SECTION_AREA : -1, y < SECTION_SIZE - 1 ? index + SECTION_AREA : -1,
+                z > 0 ? index - SECTION_SIZE : -1, z < SECTION_SIZE - 1 ? index + SECTION_SIZE : -1
+            };
+
+            for (int face = 0; face < FACE_COUNT; face++)
+            {
+                const int neighbour = neighbours[face];
+                if (neighbour < 0)
+                {
+                    faces |= 1u << face;
+                }
+                else if (!visited[neighbour])
+                {
+                    visited[neighbour] = true;
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+
+        for (int a = 0; a < FACE_COUNT; a++)
+        {
+            for (int b = a + 1; b < FACE_COUNT; b++)
+            {
+                if ((faces & (1u << a)) && (faces & (1u << b)))
+                {
+                    visibility.connect(a, b);
+                }
+            }
+        }
+    }
+
+    return visibility;
+}
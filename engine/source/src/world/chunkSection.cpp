@@ -0,0 +1,316 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/chunkSection.hpp"
+#include <algorithm>
+
+using namespace qore::world;
+
+// Palettes larger than this get a hash map for looking up block IDs.
+static const std::size_t LINEAR_SEARCH_LIMIT = 16;
+
+ChunkSection::ChunkSection()
+{
+    fill(AIR);
+}
+
+void ChunkSection::setBlock(int x, int y, int z, BlockId id)
+{
+    const int index = getIndex(x, y, z);
+    const BlockId previous = getBlock(x, y, z);
+    if (previous == id)
+    {
+        return;
+    }
+
+    if (m_bits == 0)
+    {
+        // Leaving the single block fast path, give the new block somewhere to live
+        resize(1);
+    }
+
+    const unsigned int oldSlot = readIndex(index);
+    const unsigned int newSlot = getPaletteSlot(id);
+    writeIndex(index, newSlot);
+
+    m_paletteCounts[newSlot]++;
+    m_paletteCounts[oldSlot]--;
+
+    if (previous == AIR)
+    {
+        m_nonAirCount++;
+    }
+    else if (id == AIR)
+    {
+        m_nonAirCount--;
+    }
+
+    // Drop back to the fast path once one block type fills the whole section
+    if (m_paletteCounts[newSlot] == SECTION_VOLUME)
+    {
+        fill(id);
+    }
+}
+
+void ChunkSection::fill(BlockId id)
+{
+    m_bits = 0;
+    m_nonAirCount = id == AIR ? 0 : SECTION_VOLUME;
+
+    m_palette.assign(1, id);
+    m_paletteCounts.assign(1, SECTION_VOLUME);
+    m_paletteLookup.clear();
+
+    m_data.clear();
+    m_data.shrink_to_fit();
+}
+
+void ChunkSection::setBlocks(const BlockId* blocks)
+{
+    m_palette.assign(1, blocks[0]);
+    m_paletteLookup.clear();
+
+    std::vector<std::uint16_t> slots(SECTION_VOLUME);
+    unsigned int nonAir = 0;
+
+    // Blocks come in runs, so only look the palette up when the ID changes
+    BlockId previous = blocks[0];
+    std::uint16_t slot = 0;
+    for (int i = 0; i < SECTION_VOLUME; i++)
+    {
+        const BlockId id = blocks[i];
+        if (id != previous)
+        {
+            previous = id;
+            if (m_paletteLookup.empty())
+            {
+                slot = static_cast<std::uint16_t>(std::find(m_palette.begin(), m_palette.end(), id) - m_palette.begin());
+            }
+            else
+            {
+                auto it = m_paletteLookup.find(id);
+                slot = it == m_paletteLookup.end() ? static_cast<std::uint16_t>(m_palette.size()) : it->second;
+            }
+
+            if (slot == m_palette.size())
+            {
+                m_palette.push_back(id);
+                if (m_palette.size() > LINEAR_SEARCH_LIMIT)
+                {
+                    for (std::size_t p = m_paletteLookup.size(); p < m_palette.size(); p++)
+                    {
+                        m_paletteLookup[m_palette[p]] = static_cast<std::uint16_t>(p);
+                    }
+                }
+            }
+        }
+
+        slots[i] = slot;
+        nonAir += id != AIR ? 1 : 0;
+    }
+
+    if (m_palette.size() == 1)
+    {
+        fill(blocks[0]);
+        return;
+    }
+
+    m_paletteCounts.assign(m_palette.size(), 0);
+    for (std::uint16_t s : slots)
+    {
+        m_paletteCounts[s]++;
+    }
+
+    unsigned int bits = 1;
+    while ((1u << bits) < m_palette.size())
+    {
+        bits++;
+    }
+    m_bits = bits;
+    m_nonAirCount = nonAir;
+
+    // Same layout as writePacked, but filling whole words at a time
+    m_data.assign((SECTION_VOLUME * bits + 63) / 64, 0);
+    std::uint64_t* word = m_data.data();
+    std::uint64_t current = 0;
+    unsigned int used = 0;
+    for (std::uint16_t s : slots)
+    {
+        current |= std::uint64_t(s) << used;
+        used += bits;
+        if (used >= 64)
+        {
+            *word++ = current;
+            used -= 64;
+            // The part of the value that did not fit starts the next word
+            current = used > 0 ? std::uint64_t(s) >> (bits - used) : 0;
+        }
+    }
+    if (used > 0)
+    {
+        *word = current;
+    }
+}
+
+bool ChunkSection::isEmpty() const
+{
+    return m_nonAirCount == 0;
+}
+
+bool ChunkSection::isUniform() const
+{
+    return m_bits == 0;
+}
+
+unsigned int ChunkSection::getBitsPerBlock() const
+{
+    return m_bits;
+}
+
+std::size_t ChunkSection::getPaletteSize() const
+{
+    return m_palette.size();
+}
+
+unsigned int ChunkSection::getBlockCount() const
+{
+    return m_nonAirCount;
+}
+
+std::size_t ChunkSection::getMemoryUsage() const
+{
+    std::size_t bytes = sizeof(ChunkSection);
+    bytes += m_palette.capacity() * sizeof(BlockId);
+    bytes += m_paletteCounts.capacity() * sizeof(std::uint16_t);
+    bytes += m_data.capacity() * sizeof(std::uint64_t);
+    // Rough cost of a node based hash map entry
+    bytes += m_paletteLookup.size() * (sizeof(void*) * 2 + sizeof(BlockId) + sizeof(std::uint16_t));
+    bytes += m_paletteLookup.bucket_count() * sizeof(void*);
+    return bytes;
+}
+
+void ChunkSection::writeIndex(int index, unsigned int value)
+{
+    writePacked(m_data, m_bits, index, value);
+}
+
+void ChunkSection::writePacked(std::vector<std::uint64_t>& data, unsigned int bits, int index, unsigned int value)
+{
+    const std::size_t bit = static_cast<std::size_t>(index) * bits;
+    const std::size_t word = bit >> 6;
+    const unsigned int offset = bit & 63;
+    const std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+
+    data[word] = (data[word] & ~(mask << offset)) | (std::uint64_t(value) << offset);
+    if (offset + bits > 64)
+    {
+        const unsigned int spill = 64 - offset;
+        data[word + 1] = (data[word + 1] & ~(mask >> spill)) | (std::uint64_t(value) >> spill);
+    }
+}
+
+unsigned int ChunkSection::getPaletteSlot(BlockId id)
+{
+    if (m_paletteLookup.empty())
+    {
+        for (std::size_t i = 0; i < m_palette.size(); i++)
+        {
+            if (m_palette[i] == id && m_paletteCounts[i] > 0)
+            {
+                return static_cast<unsigned int>(i);
+            }
+        }
+    }
+    else
+    {
+        auto it = m_paletteLookup.find(id);
+        if (it != m_paletteLookup.end())
+        {
+            return it->second;
+        }
+    }
+
+    // Reuse a slot that no block references any more before growing the palette
+    unsigned int slot;
+    auto freeSlot = std::find(m_paletteCounts.begin(), m_paletteCounts.end(), 0);
+    if (freeSlot != m_paletteCounts.end())
+    {
+        slot = static_cast<unsigned int>(freeSlot - m_paletteCounts.begin());
+        if (!m_paletteLookup.empty())
+        {
+            m_paletteLookup.erase(m_palette[slot]);
+        }
+        m_palette[slot] = id;
+    }
+    else
+    {
+        slot = static_cast<unsigned int>(m_palette.size());
+        m_palette.push_back(id);
+        m_paletteCounts.push_back(0);
+
+        if (slot >= (1u << m_bits))
+        {
+            resize(m_bits + 1);
+        }
+    }
+
+    if (m_palette.size() > LINEAR_SEARCH_LIMIT)
+    {
+        if (m_paletteLookup.empty())
+        {
+            for (std::size_t i = 0; i < m_palette.size(); i++)
+            {
+                if (m_paletteCounts[i] > 0)
+                {
+                    m_paletteLookup[m_palette[i]] = static_cast<std::uint16_t>(i);
+                }
+            }
+        }
+        m_paletteLookup[id] = static_cast<std::uint16_t>(slot);
+    }
+    return slot;
+}
+
+void ChunkSection::resize(unsigned int bitsPerBlock)
+{
+    std::vector<std::uint64_t> resized((SECTION_VOLUME * bitsPerBlock + 63) / 64, 0);
+
+    // Coming from the fast path every block is already palette slot 0
+    if (m_bits != 0)
+    {
+        for (int i = 0; i < SECTION_VOLUME; i++)
+        {
+            writePacked(resized, bitsPerBlock, i, readPacked(m_data, m_bits, i));
+        }
+    }
+
+    m_data.swap(resized);
+    m_bits = bitsPerBlock;
+}
@@ -0,0 +1,431 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/lightEngine.hpp"
+#include "world/world.hpp"
+#include <algorithm>
+
+using namespace qore::world;
+
+namespace
+{
+
+const int CHUNK_VOLUME = CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT;
+
+// Offsets to the six neighbours of a block, in Face order so DOWN is NEG_Y.
+const int OFFSETS[6][3] = {{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+const int DOWN = 2;
+
+int getIndex(int x, int y, int z)
+{
+    return (y * CHUNK_WIDTH + z) * CHUNK_WIDTH + x;
+}
+
+} // namespace
+
+LightEngine::LightEngine(World& world) : m_world(world), m_lastChunk(nullptr), m_lastPosition({0, 0})
+{
+}
+
+void LightEngine::lightChunk(Chunk& chunk)
+{
+    // Light is worked out in flat arrays and packed into the sections at the end
+    std::vector<std::uint8_t> opaque(CHUNK_VOLUME);
+    std::vector<std::uint8_t> light[2] = {std::vector<std::uint8_t>(CHUNK_VOLUME, 0),
+                                          std::vector<std::uint8_t>(CHUNK_VOLUME, 0)};
+    std::vector<int> queues[2];
+
+    for (int s = 0; s < SECTION_COUNT; s++)
+    {
+        const ChunkSection& section = chunk.getSection(s);
+        if (section.isUniform())
+        {
+            const BlockId id = section.getBlock(0, 0, 0);
+            std::fill_n(&opaque[s * SECTION_VOLUME], SECTION_VOLUME, isOpaque(id) ? 1 : 0);
+            if (getLightEmission(id) == 0)
+            {
+                continue;
+            }
+        }
+
+        for (int i = 0; i < SECTION_VOLUME; i++)
+        {
+            const BlockId id = section.getBlock(i & 15, i >> 8, (i >> 4) & 15);
+            const int index = s * SECTION_VOLUME + i;
+            opaque[index] = isOpaque(id) ? 1 : 0;
+
+            const int emission = getLightEmission(id);
+            if (emission > 0)
+            {
+                light[BLOCK][index] = static_cast<std::uint8_t>(emission);
+                queues[BLOCK].push_back(index);
+            }
+        }
+    }
+
+    // Sunlight falls down every column until it reaches the first opaque block
+    int tops[SECTION_AREA];
+    for (int column = 0; column < SECTION_AREA; column++)
+    {
+        int y = CHUNK_HEIGHT - 1;
+        for (; y >= 0 && !opaque[y * SECTION_AREA + column]; y--)
+        {
+            light[SKY][y * SECTION_AREA + column] = MAX_LIGHT;
+        }
+        tops[column] = y;
+    }
+
+    // Only sunlit blocks beside a taller column can spread light sideways under an overhang
+    for (int z = 0; z < CHUNK_WIDTH; z++)
+    {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            int highest = -1;
+            if (x > 0)
+            {
+                highest = std::max(highest, tops[z * CHUNK_WIDTH + x - 1]);
+            }
+            if (x < CHUNK_WIDTH - 1)
+            {
+                highest = std::max(highest, tops[z * CHUNK_WIDTH + x + 1]);
+            }
+            if (z > 0)
+            {
+                highest = std::max(highest, tops[(z - 1) * CHUNK_WIDTH + x]);
+            }
+            if (z < CHUNK_WIDTH - 1)
+            {
+                highest = std::max(highest, tops[(z + 1) * CHUNK_WIDTH + x]);
+            }
+
+            for (int y = tops[z * CHUNK_WIDTH + x] + 1; y <= highest; y++)
+            {
+                queues[SKY].push_back(getIndex(x, y, z));
+            }
+        }
+    }
+
+    for (int channel = SKY; channel <= BLOCK; channel++)
+    {
+        std::vector<std::uint8_t>& levels = light[channel];
+        std::vector<int>& queue = queues[channel];
+
+        for (std::size_t head = 0; head < queue.size(); head++)
+        {
+            const int index = queue[head];
+            const int level = levels[index];
+            if (level <= 1)
+            {
+                continue;
+            }
+
+            const int x = index & 15;
+            const int z = (index >> 4) & 15;
+            const int y = index >> 8;
+
+            for (int face = 0; face < 6; face++)
+            {
+                const int nx = x + OFFSETS[face][0];
+                const int ny = y + OFFSETS[face][1];
+                const int nz = z + OFFSETS[face][2];
+                if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_WIDTH || ny >= CHUNK_HEIGHT || nz >= CHUNK_WIDTH)
+                {
+                    continue;
+                }
+
+                const int neighbour = getIndex(nx, ny, nz);
+                const int target = channel == SKY && face == DOWN && level == MAX_LIGHT ? MAX_LIGHT : level - 1;
+                if (!opaque[neighbour] && levels[neighbour] < target)
+                {
+                    levels[neighbour] = static_cast<std::uint8_t>(target);
+                    queue.push_back(neighbour);
+                }
+            }
+        }
+    }
+
+    for (int s = 0; s < SECTION_COUNT; s++)
+    {
+        chunk.getSkyLightSection(s).setAll(&light[SKY][s * SECTION_VOLUME]);
+        chunk.getBlockLightSection(s).setAll(&light[BLOCK][s * SECTION_VOLUME]);
+    }
+}
+
+void LightEngine::addChunk(ChunkPos position)
+{
+    m_lastChunk = nullptr;
+    m_stats = LightStats();
+
+    const int baseX = position.x * CHUNK_WIDTH;
+    const int baseZ = position.z * CHUNK_WIDTH;
+
+    for (int channel = SKY; channel <= BLOCK; channel++)
+    {
+        // Light flows both ways over every border shared with a loaded chunk
+        for (int side = 0; side < 4; side++)
+        {
+            const int dx = side == 0 ? -1 : side == 1 ? 1 : 0;
+            const int dz = side == 2 ? -1 : side == 3 ? 1 : 0;
+            if (m_world.getChunk({position.x + dx, position.z + dz}) == nullptr)
+            {
+                continue;
+            }
+
+            for (int i = 0; i < CHUNK_WIDTH; i++)
+            {
+                // Block just inside this chunk's border, and the one just across it
+                const int x = dx < 0 ? baseX : dx > 0 ? baseX + CHUNK_WIDTH - 1 : baseX + i;
+                const int z = dz < 0 ? baseZ : dz > 0 ? baseZ + CHUNK_WIDTH - 1 : baseZ + i;
+
+                for (int y = 0; y < CHUNK_HEIGHT; y++)
+                {
+                    const int inside = getLight(static_cast<Channel>(channel), x, y, z);
+                    if (inside > 1)
+                    {
+                        m_addQueue.push_back({x, y, z, inside});
+                    }
+                    const int across = getLight(static_cast<Channel>(channel), x + dx, y, z + dz);
+                    if (across > 1)
+                    {
+                        m_addQueue.push_back({x + dx, y, z + dz, across});
+                    }
+                }
+            }
+        }
+        propagate(static_cast<Channel>(channel));
+    }
+}
+
+void LightEngine::updateBlock(int x, int y, int z, BlockId previous)
+{
+    m_lastChunk = nullptr;
+    m_stats = LightStats();
+
+    Chunk* chunk = findChunk(x, z);
+    if (chunk == nullptr || y < 0 || y >= CHUNK_HEIGHT)
+    {
+        return;
+    }
+    const BlockId current = chunk->getBlock(x & 15, y, z & 15);
+
+    // Block light: clear whatever the old block let through or gave off, then light the new one
+    const int oldBlockLight = getLight(BLOCK, x, y, z);
+    if (oldBlockLight > 0 && (isOpaque(current) || getLightEmission(previous) > 0))
+    {
+        setLight(BLOCK, x, y, z, 0);
+        m_removeQueue.push_back({x, y, z, oldBlockLight});
+        unpropagate(BLOCK);
+    }
+
+    const int emission = getLightEmission(current);
+    if (emission > getLight(BLOCK, x, y, z))
+    {
+        setLight(BLOCK, x, y, z, emission);
+        m_addQueue.push_back({x, y, z, emission});
+    }
+    if (!isOpaque(current))
+    {
+        queueNeighbours(BLOCK, x, y, z);
+    }
+    propagate(BLOCK);
+
+    // Sky light: an opaque block casts a shadow, an opened up block lets light in from around it
+    const int oldSkyLight = getLight(SKY, x, y, z);
+    if (isOpaque(current))
+    {
+        if (oldSkyLight > 0)
+        {
+            setLight(SKY, x, y, z, 0);
+            m_removeQueue.push_back({x, y, z, oldSkyLight});
+            unpropagate(SKY);
+        }
+    }
+    else
+    {
+        // Nothing above the top of the world blocks the sky
+        if (y == CHUNK_HEIGHT - 1)
+        {
+            setLight(SKY, x, y, z, MAX_LIGHT);
+            m_addQueue.push_back({x, y, z, MAX_LIGHT});
+        }
+        queueNeighbours(SKY, x, y, z);
+    }
+    propagate(SKY);
+}
+
+const LightStats& LightEngine::getStats() const
+{
+    return m_stats;
+}
+
+Chunk* LightEngine::findChunk(int x, int z)
+{
+    const ChunkPos position = World::toChunkPos(x, z);
+    if (m_lastChunk == nullptr || position != m_lastPosition)
+    {
+        Chunk* chunk = m_world.getChunk(position);
+        if (chunk == nullptr)
+        {
+            return nullptr;
+        }
+        m_lastChunk = chunk;
+        m_lastPosition = position;
+    }
+    return m_lastChunk;
+}
+
+int LightEngine::getLight(Channel channel, int x, int y, int z)
+{
+    if (y < 0 || y >= CHUNK_HEIGHT)
+    {
+        return 0;
+    }
+    const Chunk* chunk = findChunk(x, z);
+    if (chunk == nullptr)
+    {
+        return 0;
+    }
+    return channel == SKY ? chunk->getSkyLight(x & 15, y, z & 15) : chunk->getBlockLight(x & 15, y, z & 15);
+}
+
+void LightEngine::setLight(Channel channel, int x, int y, int z, int level)
+{
+    Chunk* chunk = findChunk(x, z);
+    if (channel == SKY)
+    {
+        chunk->setSkyLight(x & 15, y, z & 15, level);
+    }
+    else
+    {
+        chunk->setBlockLight(x & 15, y, z & 15, level);
+    }
+    m_world.markBlockDirty(x, y, z);
+}
+
+void LightEngine::queueNeighbours(Channel channel, int x, int y, int z)
+{
+    for (int face = 0; face < 6; face++)
+    {
+        const int nx = x + OFFSETS[face][0];
+        const int ny = y + OFFSETS[face][1];
+        const int nz = z + OFFSETS[face][2];
+        const int level = getLight(channel, nx, ny, nz);
+        if (level > 0)
+        {
+            m_addQueue.push_back({nx, ny, nz, level});
+        }
+    }
+}
+
+void LightEngine::unpropagate(Channel channel)
+{
+    for (std::size_t head = 0; head < m_removeQueue.size(); head++)
+    {
+        const Node node = m_removeQueue[head];
+
+        for (int face = 0; face < 6; face++)
+        {
+            const int nx = node.x + OFFSETS[face][0];
+            const int ny = node.y + OFFSETS[face][1];
+            const int nz = node.z + OFFSETS[face][2];
+            const int level = getLight(channel, nx, ny, nz);
+            if (level == 0)
+            {
+                continue;
+            }
+
+            // Dimmer neighbours, and full sunlight below full sunlight, were lit through the removed
+            // block and go dark too. Anything else is lit from elsewhere and refills the gap
+            const bool litThrough = level < node.level ||
+                                    (channel == SKY && face == DOWN && node.level == MAX_LIGHT && level == MAX_LIGHT);
+            if (!litThrough)
+            {
+                m_addQueue.push_back({nx, ny, nz, level});
+                continue;
+            }
+
+            setLight(channel, nx, ny, nz, 0);
+            m_removeQueue.push_back({nx, ny, nz, level});
+            m_stats.darkened++;
+
+            // Light sources keep shining
+            if (channel == BLOCK)
+            {
+                const int emission = getLightEmission(findChunk(nx, nz)->getBlock(nx & 15, ny, nz & 15));
+                if (emission > 0)
+                {
+                    setLight(channel, nx, ny, nz, emission);
+                    m_addQueue.push_back({nx, ny, nz, emission});
+                }
+            }
+        }
+    }
+    m_removeQueue.clear();
+}
+
+void LightEngine::propagate(Channel channel)
+{
+    for (std::size_t head = 0; head < m_addQueue.size(); head++)
+    {
+        const Node node = m_addQueue[head];
+        // The block may have been lit brighter since it was queued
+        const int level = getLight(channel, node.x, node.y, node.z);
+        if (level <= 1)
+        {
+            continue;
+        }
+
+        for (int face = 0; face < 6; face++)
+        {
+            const int nx = node.x + OFFSETS[face][0];
+            const int ny = node.y + OFFSETS[face][1];
+            const int nz = node.z + OFFSETS[face][2];
+            if (ny < 0 || ny >= CHUNK_HEIGHT)
+            {
+                continue;
+            }
+
+            Chunk* chunk = findChunk(nx, nz);
+            if (chunk == nullptr || isOpaque(chunk->getBlock(nx & 15, ny, nz & 15)))
+            {
+                continue;
+            }
+
+            const int target = channel == SKY && face == DOWN && level == MAX_LIGHT ? MAX_LIGHT : level - 1;
+            if (getLight(channel, nx, ny, nz) < target)
+            {
+                setLight(channel, nx, ny, nz, target);
+                m_addQueue.push_back({nx, ny, nz, target});
+                m_stats.lit++;
+            }
+        }
+    }
+    m_addQueue.clear();
+}
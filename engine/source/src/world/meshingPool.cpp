@@ -0,0 +1,74 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/meshingPool.hpp"
+#include <memory>
+
+using namespace qore::world;
+
+MeshingPool::MeshingPool(unsigned int threadCount) : m_inFlight(0), m_nextTicket(1), m_jobs(threadCount)
+{
+}
+
+std::uint64_t MeshingPool::submit(const ChunkNeighbourhood& neighbourhood, int section)
+{
+    std::shared_ptr<PaddedSection> padded = std::make_shared<PaddedSection>();
+    ChunkMesher::copySection(neighbourhood, section, *padded);
+
+    const std::uint64_t ticket = m_nextTicket++;
+
+    m_inFlight++;
+    m_jobs.submit([this, padded, ticket]
+    {
+        MeshResult result;
+        result.chunk = padded->chunk;
+        result.section = padded->section;
+        result.ticket = ticket;
+        ChunkMesher::meshPadded(*padded, result.mesh);
+
+        m_completed.push(std::move(result));
+    });
+    return ticket;
+}
+
+bool MeshingPool::popCompleted(MeshResult& result)
+{
+    if (!m_completed.pop(result))
+    {
+        return false;
+    }
+    m_inFlight--;
+    return true;
+}
+
+unsigned int MeshingPool::getInFlightCount() const
+{
+    return m_inFlight.load();
+}
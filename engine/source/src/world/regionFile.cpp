@@ -0,0 +1,523 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/regionFile.hpp"
+#include "world/chunkCodec.hpp"
+#include "util/crc32.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace qore::world;
+
+namespace
+{
+
+const std::uint32_t SECTOR_SIZE = 4096;
+const std::uint32_t HEADER_SECTORS = 2;
+
+const std::uint32_t MAGIC = 0x31475251; // "QRG1"
+const std::uint32_t VERSION = 1;
+
+// magic, version and two reserved words come before the table of chunk entries
+const std::uint32_t TABLE_OFFSET = 16;
+
+const std::uint32_t RECORD_HEADER_SIZE = 12;
+// Sector counts are stored in 8 bits
+const std::uint32_t MAX_CHUNK_SECTORS = 255;
+
+enum Compression : std::uint8_t
+{
+    RUN_LENGTH = 1
+};
+
+int getEntryIndex(int x, int z)
+{
+    return z * REGION_SIZE + x;
+}
+
+std::uint32_t readWord(const std::uint8_t* data)
+{
+    return std::uint32_t(data[0]) | std::uint32_t(data[1]) << 8 | std::uint32_t(data[2]) << 16 | std::uint32_t(data[3]) << 24;
+}
+
+void writeWord(std::uint8_t* data, std::uint32_t value)
+{
+    data[0] = static_cast<std::uint8_t>(value);
+    data[1] = static_cast<std::uint8_t>(value >> 8);
+    data[2] = static_cast<std::uint8_t>(value >> 16);
+    data[3] = static_cast<std::uint8_t>(value >> 24);
+}
+
+} // namespace
+
+RegionFile::RegionFile() :
+#ifdef _WIN32
+    m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr),
+#else
+    m_file(-1),
+#endif
+    m_view(nullptr), m_viewSize(0), m_fileSize(0)
+{
+    std::fill_n(m_entries, REGION_CHUNKS, 0u);
+}
+
+RegionFile::~RegionFile()
+{
+    close();
+}
+
+bool RegionFile::open(const string_t& path, bool create)
+{
+    close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                         create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_fileSize = static_cast<std::uint64_t>(size.QuadPart);
+#else
+    m_file = ::open(path.c_str(), create ? O_RDWR | O_CREAT : O_RDWR, 0644);
+    if (m_file < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    fstat(m_file, &info);
+    m_fileSize = static_cast<std::uint64_t>(info.st_size);
+#endif
+
+    if (m_fileSize == 0)
+    {
+        // A new file, write an empty table
+        std::vector<std::uint8_t> header(HEADER_SECTORS * SECTOR_SIZE, 0);
+        writeWord(&header[0], MAGIC);
+        writeWord(&header[4], VERSION);
+        if (!writeAt(0, header.data(), header.size()))
+        {
+            close();
+            return false;
+        }
+    }
+
+    if (m_fileSize < HEADER_SECTORS * SECTOR_SIZE || !mapFile() ||
+        readWord(m_view) != MAGIC || readWord(m_view + 4) != VERSION)
+    {
+        close();
+        return false;
+    }
+
+    const std::uint32_t sectorCount = static_cast<std::uint32_t>(m_fileSize / SECTOR_SIZE);
+    m_usedSectors.assign(sectorCount, false);
+    setSectorsUsed(0, HEADER_SECTORS, true);
+
+    for (int i = 0; i < REGION_CHUNKS; i++)
+    {
+        const std::uint32_t entry = readWord(m_view + TABLE_OFFSET + i * 4);
+        const std::uint32_t first = entry >> 8;
+        const std::uint32_t count = entry & 0xff;
+
+        // Entries pointing outside of the file are treated as missing chunks
+        if (entry != 0 && first >= HEADER_SECTORS && count > 0 && first + count <= sectorCount)
+        {
+            m_entries[i] = entry;
+            setSectorsUsed(first, count, true);
+        }
+        else
+        {
+            m_entries[i] = 0;
+        }
+    }
+    return true;
+}
+
+void RegionFile::close()
+{
+    unmapFile();
+
+#ifdef _WIN32
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_file >= 0)
+    {
+        ::close(m_file);
+        m_file = -1;
+    }
+#endif
+
+    m_fileSize = 0;
+    std::fill_n(m_entries, REGION_CHUNKS, 0u);
+    m_usedSectors.clear();
+}
+
+bool RegionFile::isOpen() const
+{
+#ifdef _WIN32
+    return m_file != INVALID_HANDLE_VALUE;
+#else
+    return m_file >= 0;
+#endif
+}
+
+bool RegionFile::hasChunk(int x, int z) const
+{
+    return m_entries[getEntryIndex(x, z)] != 0;
+}
+
+bool RegionFile::readChunk(int x, int z, Chunk& chunk)
+{
+    std::uint32_t length = 0;
+    const std::uint8_t* data = findRecord(x, z, length);
+    return data != nullptr && ChunkCodec::decode(data, length, chunk);
+}
+
+bool RegionFile::readRecord(int x, int z, std::vector<std::uint8_t>& data)
+{
+    std::uint32_t length = 0;
+    const std::uint8_t* record = findRecord(x, z, length);
+    if (record == nullptr)
+    {
+        return false;
+    }
+    data.assign(record, record + length);
+    return true;
+}
+
+const std::uint8_t* RegionFile::findRecord(int x, int z, std::uint32_t& length)
+{
+    const std::uint32_t entry = m_entries[getEntryIndex(x, z)];
+    if (entry == 0)
+    {
+        return nullptr;
+    }
+
+    // The mapping is dropped whenever the file grows
+    if (m_view == nullptr && !mapFile())
+    {
+        return nullptr;
+    }
+
+    const std::uint64_t offset = std::uint64_t(entry >> 8) * SECTOR_SIZE;
+    const std::uint64_t available = std::uint64_t(entry & 0xff) * SECTOR_SIZE;
+    if (offset + available > m_viewSize)
+    {
+        return nullptr;
+    }
+
+    const std::uint8_t* record = m_view + offset;
+    length = readWord(record);
+    if (length > available - RECORD_HEADER_SIZE || record[8] != RUN_LENGTH)
+    {
+        return nullptr;
+    }
+
+    const std::uint8_t* data = record + RECORD_HEADER_SIZE;
+    if (util::crc32(data, length) != readWord(record + 4))
+    {
+        return nullptr;
+    }
+    return data;
+}
+
+bool RegionFile::writeChunk(int x, int z, const std::uint8_t* data, std::size_t size)
+{
+    const std::uint32_t sectors = static_cast<std::uint32_t>((RECORD_HEADER_SIZE + size + SECTOR_SIZE - 1) / SECTOR_SIZE);
+    if (!isOpen() || sectors > MAX_CHUNK_SECTORS)
+    {
+        return false;
+    }
+
+    const int index = getEntryIndex(x, z);
+    const std::uint32_t oldFirst = m_entries[index] >> 8;
+    const std::uint32_t oldCount = m_entries[index] & 0xff;
+
+    // The old sectors stay marked used until the table stops pointing at them, so the new record
+    // never lands on top of the old one
+    const std::uint32_t first = allocateSectors(sectors);
+
+    std::vector<std::uint8_t> record(std::size_t(sectors) * SECTOR_SIZE, 0);
+    writeWord(&record[0], static_cast<std::uint32_t>(size));
+    writeWord(&record[4], util::crc32(data, size));
+    record[8] = RUN_LENGTH;
+    std::memcpy(&record[RECORD_HEADER_SIZE], data, size);
+
+    // Nothing is marked used until the record is down, a failed write leaves the sectors free
+    if (!writeAt(std::uint64_t(first) * SECTOR_SIZE, record.data(), record.size()))
+    {
+        return false;
+    }
+    setSectorsUsed(first, sectors, true);
+
+    const std::uint32_t newEntry = first << 8 | sectors;
+    std::uint8_t entry[4];
+    writeWord(entry, newEntry);
+    if (!writeAt(TABLE_OFFSET + index * 4, entry, sizeof(entry)))
+    {
+        // The table still points at the old record
+        setSectorsUsed(first, sectors, false);
+        return false;
+    }
+
+    m_entries[index] = newEntry;
+    setSectorsUsed(oldFirst, oldCount, false);
+    return true;
+}
+
+bool RegionFile::mapFile()
+{
+    unmapFile();
+    if (m_fileSize == 0)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        return false;
+    }
+    m_view = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_view == nullptr)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return false;
+    }
+#else
+    void* view = mmap(nullptr, m_fileSize, PROT_READ, MAP_SHARED, m_file, 0);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+    m_view = static_cast<const std::uint8_t*>(view);
+#endif
+
+    m_viewSize = m_fileSize;
+    return true;
+}
+
+void RegionFile::unmapFile()
+{
+    if (m_view == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_view);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(const_cast<std::uint8_t*>(m_view), m_viewSize);
+#endif
+
+    m_view = nullptr;
+    m_viewSize = 0;
+}
+
+bool RegionFile::writeAt(std::uint64_t offset, const void* data, std::size_t size)
+{
+    const std::uint64_t end = offset + size;
+
+    // Writes inside the mapped range show up in the mapping, but it can not be grown in place
+    if (end > m_fileSize)
+    {
+        unmapFile();
+    }
+
+#ifdef _WIN32
+    OVERLAPPED position = {};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD written = 0;
+    if (!WriteFile(m_file, data, static_cast<DWORD>(size), &written, &position) || written != size)
+    {
+        return false;
+    }
+#else
+    const char* bytes = static_cast<const char*>(data);
+    std::size_t remaining = size;
+    while (remaining > 0)
+    {
+        const ssize_t written = pwrite(m_file, bytes, remaining, static_cast<off_t>(offset));
+        if (written <= 0)
+        {
+            return false;
+        }
+        bytes += written;
+        offset += static_cast<std::uint64_t>(written);
+        remaining -= static_cast<std::size_t>(written);
+    }
+#endif
+
+    m_fileSize = std::max(m_fileSize, end);
+    return true;
+}
+
+std::uint32_t RegionFile::allocateSectors(std::uint32_t count)
+{
+    // First fit
+    std::uint32_t run = 0;
+    for (std::uint32_t i = HEADER_SECTORS; i < m_usedSectors.size(); i++)
+    {
+        run = m_usedSectors[i] ? 0 : run + 1;
+        if (run == count)
+        {
+            return i + 1 - count;
+        }
+    }
+
+    // A free run at the end of the file only needs growing by the rest
+    return static_cast<std::uint32_t>(m_usedSectors.size()) - run;
+}
+
+void RegionFile::setSectorsUsed(std::uint32_t first, std::uint32_t count, bool used)
+{
+    if (first + count > m_usedSectors.size())
+    {
+        m_usedSectors.resize(first + count, false);
+    }
+    std::fill_n(m_usedSectors.begin() + first, count, used);
+}
+
+static bool createDirectories(const string_t& path)
+{
+    for (std::size_t slash = path.find_first_of("/\\", 1); ; slash = path.find_first_of("/\\", slash + 1))
+    {
+        const string_t part = path.substr(0, slash);
+#ifdef _WIN32
+        _mkdir(part.c_str());
+#else
+        mkdir(part.c_str(), 0755);
+#endif
+        if (slash == string_t::npos)
+        {
+            break;
+        }
+    }
+
+#ifdef _WIN32
+    const DWORD attributes = GetFileAttributesA(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+RegionStorage::RegionStorage(const string_t& directory, std::size_t maxOpenFiles)
+    : m_directory(directory), m_maxOpenFiles(std::max<std::size_t>(maxOpenFiles, 1))
+{
+    createDirectories(m_directory);
+}
+
+bool RegionStorage::loadChunk(ChunkPos position, Chunk& chunk)
+{
+    std::vector<std::uint8_t> data;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        RegionFile* region = getRegion({position.x >> 5, position.z >> 5}, false);
+        if (region == nullptr || !region->readRecord(position.x & 31, position.z & 31, data))
+        {
+            return false;
+        }
+    }
+
+    // Decoding is most of the work of a load, other workers can use the files meanwhile
+    return ChunkCodec::decode(data.data(), data.size(), chunk);
+}
+
+bool RegionStorage::saveChunk(ChunkPos position, const std::vector<std::uint8_t>& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    RegionFile* region = getRegion({position.x >> 5, position.z >> 5}, true);
+    return region != nullptr && region->writeChunk(position.x & 31, position.z & 31, data.data(), data.size());
+}
+
+bool RegionStorage::saveChunk(const Chunk& chunk)
+{
+    std::vector<std::uint8_t> data;
+    ChunkCodec::encode(chunk, data);
+    return saveChunk(chunk.getPosition(), data);
+}
+
+string_t RegionStorage::getRegionFileName(int regionX, int regionZ)
+{
+    return "r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".qrg";
+}
+
+RegionFile* RegionStorage::getRegion(ChunkPos region, bool create)
+{
+    for (auto it = m_open.begin(); it != m_open.end(); ++it)
+    {
+        if (it->first == region)
+        {
+            m_open.splice(m_open.begin(), m_open, it);
+            return m_open.front().second.get();
+        }
+    }
+
+    std::unique_ptr<RegionFile> file(new RegionFile());
+    if (!file->open(m_directory + "/" + getRegionFileName(region.x, region.z), create))
+    {
+        return nullptr;
+    }
+
+    if (m_open.size() >= m_maxOpenFiles)
+    {
+        m_open.pop_back();
+    }
+    m_open.emplace_front(region, std::move(file));
+    return m_open.front().second.get();
+}
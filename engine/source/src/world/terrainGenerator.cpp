@@ -0,0 +1,467 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/terrainGenerator.hpp"
+#include "util/random.hpp"
+#include "util/noise.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace qore::world;
+
+namespace
+{
+
+const int CHUNK_VOLUME = CHUNK_WIDTH * CHUNK_WIDTH * CHUNK_HEIGHT;
+
+// Random number streams of a chunk, one per stage that needs them.
+const std::uint32_t TREE_STREAM = 1;
+
+// Trees reach this far from their trunk.
+const int LEAF_RADIUS = 2;
+const int MAX_TREE_HEIGHT = 6;
+
+// Noise frequencies are powers of two, so a column's noise position comes out exactly the same
+// whether it is the first sample of a grid or the tenth.
+const float HILL_SCALE = 1.0f / 128.0f;
+const float MOUNTAIN_SCALE = 1.0f / 256.0f;
+const float MOUNTAIN_RANGE_SCALE = 1.0f / 512.0f;
+const float CLIMATE_SCALE = 1.0f / 512.0f;
+const float CAVE_SCALE = 1.0f / 64.0f;
+const float CAVE_VERTICAL_SCALE = 1.0f / 32.0f;
+
+float smoothstep(float edge0, float edge1, float x)
+{
+    const float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.0f), 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+float lerp(float a, float b, float t)
+{
+    return a + t * (b - a);
+}
+
+} // namespace
+
+TerrainGenerator::TerrainGenerator(const TerrainSettings& settings)
+    : m_settings(settings), m_heightNoise(settings.seed + 1), m_mountainNoise(settings.seed + 2),
+      m_climateNoise(settings.seed + 3), m_caveNoise(settings.seed + 4)
+{
+}
+
+void TerrainGenerator::generate(Chunk& chunk) const
+{
+    const ChunkPos position = chunk.getPosition();
+
+    ColumnData columns;
+    generateHeightmap(position, columns);
+    generateBiomes(position, columns);
+
+    std::vector<BlockId> blocks(CHUNK_VOLUME, AIR);
+    buildSurface(columns, blocks.data());
+    carveCaves(position, columns, blocks.data());
+    decorate(position, blocks.data());
+
+    // Nothing is placed above the highest column plus a tree
+    const int top = *std::max_element(columns.heights, columns.heights + SECTION_AREA) + MAX_TREE_HEIGHT + 2;
+    for (int s = 0; s < SECTION_COUNT; s++)
+    {
+        if (s * SECTION_SIZE > top)
+        {
+            chunk.getSection(s).fill(AIR);
+            continue;
+        }
+        chunk.getSection(s).setBlocks(&blocks[s * SECTION_VOLUME]);
+    }
+}
+
+int TerrainGenerator::getHeight(int x, int z) const
+{
+    float weight;
+    int height;
+    sampleMountainWeights(x, z, 1, 1, &weight);
+    sampleHeights(x, z, 1, 1, &weight, &height);
+    return height;
+}
+
+Biome TerrainGenerator::getBiome(int x, int z) const
+{
+    float weight;
+    Biome biome;
+    sampleMountainWeights(x, z, 1, 1, &weight);
+    sampleBiomes(x, z, 1, 1, &weight, &biome);
+    return biome;
+}
+
+const TerrainSettings& TerrainGenerator::getSettings() const
+{
+    return m_settings;
+}
+
+void TerrainGenerator::generateHeightmap(ChunkPos position, ColumnData& columns) const
+{
+    const int x = position.x * CHUNK_WIDTH;
+    const int z = position.z * CHUNK_WIDTH;
+    sampleMountainWeights(x, z, CHUNK_WIDTH, CHUNK_WIDTH, columns.mountainWeights);
+    sampleHeights(x, z, CHUNK_WIDTH, CHUNK_WIDTH, columns.mountainWeights, columns.heights);
+}
+
+void TerrainGenerator::generateBiomes(ChunkPos position, ColumnData& columns) const
+{
+    sampleBiomes(position.x * CHUNK_WIDTH, position.z * CHUNK_WIDTH, CHUNK_WIDTH, CHUNK_WIDTH, columns.mountainWeights,
+                 columns.biomes);
+}
+
+void TerrainGenerator::buildSurface(const ColumnData& columns, BlockId* blocks) const
+{
+    for (int z = 0; z < CHUNK_WIDTH; z++)
+    {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            const int height = columns.heights[z * CHUNK_WIDTH + x];
+
+            // The top few blocks of a column depend on its biome, everything below is stone
+            BlockId top = GRASS;
+            BlockId filler = DIRT;
+            switch (columns.biomes[z * CHUNK_WIDTH + x])
+            {
+            case Biome::DESERT:
+                top = SAND;
+                filler = SAND;
+                break;
+            case Biome::MOUNTAINS:
+                top = height >= m_settings.snowHeight ? SNOW : STONE;
+                filler = STONE;
+                break;
+            default:
+                break;
+            }
+
+            blocks[getIndex(x, 0, z)] = BEDROCK;
+            for (int y = 1; y <= height; y++)
+            {
+                BlockId id = STONE;
+                if (y == height)
+                {
+                    id = top;
+                }
+                else if (y >= height - 3)
+                {
+                    id = filler;
+                }
+                blocks[getIndex(x, y, z)] = id;
+            }
+        }
+    }
+}
+
+void TerrainGenerator::carveCaves(ChunkPos position, const ColumnData& columns, BlockId* blocks) const
+{
+    if (m_settings.caveSize <= 0.0f)
+    {
+        return;
+    }
+
+    const int top = *std::max_element(columns.heights, columns.heights + SECTION_AREA);
+    CaveLattice lattice;
+    for (int s = 0; s * SECTION_SIZE <= top; s++)
+    {
+        sampleCaves(position.x, s, position.z, lattice);
+
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; x++)
+            {
+                // Bedrock is never carved
+                const int height = columns.heights[z * CHUNK_WIDTH + x];
+                const int minY = std::max(s * SECTION_SIZE, 1);
+                const int maxY = std::min(s * SECTION_SIZE + SECTION_SIZE - 1, height);
+                for (int y = minY; y <= maxY; y++)
+                {
+                    if (isCave(lattice, x, y - s * SECTION_SIZE, z))
+                    {
+                        blocks[getIndex(x, y, z)] = AIR;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TerrainGenerator::decorate(ChunkPos position, BlockId* blocks) const
+{
+    // Trees of the neighbouring chunks can reach into this one
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            placeTrees(position, {position.x + dx, position.z + dz}, blocks);
+        }
+    }
+}
+
+void TerrainGenerator::placeTrees(ChunkPos position, ChunkPos origin, BlockId* blocks) const
+{
+    util::CounterRandom random(m_settings.seed, origin.x, origin.z, TREE_STREAM);
+
+    for (int i = 0; i < m_settings.treeAttempts; i++)
+    {
+        // Every attempt draws the same numbers so the trees do not depend on which attempts succeed
+        const int localX = random.nextInt(CHUNK_WIDTH);
+        const int localZ = random.nextInt(CHUNK_WIDTH);
+        const float roll = random.nextFloat();
+        const int trunk = MAX_TREE_HEIGHT - 2 + random.nextInt(3);
+
+        // Position of the trunk relative to the chunk being generated
+        const int x = (origin.x - position.x) * CHUNK_WIDTH + localX;
+        const int z = (origin.z - position.z) * CHUNK_WIDTH + localZ;
+        if (x < -LEAF_RADIUS || x >= CHUNK_WIDTH + LEAF_RADIUS || z < -LEAF_RADIUS || z >= CHUNK_WIDTH + LEAF_RADIUS)
+        {
+            continue;
+        }
+
+        const int worldX = origin.x * CHUNK_WIDTH + localX;
+        const int worldZ = origin.z * CHUNK_WIDTH + localZ;
+
+        float chance = 0.0f;
+        switch (getBiome(worldX, worldZ))
+        {
+        case Biome::FOREST:
+            chance = 0.6f;
+            break;
+        case Biome::PLAINS:
+            chance = 0.05f;
+            break;
+        default:
+            break;
+        }
+        if (roll >= chance)
+        {
+            continue;
+        }
+
+        // Trees need solid ground to stand on
+        const int ground = getHeight(worldX, worldZ);
+        if (isCave(worldX, ground, worldZ))
+        {
+            continue;
+        }
+
+        for (int y = ground + trunk - 2; y <= ground + trunk + 1; y++)
+        {
+            const int radius = y > ground + trunk - 1 ? 1 : LEAF_RADIUS;
+            for (int lz = z - radius; lz <= z + radius; lz++)
+            {
+                for (int lx = x - radius; lx <= x + radius; lx++)
+                {
+                    if (lx < 0 || lx >= CHUNK_WIDTH || lz < 0 || lz >= CHUNK_WIDTH)
+                    {
+                        continue;
+                    }
+                    // Round off the corners of the top layer
+                    if (y == ground + trunk + 1 && lx != x && lz != z)
+                    {
+                        continue;
+                    }
+                    BlockId& block = blocks[getIndex(lx, y, lz)];
+                    if (block == AIR)
+                    {
+                        block = LEAVES;
+                    }
+                }
+            }
+        }
+
+        if (x >= 0 && x < CHUNK_WIDTH && z >= 0 && z < CHUNK_WIDTH)
+        {
+            for (int y = ground + 1; y <= ground + trunk; y++)
+            {
+                blocks[getIndex(x, y, z)] = LOG;
+            }
+        }
+    }
+}
+
+void TerrainGenerator::sampleMountainWeights(int x, int z, int width, int depth, float* weights) const
+{
+    util::NoiseGrid grid;
+    grid.x = x * MOUNTAIN_RANGE_SCALE;
+    grid.z = z * MOUNTAIN_RANGE_SCALE;
+    grid.stepX = grid.stepZ = MOUNTAIN_RANGE_SCALE;
+    grid.width = width;
+    grid.depth = depth;
+
+    util::FractalSettings ranges;
+    ranges.octaves = 2;
+    m_mountainNoise.fill2D(grid, ranges, weights);
+
+    for (int i = 0; i < width * depth; i++)
+    {
+        weights[i] = smoothstep(0.1f, 0.4f, weights[i]);
+    }
+}
+
+void TerrainGenerator::sampleHeights(int x, int z, int width, int depth, const float* weights, int* heights) const
+{
+    const int count = width * depth;
+
+    util::NoiseGrid grid;
+    grid.x = x * HILL_SCALE;
+    grid.z = z * HILL_SCALE;
+    grid.stepX = grid.stepZ = HILL_SCALE;
+    grid.width = width;
+    grid.depth = depth;
+
+    // Warping bends the hills away from the grid the noise is built on
+    util::FractalSettings hillSettings;
+    hillSettings.octaves = 4;
+    hillSettings.warpStrength = 0.5f;
+    std::vector<float> hills(count);
+    m_heightNoise.fill2D(grid, hillSettings, hills.data());
+
+    // Lowland columns have no use for the mountain noise
+    std::vector<float> mountains(count, 0.0f);
+    if (std::any_of(weights, weights + count, [](float weight) { return weight > 0.0f; }))
+    {
+        grid.x = x * MOUNTAIN_SCALE + 1000.5f;
+        grid.z = z * MOUNTAIN_SCALE + 1000.5f;
+        grid.stepX = grid.stepZ = MOUNTAIN_SCALE;
+
+        util::FractalSettings mountainSettings;
+        mountainSettings.type = util::FractalType::RIDGED;
+        mountainSettings.octaves = 4;
+        m_mountainNoise.fill2D(grid, mountainSettings, mountains.data());
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const float offset = hills[i] * m_settings.hillHeight + mountains[i] * m_settings.mountainHeight * weights[i];
+        const int height = m_settings.baseHeight + static_cast<int>(offset);
+        // Leave room for bedrock below and a tree above
+        heights[i] = std::min(std::max(height, 1), CHUNK_HEIGHT - MAX_TREE_HEIGHT - 3);
+    }
+}
+
+void TerrainGenerator::sampleBiomes(int x, int z, int width, int depth, const float* weights, Biome* biomes) const
+{
+    const int count = width * depth;
+
+    util::NoiseGrid grid;
+    grid.x = x * CLIMATE_SCALE;
+    grid.z = z * CLIMATE_SCALE;
+    grid.stepX = grid.stepZ = CLIMATE_SCALE;
+    grid.width = width;
+    grid.depth = depth;
+
+    util::FractalSettings climate;
+    climate.octaves = 2;
+    std::vector<float> temperature(count);
+    std::vector<float> humidity(count);
+    m_climateNoise.fill2D(grid, climate, temperature.data());
+    grid.x += 500.5f;
+    grid.z += 500.5f;
+    m_climateNoise.fill2D(grid, climate, humidity.data());
+
+    for (int i = 0; i < count; i++)
+    {
+        if (weights[i] > 0.5f)
+        {
+            biomes[i] = Biome::MOUNTAINS;
+        }
+        else if (temperature[i] > 0.2f && humidity[i] < 0.0f)
+        {
+            biomes[i] = Biome::DESERT;
+        }
+        else if (humidity[i] > 0.1f)
+        {
+            biomes[i] = Biome::FOREST;
+        }
+        else
+        {
+            biomes[i] = Biome::PLAINS;
+        }
+    }
+}
+
+void TerrainGenerator::sampleCaves(int sectionX, int sectionY, int sectionZ, CaveLattice& lattice) const
+{
+    util::NoiseGrid grid;
+    grid.x = sectionX * SECTION_SIZE * CAVE_SCALE;
+    grid.y = sectionY * SECTION_SIZE * CAVE_VERTICAL_SCALE;
+    grid.z = sectionZ * SECTION_SIZE * CAVE_SCALE;
+    grid.stepX = grid.stepZ = CAVE_CELL * CAVE_SCALE;
+    grid.stepY = CAVE_CELL * CAVE_VERTICAL_SCALE;
+    grid.width = grid.height = grid.depth = CAVE_LATTICE_SIZE;
+
+    util::FractalSettings tunnels;
+    tunnels.octaves = 2;
+    m_caveNoise.fill3D(grid, tunnels, lattice.first);
+    grid.x += 300.5f;
+    grid.z += 300.5f;
+    m_caveNoise.fill3D(grid, tunnels, lattice.second);
+}
+
+bool TerrainGenerator::isCave(const CaveLattice& lattice, int x, int y, int z) const
+{
+    const int cellX = std::min(x / CAVE_CELL, CAVE_LATTICE_SIZE - 2);
+    const int cellY = std::min(y / CAVE_CELL, CAVE_LATTICE_SIZE - 2);
+    const int cellZ = std::min(z / CAVE_CELL, CAVE_LATTICE_SIZE - 2);
+    const float tx = (x - cellX * CAVE_CELL) / float(CAVE_CELL);
+    const float ty = (y - cellY * CAVE_CELL) / float(CAVE_CELL);
+    const float tz = (z - cellZ * CAVE_CELL) / float(CAVE_CELL);
+
+    float values[2];
+    const float* fields[2] = {lattice.first, lattice.second};
+    for (int f = 0; f < 2; f++)
+    {
+        const float* v = fields[f] + (cellY * CAVE_LATTICE_SIZE + cellZ) * CAVE_LATTICE_SIZE + cellX;
+        const int dy = CAVE_LATTICE_SIZE * CAVE_LATTICE_SIZE;
+        const int dz = CAVE_LATTICE_SIZE;
+        const float near = lerp(lerp(v[0], v[1], tx), lerp(v[dz], v[dz + 1], tx), tz);
+        const float far = lerp(lerp(v[dy], v[dy + 1], tx), lerp(v[dy + dz], v[dy + dz + 1], tx), tz);
+        values[f] = lerp(near, far, ty);
+    }
+
+    const float size = m_settings.caveSize;
+    return values[0] * values[0] + values[1] * values[1] < size * size;
+}
+
+bool TerrainGenerator::isCave(int x, int y, int z) const
+{
+    // Floor division, so negative coordinates land in the right section
+    const int sectionX = x >> 4;
+    const int sectionY = y >> 4;
+    const int sectionZ = z >> 4;
+
+    CaveLattice lattice;
+    sampleCaves(sectionX, sectionY, sectionZ, lattice);
+    return isCave(lattice, x - sectionX * SECTION_SIZE, y - sectionY * SECTION_SIZE, z - sectionZ * SECTION_SIZE);
+}
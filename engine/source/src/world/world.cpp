@@ -0,0 +1,263 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "world/world.hpp"
+#include <algorithm>
+
+using namespace qore::world;
+
+World::World() : m_hasLastDirty(false), m_light(*this)
+{
+}
+
+Chunk* World::getChunk(ChunkPos position)
+{
+    auto it = m_chunks.find(position);
+    return it == m_chunks.end() ? nullptr : it->second.get();
+}
+
+const Chunk* World::getChunk(ChunkPos position) const
+{
+    auto it = m_chunks.find(position);
+    return it == m_chunks.end() ? nullptr : it->second.get();
+}
+
+Chunk* World::addChunk(std::unique_ptr<Chunk> chunk, bool remesh)
+{
+    const ChunkPos position = chunk->getPosition();
+    Chunk* added = chunk.get();
+    m_chunks[position] = std::move(chunk);
+
+    m_light.addChunk(position);
+
+    if (remesh)
+    {
+        markChunkDirty(position);
+    }
+    else
+    {
+        markNeighboursDirty(position);
+    }
+    return added;
+}
+
+void World::removeChunk(ChunkPos position)
+{
+    if (m_chunks.erase(position) != 0)
+    {
+        // The neighbours were meshed against this chunk, without it their border faces show
+        markNeighboursDirty(position);
+    }
+}
+
+std::unique_ptr<Chunk> World::takeChunk(ChunkPos position)
+{
+    auto it = m_chunks.find(position);
+    if (it == m_chunks.end())
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<Chunk> chunk = std::move(it->second);
+    m_chunks.erase(it);
+    markNeighboursDirty(position);
+    return chunk;
+}
+
+std::size_t World::getChunkCount() const
+{
+    return m_chunks.size();
+}
+
+BlockId World::getBlock(int x, int y, int z) const
+{
+    if (y < 0 || y >= CHUNK_HEIGHT)
+    {
+        return AIR;
+    }
+
+    const Chunk* chunk = getChunk(toChunkPos(x, z));
+    if (chunk == nullptr)
+    {
+        return AIR;
+    }
+    return chunk->getBlock(x & 15, y, z & 15);
+}
+
+bool World::setBlock(int x, int y, int z, BlockId id)
+{
+    if (y < 0 || y >= CHUNK_HEIGHT)
+    {
+        return false;
+    }
+
+    const ChunkPos chunkPos = toChunkPos(x, z);
+    Chunk* chunk = getChunk(chunkPos);
+    if (chunk == nullptr)
+    {
+        return false;
+    }
+
+    const BlockId previous = chunk->getBlock(x & 15, y, z & 15);
+    if (previous == id)
+    {
+        return true;
+    }
+    chunk->setBlock(x & 15, y, z & 15, id);
+    chunk->setModified(true);
+
+    // Blocks on the edge of a section also change the faces and corners of the sections they touch
+    markBlockDirty(x, y, z);
+    m_light.updateBlock(x, y, z, previous);
+    return true;
+}
+
+ChunkNeighbourhood World::getNeighbourhood(ChunkPos position) const
+{
+    ChunkNeighbourhood neighbourhood;
+    neighbourhood.centre = getChunk(position);
+    neighbourhood.negX = getChunk({position.x - 1, position.z});
+    neighbourhood.posX = getChunk({position.x + 1, position.z});
+    neighbourhood.negZ = getChunk({position.x, position.z - 1});
+    neighbourhood.posZ = getChunk({position.x, position.z + 1});
+    neighbourhood.negXNegZ = getChunk({position.x - 1, position.z - 1});
+    neighbourhood.posXNegZ = getChunk({position.x + 1, position.z - 1});
+    neighbourhood.negXPosZ = getChunk({position.x - 1, position.z + 1});
+    neighbourhood.posXPosZ = getChunk({position.x + 1, position.z + 1});
+    return neighbourhood;
+}
+
+void World::markSectionDirty(SectionPos position)
+{
+    m_dirty.insert(position);
+}
+
+void World::markBlockDirty(int x, int y, int z)
+{
+    const int minX = (x - 1) >> 4;
+    const int maxX = (x + 1) >> 4;
+    const int minY = std::max(y - 1, 0) >> 4;
+    const int maxY = std::min(y + 1, CHUNK_HEIGHT - 1) >> 4;
+    const int minZ = (z - 1) >> 4;
+    const int maxZ = (z + 1) >> 4;
+
+    // Most blocks are well inside their section
+    if (minX == maxX && minY == maxY && minZ == maxZ)
+    {
+        const SectionPos section = {minX, minY, minZ};
+        if (!m_hasLastDirty || section != m_lastDirty)
+        {
+            m_dirty.insert(section);
+            m_lastDirty = section;
+            m_hasLastDirty = true;
+        }
+        return;
+    }
+
+    for (int sy = minY; sy <= maxY; sy++)
+    {
+        for (int sz = minZ; sz <= maxZ; sz++)
+        {
+            for (int sx = minX; sx <= maxX; sx++)
+            {
+                m_dirty.insert({sx, sy, sz});
+            }
+        }
+    }
+}
+
+void World::markChunkDirty(ChunkPos position)
+{
+    const Chunk* chunk = getChunk(position);
+    if (chunk == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        if (!chunk->getSection(i).isEmpty())
+        {
+            markSectionDirty({position.x, i, position.z});
+        }
+    }
+    markNeighboursDirty(position);
+}
+
+void World::markNeighboursDirty(ChunkPos position)
+{
+    const ChunkPos neighbours[8] = {
+        {position.x - 1, position.z}, {position.x + 1, position.z},
+        {position.x, position.z - 1}, {position.x, position.z + 1},
+        {position.x - 1, position.z - 1}, {position.x + 1, position.z - 1},
+        {position.x - 1, position.z + 1}, {position.x + 1, position.z + 1}
+    };
+
+    // The chunk may hide faces along the border of the chunks next to it, and the light and ambient
+    // occlusion at the corners of their border blocks are read from it, the diagonal chunks included
+    for (const ChunkPos& neighbour : neighbours)
+    {
+        const Chunk* other = getChunk(neighbour);
+        if (other == nullptr)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < SECTION_COUNT; i++)
+        {
+            if (!other->getSection(i).isEmpty())
+            {
+                markSectionDirty({neighbour.x, i, neighbour.z});
+            }
+        }
+    }
+}
+
+std::vector<SectionPos> World::takeDirtySections()
+{
+    std::vector<SectionPos> sections;
+    sections.reserve(m_dirty.size());
+
+    for (const SectionPos& section : m_dirty)
+    {
+        if (getChunk({section.x, section.z}) != nullptr)
+        {
+            sections.push_back(section);
+        }
+    }
+    m_dirty.clear();
+    m_hasLastDirty = false;
+    return sections;
+}
+
+LightEngine& World::getLightEngine()
+{
+    return m_light;
+}
@@ -0,0 +1,74 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#include <cstdio>
+
+namespace qore
+{
+namespace test
+{
+
+/*
+ * Shared by the tests, which are plain executables run by ctest.
+ * CHECK reports every failed condition and carries on, main returns test::result().
+ */
+
+inline int& failureCount()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline bool check(bool passed, const char* condition, const char* file, int line)
+{
+    if (!passed)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+        failureCount()++;
+    }
+    return passed;
+}
+
+inline int result()
+{
+    if (failureCount() != 0)
+    {
+        std::fprintf(stderr, "%d checks failed\n", failureCount());
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace test
+
+} // namespace qore
+
+#define CHECK(condition) qore::test::check((condition), #condition, __FILE__, __LINE__)
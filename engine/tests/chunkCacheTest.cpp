@@ -0,0 +1,229 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "check.hpp"
+#include "world/chunkCache.hpp"
+#include "world/chunkCodec.hpp"
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * The two tiers of ChunkCache: least recently used chunks move from hot to cold and are then
+ * dropped, the byte budgets hold after every insert, and take() hands chunks back from the
+ * tier they are in and counts hits and misses. The chunks all use the same amount of memory,
+ * so the budgets are given in chunks.
+ */
+
+namespace
+{
+
+// A layer of stone and one dirt block whose x is the chunk's x, to tell the chunks apart.
+std::unique_ptr<Chunk> makeChunk(int x)
+{
+    std::unique_ptr<Chunk> chunk(new Chunk({x, 0}));
+    chunk->fill(0, 0, 0, CHUNK_WIDTH - 1, 10, CHUNK_WIDTH - 1, STONE);
+    chunk->setBlock(x % CHUNK_WIDTH, 20, 0, DIRT);
+    return chunk;
+}
+
+bool isChunk(const Chunk& chunk, int x)
+{
+    return chunk.getPosition().x == x && chunk.getBlock(x % CHUNK_WIDTH, 20, 0) == DIRT &&
+           chunk.getBlock((x + 1) % CHUNK_WIDTH, 20, 0) == AIR && chunk.getBlock(3, 10, 3) == STONE;
+}
+
+std::size_t hotSize;
+std::size_t coldSize;
+
+void measureSizes()
+{
+    ChunkCache cache(std::size_t(1) << 30);
+    cache.insert(makeChunk(0));
+    hotSize = cache.getStats().hotBytes;
+    cache.setBudget(std::size_t(1) << 30, 0.0f);
+    coldSize = cache.getStats().coldBytes;
+    CHECK(coldSize > 0 && coldSize < hotSize);
+}
+
+// Room for two hot chunks, the rest of the budget goes to the cold tier.
+std::size_t getBudget()
+{
+    return hotSize * 5;
+}
+
+// Hands a chunk back and checks which tier it came from, a missing chunk counts as neither.
+enum class Tier
+{
+    HOT,
+    COLD,
+    MISSING
+};
+
+Tier takeChunk(ChunkCache& cache, int x)
+{
+    CachedChunk cached;
+    if (!cache.take({x, 0}, cached))
+    {
+        return Tier::MISSING;
+    }
+    if (cached.chunk != nullptr)
+    {
+        CHECK(isChunk(*cached.chunk, x));
+        return Tier::HOT;
+    }
+
+    Chunk chunk({x, 0});
+    CHECK(ChunkCodec::decode(cached.compressed.data(), cached.compressed.size(), chunk));
+    CHECK(isChunk(chunk, x));
+    return Tier::COLD;
+}
+
+void testLeastRecentlyUsed()
+{
+    ChunkCache cache(getBudget());
+    cache.insert(makeChunk(0));
+    cache.insert(makeChunk(1));
+    cache.insert(makeChunk(2));
+
+    // The oldest chunk made room for the newest.
+    CHECK(cache.getStats().hotCount == 2);
+    CHECK(cache.getStats().coldCount == 1);
+    CHECK(cache.getStats().demotions == 1);
+
+    // Taking a cold chunk and inserting it again makes it the newest hot chunk.
+    CHECK(takeChunk(cache, 0) == Tier::COLD);
+    cache.insert(makeChunk(0));
+    CHECK(cache.getStats().hotCount == 2);
+    CHECK(cache.getStats().coldCount == 1);
+
+    CHECK(takeChunk(cache, 1) == Tier::COLD);
+    CHECK(takeChunk(cache, 2) == Tier::HOT);
+    CHECK(takeChunk(cache, 0) == Tier::HOT);
+    CHECK(takeChunk(cache, 0) == Tier::MISSING);
+    CHECK(!cache.contains({1, 0}));
+
+    const ChunkCacheStats& stats = cache.getStats();
+    CHECK(stats.hotHits == 2);
+    CHECK(stats.coldHits == 2);
+    CHECK(stats.misses == 1);
+    CHECK(stats.hotCount == 0 && stats.hotBytes == 0);
+    CHECK(stats.coldCount == 0 && stats.coldBytes == 0);
+}
+
+void testBudgets()
+{
+    const std::size_t budget = getBudget();
+    ChunkCache cache(budget);
+
+    // Enough chunks that the oldest ones have to be dropped.
+    const int count = static_cast<int>(2 + (budget - 2 * hotSize) / coldSize + 4);
+    for (int x = 0; x < count; x++)
+    {
+        cache.insert(makeChunk(x));
+        const ChunkCacheStats& stats = cache.getStats();
+        CHECK(stats.hotBytes <= budget / 2);
+        CHECK(stats.hotBytes + stats.coldBytes <= budget);
+    }
+
+    const ChunkCacheStats& stats = cache.getStats();
+    CHECK(stats.hotCount == 2);
+    CHECK(stats.evictions > 0);
+    CHECK(stats.hotCount + stats.coldCount + stats.evictions == static_cast<std::size_t>(count));
+
+    // Newest first, hot then cold, and the oldest are gone.
+    CHECK(takeChunk(cache, count - 1) == Tier::HOT);
+    CHECK(takeChunk(cache, count - 2) == Tier::HOT);
+    CHECK(takeChunk(cache, count - 3) == Tier::COLD);
+    CHECK(takeChunk(cache, static_cast<int>(stats.evictions)) == Tier::COLD);
+    CHECK(takeChunk(cache, static_cast<int>(stats.evictions) - 1) == Tier::MISSING);
+    CHECK(takeChunk(cache, 0) == Tier::MISSING);
+
+    // A smaller budget applies straight away.
+    cache.setBudget(hotSize, 0.0f);
+    CHECK(cache.getStats().hotCount == 0);
+    CHECK(cache.getStats().coldBytes <= hotSize);
+}
+
+void testDeferredCompression()
+{
+    ChunkCache cache(getBudget());
+    cache.setDeferredCompression(true);
+    cache.insert(makeChunk(0));
+    cache.insert(makeChunk(1));
+    cache.insert(makeChunk(2));
+    cache.insert(makeChunk(3));
+
+    // Demoted but not compressed, nothing counts against the cold tier yet.
+    CHECK(cache.getStats().demotions == 2);
+    CHECK(cache.getStats().pendingCount == 2);
+    CHECK(cache.getStats().coldCount == 0);
+    CHECK(cache.getStats().coldBytes == 0);
+
+    std::vector<std::shared_ptr<const Chunk>> pending = cache.takePendingCompression();
+    CHECK(pending.size() == 2);
+    CHECK(cache.takePendingCompression().empty());
+    if (pending.size() != 2)
+    {
+        return;
+    }
+
+    // A chunk taken before it is compressed comes back whole, its compressed blocks are dropped.
+    CachedChunk cached;
+    CHECK(cache.take({1, 0}, cached));
+    CHECK(cached.chunk != nullptr && isChunk(*cached.chunk, 1));
+    CHECK(!cached.hasMeshes);
+    CHECK(cache.getStats().coldHits == 1);
+    CHECK(cache.getStats().pendingCount == 1);
+    for (const std::shared_ptr<const Chunk>& chunk : pending)
+    {
+        std::vector<std::uint8_t> compressed;
+        ChunkCodec::encode(*chunk, compressed);
+        cache.finishCompression(chunk, std::move(compressed));
+    }
+    CHECK(cache.getStats().pendingCount == 0);
+    CHECK(cache.getStats().pendingBytes == 0);
+    CHECK(cache.getStats().coldCount == 1);
+    CHECK(cache.getStats().coldBytes == coldSize);
+
+    CHECK(takeChunk(cache, 0) == Tier::COLD);
+    CHECK(cache.getStats().coldHits == 2);
+}
+
+} // namespace
+
+int main()
+{
+    measureSizes();
+    testLeastRecentlyUsed();
+    testBudgets();
+    testDeferredCompression();
+    return test::result();
+}
@@ -0,0 +1,226 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "check.hpp"
+#include "world/chunkManager.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Streaming chunks in and out of a RegionStorage: only chunks with edited blocks are written
+ * when they unload, and the edits are there again when the chunks are loaded back. A chunk
+ * saved again while its first save is still queued ends up on disk as it was saved last.
+ */
+
+namespace
+{
+
+const char* DIRECTORY = "chunkManagerTestRegions";
+
+// A flat layer of stone, the same for every chunk.
+void generateFlat(Chunk& chunk)
+{
+    chunk.fill(0, 0, 0, CHUNK_WIDTH - 1, 10, CHUNK_WIDTH - 1, STONE);
+}
+
+// While the gate is closed generating chunks blocks the workers, so jobs queued behind them wait.
+std::atomic<bool> gateOpen(true);
+
+void generateGated(Chunk& chunk)
+{
+    // Spinning rather than sleeping lets both workers go at the same moment
+    while (!gateOpen)
+    {
+        std::this_thread::yield();
+    }
+    generateFlat(chunk);
+}
+
+// Updates until the chunks around the position are loaded, they are generated on the workers.
+bool loadAround(ChunkManager& manager, const glm::vec3& position, std::size_t expected)
+{
+    for (int i = 0; i < 2000; i++)
+    {
+        manager.update(position, glm::vec3(0.0f, 0.0f, 1.0f));
+        if (manager.getLoadedCount() == expected && manager.getGeneratingCount() == 0)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+void testSavesOnlyModified()
+{
+    StreamingSettings settings;
+    // The chunk the viewer is in and the four next to it
+    settings.renderDistance = 1;
+    settings.unloadMargin = 0;
+    const std::size_t loadedCount = 5;
+
+    World world;
+    RegionStorage storage(DIRECTORY);
+    ChunkManager manager(world, generateFlat, settings, 1);
+    manager.setStorage(&storage);
+
+    const glm::vec3 origin(8.0f, 20.0f, 8.0f);
+    CHECK(loadAround(manager, origin, loadedCount));
+    CHECK(!world.getChunk({0, 0})->isModified());
+
+    CHECK(world.setBlock(5, 20, 5, DIRT));
+    CHECK(world.getChunk({0, 0})->isModified());
+    CHECK(!world.getChunk({1, 0})->isModified());
+
+    // Far enough away that every chunk around the origin unloads, then wait for the saves.
+    CHECK(loadAround(manager, glm::vec3(1000.0f, 20.0f, 8.0f), loadedCount));
+    manager.saveAll();
+
+    Chunk chunk({0, 0});
+    CHECK(storage.loadChunk({0, 0}, chunk));
+    CHECK(chunk.getBlock(5, 20, 5) == DIRT);
+    CHECK(chunk.getBlock(5, 10, 5) == STONE);
+    CHECK(!chunk.isModified());
+    for (const ChunkPos& unmodified : {ChunkPos{1, 0}, ChunkPos{-1, 0}, ChunkPos{0, 1}, ChunkPos{0, -1}})
+    {
+        Chunk other(unmodified);
+        CHECK(!storage.loadChunk(unmodified, other));
+    }
+
+    // Coming back reads the edit from the region file.
+    CHECK(loadAround(manager, origin, loadedCount));
+    CHECK(world.getBlock(5, 20, 5) == DIRT);
+    CHECK(world.getBlock(16 + 5, 20, 5) == AIR);
+    CHECK(!world.getChunk({0, 0})->isModified());
+}
+
+void testResaveWhileSaving()
+{
+    StreamingSettings settings;
+    settings.renderDistance = 1;
+    settings.unloadMargin = 4;
+
+    World world;
+    RegionStorage storage(DIRECTORY);
+    // Unloaded chunks come back from the cache straight away, without waiting for a worker
+    ChunkCache cache(std::size_t(256) << 20);
+    ChunkManager manager(world, generateGated, settings, 2);
+    manager.setStorage(&storage);
+    manager.setCache(&cache);
+
+    CHECK(loadAround(manager, glm::vec3(8.0f, 20.0f, 8.0f), 5));
+
+    // The first copy is noisy so it is slow to encode, the second one is all stone and quick.
+    const ChunkPos edited = {1, 0};
+    Chunk* chunk = world.getChunk(edited);
+    std::mt19937 random(7);
+    const BlockId noise[] = {AIR, STONE, DIRT, SAND};
+    for (int y = 0; y < CHUNK_HEIGHT; y++)
+    {
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; x++)
+            {
+                chunk->setBlock(x, y, z, noise[random() % 4]);
+            }
+        }
+    }
+    chunk->setModified(true);
+
+    // Both workers get stuck generating a chunk each around the new position, nothing unloads
+    // yet. Once they are let go they pick up the two saves queued behind them at the same time.
+    gateOpen = false;
+    settings.maxGenerating = 2;
+    manager.setSettings(settings);
+    const glm::vec3 away(8.0f, 20.0f, 3 * 16 + 8.0f);
+    manager.update(away, glm::vec3(0.0f, 0.0f, 1.0f));
+    CHECK(manager.getGeneratingCount() == 2);
+
+    // Without the margin the edited chunk unloads, its save queues behind the generation.
+    settings.unloadMargin = 0;
+    manager.setSettings(settings);
+    manager.update(away, glm::vec3(0.0f, 0.0f, 1.0f));
+    CHECK(world.getChunk(edited) == nullptr);
+    CHECK(cache.contains(edited));
+
+    // Back from the cache, edited again and unloaded again while the first save still waits.
+    settings.renderDistance = 0;
+    settings.maxGenerating = 16;
+    manager.setSettings(settings);
+    manager.update(glm::vec3(16 + 8.0f, 20.0f, 8.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    chunk = world.getChunk(edited);
+    CHECK(chunk != nullptr);
+    if (chunk == nullptr)
+    {
+        gateOpen = true;
+        return;
+    }
+    chunk->fill(0, 0, 0, CHUNK_WIDTH - 1, CHUNK_HEIGHT - 1, CHUNK_WIDTH - 1, STONE);
+    chunk->setModified(true);
+    manager.update(away, glm::vec3(0.0f, 0.0f, 1.0f));
+    CHECK(world.getChunk(edited) == nullptr);
+
+    gateOpen = true;
+    manager.saveAll();
+
+    Chunk saved(edited);
+    CHECK(storage.loadChunk(edited, saved));
+    int different = 0;
+    for (int y = 0; y < CHUNK_HEIGHT; y++)
+    {
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; x++)
+            {
+                different += saved.getBlock(x, y, z) != STONE ? 1 : 0;
+            }
+        }
+    }
+    CHECK(different == 0);
+}
+
+} // namespace
+
+int main()
+{
+    testSavesOnlyModified();
+    testResaveWhileSaving();
+    std::remove((string_t(DIRECTORY) + "/" + RegionStorage::getRegionFileName(0, 0)).c_str());
+    std::remove((string_t(DIRECTORY) + "/" + RegionStorage::getRegionFileName(-1, 0)).c_str());
+    std::remove((string_t(DIRECTORY) + "/" + RegionStorage::getRegionFileName(0, -1)).c_str());
+    std::remove(DIRECTORY);
+    return test::result();
+}
@@ -0,0 +1,233 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "check.hpp"
+#include "world/chunkMesher.hpp"
+#include "world/lightEngine.hpp"
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Triangle counts of meshes with known answers, in both meshing modes.
+ * The shapes sit in section 1 of a chunk surrounded by empty chunks, so every block around
+ * them is air. Nothing is lit, which keeps the light on each face uniform so greedy meshing
+ * can merge whole faces, a missing neighbour would count as open sky and light the borders.
+ * The last cases put solid or missing chunks on either side to check the faces on the border.
+ */
+
+namespace
+{
+
+const int SECTION = 1;
+const int BASE_Y = SECTION * SECTION_SIZE;
+
+const Chunk EMPTY({0, 0});
+
+// The x neighbours are given, every other neighbour is empty.
+ChunkMesh meshChunk(const Chunk& chunk, const Chunk* negX, const Chunk* posX)
+{
+    const ChunkNeighbourhood neighbourhood = {&chunk, negX, posX, &EMPTY, &EMPTY, &EMPTY, &EMPTY, &EMPTY, &EMPTY};
+    ChunkMesh mesh;
+    ChunkMesher::meshSection(neighbourhood, SECTION, mesh);
+    return mesh;
+}
+
+ChunkMesh meshChunk(const Chunk& chunk)
+{
+    return meshChunk(chunk, &EMPTY, &EMPTY);
+}
+
+// Every quad is four vertices and two triangles.
+void checkQuads(const ChunkMesh& mesh)
+{
+    CHECK(mesh.indices.size() % 6 == 0);
+    CHECK(mesh.vertices.size() * 6 == mesh.indices.size() * 4);
+    for (std::uint16_t index : mesh.indices)
+    {
+        CHECK(index < mesh.vertices.size());
+    }
+}
+
+unsigned int countTriangles(Chunk& chunk, MeshingMode mode)
+{
+    chunk.setMeshingMode(mode);
+    const ChunkMesh mesh = meshChunk(chunk);
+    checkQuads(mesh);
+    return mesh.getTriangleCount();
+}
+
+void testEmpty()
+{
+    Chunk chunk({0, 0});
+    CHECK(countTriangles(chunk, MeshingMode::FACE_CULLING) == 0);
+    CHECK(countTriangles(chunk, MeshingMode::GREEDY) == 0);
+}
+
+void testSingleBlock()
+{
+    Chunk chunk({0, 0});
+    chunk.setBlock(7, BASE_Y + 7, 7, STONE);
+
+    // Six faces either way, there is nothing to merge.
+    CHECK(countTriangles(chunk, MeshingMode::FACE_CULLING) == 12);
+    CHECK(countTriangles(chunk, MeshingMode::GREEDY) == 12);
+
+    const ChunkMesh mesh = meshChunk(chunk);
+    for (const ChunkVertex& vertex : mesh.vertices)
+    {
+        CHECK(vertex.x >= 7 && vertex.x <= 8);
+        CHECK(vertex.y >= 7 && vertex.y <= 8);
+        CHECK(vertex.z >= 7 && vertex.z <= 8);
+        CHECK(vertex.block == STONE);
+    }
+}
+
+void testSolidCube()
+{
+    Chunk chunk({0, 0});
+    chunk.fill(0, BASE_Y, 0, 15, BASE_Y + 15, 15, STONE);
+
+    // Only the outside of the cube is visible, 16x16 faces on each of its 6 sides.
+    CHECK(countTriangles(chunk, MeshingMode::FACE_CULLING) == 6 * SECTION_AREA * 2);
+    // Each side merges into a single quad.
+    CHECK(countTriangles(chunk, MeshingMode::GREEDY) == 6 * 2);
+}
+
+void testCheckerboard()
+{
+    Chunk chunk({0, 0});
+    for (int y = 0; y < SECTION_SIZE; y++)
+    {
+        for (int z = 0; z < SECTION_SIZE; z++)
+        {
+            for (int x = 0; x < SECTION_SIZE; x++)
+            {
+                if ((x + y + z) % 2 == 0)
+                {
+                    chunk.setBlock(x, BASE_Y + y, z, STONE);
+                }
+            }
+        }
+    }
+
+    // No two blocks touch, so every face of every block is visible and no two faces
+    // in a plane are next to each other.
+    const unsigned int expected = SECTION_VOLUME / 2 * 6 * 2;
+    CHECK(countTriangles(chunk, MeshingMode::FACE_CULLING) == expected);
+    CHECK(countTriangles(chunk, MeshingMode::GREEDY) == expected);
+}
+
+void testMixedBlocks()
+{
+    // Two halves of a slab made of different blocks, greedy only merges faces of the same block.
+    Chunk chunk({0, 0});
+    chunk.fill(0, BASE_Y, 0, 7, BASE_Y, 15, STONE);
+    chunk.fill(8, BASE_Y, 0, 15, BASE_Y, 15, DIRT);
+
+    CHECK(countTriangles(chunk, MeshingMode::FACE_CULLING) == (2 * SECTION_AREA + 4 * SECTION_SIZE) * 2);
+    // Top and bottom split in two, the two ends along x whole and the two long sides split in two.
+    CHECK(countTriangles(chunk, MeshingMode::GREEDY) == (2 + 2 + 2 + 4) * 2);
+}
+
+void testSolidNeighbours()
+{
+    // The faces on the chunk border touch solid blocks in the chunks either side of it.
+    Chunk chunk({0, 0});
+    chunk.fill(0, BASE_Y, 0, 15, BASE_Y + 15, 15, STONE);
+    Chunk negX({-1, 0});
+    negX.fill(0, BASE_Y, 0, 15, BASE_Y + 15, 15, STONE);
+    Chunk posX({1, 0});
+    posX.fill(0, BASE_Y, 0, 15, BASE_Y + 15, 15, DIRT);
+
+    chunk.setMeshingMode(MeshingMode::FACE_CULLING);
+    ChunkMesh mesh = meshChunk(chunk, &negX, &posX);
+    checkQuads(mesh);
+    CHECK(mesh.getTriangleCount() == 4 * SECTION_AREA * 2);
+    for (const ChunkVertex& vertex : mesh.vertices)
+    {
+        // No face looks along x, those were all on the chunk border.
+        CHECK(vertex.face / 2 != 0);
+    }
+
+    chunk.setMeshingMode(MeshingMode::GREEDY);
+    mesh = meshChunk(chunk, &negX, &posX);
+    checkQuads(mesh);
+    CHECK(mesh.getTriangleCount() == 4 * 2);
+}
+
+void testMissingNeighbours()
+{
+    // A chunk that is not loaded counts as air, so the border faces are drawn.
+    Chunk chunk({0, 0});
+    chunk.fill(0, BASE_Y, 0, 15, BASE_Y + 15, 15, STONE);
+    Chunk negX({-1, 0});
+    negX.fill(0, BASE_Y, 0, 15, BASE_Y + 15, 15, STONE);
+
+    chunk.setMeshingMode(MeshingMode::FACE_CULLING);
+    ChunkMesh mesh = meshChunk(chunk, nullptr, nullptr);
+    checkQuads(mesh);
+    CHECK(mesh.getTriangleCount() == 6 * SECTION_AREA * 2);
+
+    // Only the missing side gets its faces back.
+    mesh = meshChunk(chunk, &negX, nullptr);
+    checkQuads(mesh);
+    CHECK(mesh.getTriangleCount() == 5 * SECTION_AREA * 2);
+}
+
+void testLitTerrain()
+{
+    // With real light the corners differ, greedy merges less but never does worse.
+    Chunk chunk({0, 0});
+    chunk.fill(0, 0, 0, 15, BASE_Y + 4, 15, STONE);
+    chunk.fill(4, BASE_Y + 5, 4, 11, BASE_Y + 9, 11, DIRT);
+    chunk.setBlock(2, BASE_Y + 5, 2, TORCH);
+    LightEngine::lightChunk(chunk);
+
+    const unsigned int faces = countTriangles(chunk, MeshingMode::FACE_CULLING);
+    const unsigned int greedy = countTriangles(chunk, MeshingMode::GREEDY);
+    CHECK(greedy > 0);
+    CHECK(greedy < faces);
+}
+
+} // namespace
+
+int main()
+{
+    testEmpty();
+    testSingleBlock();
+    testSolidCube();
+    testCheckerboard();
+    testMixedBlocks();
+    testSolidNeighbours();
+    testMissingNeighbours();
+    testLitTerrain();
+    return test::result();
+}
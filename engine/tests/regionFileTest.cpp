@@ -0,0 +1,242 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "check.hpp"
+#include "world/regionFile.hpp"
+#include "world/chunkCodec.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Chunks written to a region file read back the same, before and after reopening it, and
+ * rewriting a chunk never puts its new record on top of the old one or of another chunk.
+ * RegionStorage loads the same chunks correctly from several threads at once.
+ */
+
+namespace
+{
+
+const char* PATH = "regionFileTest.qrg";
+const char* DIRECTORY = "regionFileTestStorage";
+const std::uint32_t SECTOR_SIZE = 4096;
+const std::uint32_t TABLE_OFFSET = 16;
+
+// A chunk whose lowest layers hold random blocks, more layers make a longer record.
+std::vector<std::uint8_t> encodeChunk(int seed, int layers, Chunk& chunk)
+{
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> block(0, BLOCK_COUNT - 1);
+    for (int y = 0; y < layers; y++)
+    {
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; x++)
+            {
+                chunk.setBlock(x, y, z, static_cast<BlockId>(block(random)));
+            }
+        }
+    }
+    std::vector<std::uint8_t> data;
+    ChunkCodec::encode(chunk, data);
+    return data;
+}
+
+bool sameBlocks(const Chunk& a, const Chunk& b)
+{
+    for (int y = 0; y < CHUNK_HEIGHT; y++)
+    {
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; x++)
+            {
+                if (a.getBlock(x, y, z) != b.getBlock(x, y, z))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool readsBack(RegionFile& region, int x, int z, const Chunk& expected)
+{
+    Chunk chunk({0, 0});
+    return region.readChunk(x, z, chunk) && sameBlocks(chunk, expected);
+}
+
+// First sector << 8 | sector count of a chunk, straight from the file.
+std::uint32_t readEntry(int x, int z)
+{
+    std::ifstream file(PATH, std::ios::binary);
+    file.seekg(TABLE_OFFSET + (z * REGION_SIZE + x) * 4);
+    std::uint8_t bytes[4] = {};
+    file.read(reinterpret_cast<char*>(bytes), 4);
+    return std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8 | std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24;
+}
+
+bool overlaps(std::uint32_t a, std::uint32_t b)
+{
+    const std::uint32_t firstA = a >> 8;
+    const std::uint32_t firstB = b >> 8;
+    return firstA < firstB + (b & 0xff) && firstB < firstA + (a & 0xff);
+}
+
+std::uint64_t getFileSize()
+{
+    std::ifstream file(PATH, std::ios::binary | std::ios::ate);
+    return static_cast<std::uint64_t>(file.tellg());
+}
+
+void testWriteAndRead()
+{
+    RegionFile region;
+    CHECK(region.open(PATH, true));
+
+    Chunk small({0, 0});
+    Chunk large({0, 0});
+    const std::vector<std::uint8_t> smallData = encodeChunk(1, 2, small);
+    const std::vector<std::uint8_t> largeData = encodeChunk(2, 96, large);
+    CHECK(smallData.size() < SECTOR_SIZE / 2);
+    CHECK(largeData.size() > SECTOR_SIZE * 2);
+
+    CHECK(!region.hasChunk(3, 4));
+    CHECK(region.writeChunk(3, 4, smallData.data(), smallData.size()));
+    CHECK(region.writeChunk(31, 31, largeData.data(), largeData.size()));
+    CHECK(region.hasChunk(3, 4));
+    CHECK(readsBack(region, 3, 4, small));
+    CHECK(readsBack(region, 31, 31, large));
+
+    // Growing, shrinking and rewriting at the same size all move the record somewhere new.
+    const std::vector<const std::vector<std::uint8_t>*> rewrites = {&largeData, &smallData, &smallData, &largeData};
+    for (const std::vector<std::uint8_t>* data : rewrites)
+    {
+        const std::uint32_t before = readEntry(3, 4);
+        CHECK(region.writeChunk(3, 4, data->data(), data->size()));
+        const std::uint32_t after = readEntry(3, 4);
+        CHECK(!overlaps(before, after));
+        CHECK(!overlaps(after, readEntry(31, 31)));
+        CHECK(readsBack(region, 31, 31, large));
+    }
+    CHECK(readsBack(region, 3, 4, large));
+
+    // Freed sectors are reused, rewriting a chunk over and over does not keep growing the file.
+    const std::uint64_t size = getFileSize();
+    for (int i = 0; i < 20; i++)
+    {
+        const std::vector<std::uint8_t>& data = i % 2 ? smallData : largeData;
+        CHECK(region.writeChunk(3, 4, data.data(), data.size()));
+    }
+    CHECK(getFileSize() <= size + 2 * largeData.size() + SECTOR_SIZE);
+    CHECK(readsBack(region, 3, 4, small));
+
+    region.close();
+
+    // Everything is still there after reopening.
+    CHECK(region.open(PATH, false));
+    CHECK(readsBack(region, 3, 4, small));
+    CHECK(readsBack(region, 31, 31, large));
+    CHECK(!region.hasChunk(0, 0));
+}
+
+void testCorruption()
+{
+    // A damaged record fails its checksum instead of decoding into garbage.
+    const std::uint32_t entry = readEntry(31, 31);
+    {
+        std::fstream file(PATH, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(std::uint64_t(entry >> 8) * SECTOR_SIZE + 100);
+        file.put(static_cast<char>(0x5a));
+    }
+
+    RegionFile region;
+    CHECK(region.open(PATH, false));
+    Chunk chunk({0, 0});
+    CHECK(region.hasChunk(31, 31));
+    CHECK(!region.readChunk(31, 31, chunk));
+}
+
+void testStorageThreads()
+{
+    // Chunks on both sides of a region border, so two files are read at once.
+    const ChunkPos positions[] = {{30, 0}, {31, 0}, {32, 0}, {33, 0}, {30, 5}, {31, 5}, {32, 5}, {33, 5}};
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    RegionStorage storage(DIRECTORY);
+    for (int i = 0; i < 8; i++)
+    {
+        chunks.emplace_back(new Chunk(positions[i]));
+        CHECK(storage.saveChunk(positions[i], encodeChunk(i + 10, 8 + i * 8, *chunks.back())));
+    }
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 20; round++)
+            {
+                const int i = (t * 3 + round) % 8;
+                Chunk chunk(positions[i]);
+                if (!storage.loadChunk(positions[i], chunk) || !sameBlocks(chunk, *chunks[i]))
+                {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    CHECK(failures == 0);
+
+    std::remove((string_t(DIRECTORY) + "/" + RegionStorage::getRegionFileName(0, 0)).c_str());
+    std::remove((string_t(DIRECTORY) + "/" + RegionStorage::getRegionFileName(1, 0)).c_str());
+    std::remove(DIRECTORY);
+}
+
+} // namespace
+
+int main()
+{
+    std::remove(PATH);
+    testWriteAndRead();
+    testCorruption();
+    testStorageThreads();
+    std::remove(PATH);
+    return test::result();
+}
@@ -0,0 +1,136 @@
+/*
+ *	 Copyright (C) 2018 Qub³d Engine Group.
+ *	 All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification,
+ *  are permitted provided that the following conditions are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *  list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *  this list of conditions and the following disclaimer in the documentation and/or
+ *  other materials provided with the distribution.
+ *  
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *  may be used to endorse or promote products derived from this software without
+ *  specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ *  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "check.hpp"
+#include "world/terrainGenerator.hpp"
+#include "util/jobPool.hpp"
+#include <algorithm>
+#include <memory>
+
+using namespace qore;
+using namespace qore::world;
+
+/*
+ * Terrain depends on nothing but the seed and the position: the same region generated on one
+ * worker in order and on several workers in reverse order gives the same blocks, and so does a
+ * second generator with the same seed.
+ */
+
+namespace
+{
+
+const int SIDE = 8;
+const int THREADS = 4;
+
+std::uint64_t hashChunk(const Chunk& chunk)
+{
+    // FNV-1a over every block
+    std::uint64_t hash = 14695981039346656037ull;
+    for (int y = 0; y < CHUNK_HEIGHT; y++)
+    {
+        for (int z = 0; z < CHUNK_WIDTH; z++)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; x++)
+            {
+                const BlockId block = chunk.getBlock(x, y, z);
+                hash = (hash ^ (block & 0xff)) * 1099511628211ull;
+                hash = (hash ^ (block >> 8)) * 1099511628211ull;
+            }
+        }
+    }
+    return hash;
+}
+
+// Hashes of the SIDE x SIDE chunks around the origin, in x then z order whatever order they were made in.
+std::vector<std::uint64_t> generateRegion(const TerrainGenerator& generator, unsigned int threads, bool reverse)
+{
+    std::vector<std::uint64_t> hashes(SIDE * SIDE);
+    {
+        util::JobPool pool(threads);
+        for (int n = 0; n < SIDE * SIDE; n++)
+        {
+            const int i = reverse ? SIDE * SIDE - 1 - n : n;
+            pool.submit([&generator, &hashes, i]() {
+                Chunk chunk({i % SIDE - SIDE / 2, i / SIDE - SIDE / 2});
+                generator.generate(chunk);
+                hashes[i] = hashChunk(chunk);
+            });
+        }
+        pool.waitIdle();
+    }
+    return hashes;
+}
+
+} // namespace
+
+int main()
+{
+    TerrainSettings settings;
+    settings.seed = 12345;
+    const TerrainGenerator generator(settings);
+
+    const std::vector<std::uint64_t> serial = generateRegion(generator, 1, false);
+    const std::vector<std::uint64_t> parallel = generateRegion(generator, THREADS, true);
+    CHECK(serial == parallel);
+
+    // A fresh generator with the same seed, nothing carries over between instances.
+    const TerrainGenerator again(settings);
+    CHECK(generateRegion(again, THREADS, false) == serial);
+
+    // Chunks differ from each other, and a different seed gives a different world.
+    std::vector<std::uint64_t> sorted = serial;
+    std::sort(sorted.begin(), sorted.end());
+    CHECK(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+
+    settings.seed = 54321;
+    const TerrainGenerator other(settings);
+    CHECK(generateRegion(other, THREADS, false) != serial);
+
+    // Single column queries agree with the generated chunk, nothing but trees stands above the
+    // height getHeight reports.
+    Chunk chunk({3, -2});
+    generator.generate(chunk);
+    for (int z = 0; z < CHUNK_WIDTH; z++)
+    {
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+        {
+            const int height = generator.getHeight(3 * CHUNK_WIDTH + x, -2 * CHUNK_WIDTH + z);
+            CHECK(height > 0 && height < CHUNK_HEIGHT);
+            CHECK(chunk.getBlock(x, 0, z) == BEDROCK);
+            for (int y = height + 1; y < CHUNK_HEIGHT; y++)
+            {
+                const BlockId block = chunk.getBlock(x, y, z);
+                CHECK(block == AIR || block == LOG || block == LEAVES);
+            }
+        }
+    }
+
+    return test::result();
+}
@@ -6,10 +6,13 @@ namespace viking
 	{
 		GL11,
 		GL3,
-		Vulkan
+		Vulkan,
+		// No GPU or display, see null::NullRenderer
+		Null
 	};
 	enum class WindowingAPI
 	{
-		SDL
+		SDL,
+		Null
 	};
 }
\ No newline at end of file
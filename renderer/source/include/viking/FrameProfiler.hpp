@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace viking
+{
+	// Parts of a frame timed on their own, a frame's time also includes whatever happens outside of them
+	enum class FramePhase
+	{
+		// Game logic, streaming, meshing and uploads
+		UPDATE,
+		CULL,
+		// IRenderer::submitFrame up to the swap: preparing and drawing the frame, or with a render thread waiting
+		// for the last frame and preparing this one. Timed by the renderer
+		SUBMIT,
+		// Presenting the frame, timed by the renderer on whichever thread draws
+		SWAP,
+		COUNT
+	};
+
+	// Percentiles of the frames in the profiler's window, in milliseconds
+	struct FrameTimeStats
+	{
+		float p50;
+		float p95;
+		float p99;
+		float max;
+		float average;
+		unsigned int frames;
+	};
+
+	// Times frames and their phases with SDL's performance counter and keeps the last frames in a histogram, so
+	// percentiles stay cheap to work out however many frames are kept. Everything but addPhaseTime has to be called
+	// from the game thread
+	class FrameProfiler
+	{
+	public:
+		// window is the number of frames the stats cover
+		FrameProfiler(unsigned int window = 600);
+
+		// Ends the frame started by the previous call, its time is the time between the two calls
+		void nextFrame();
+		void beginPhase(FramePhase phase);
+		void endPhase(FramePhase phase);
+		// Adds time spent in a phase to the current frame, safe to call from any thread
+		void addPhaseTime(FramePhase phase, uint64_t ticks);
+
+		FrameTimeStats getFrameStats() const;
+		FrameTimeStats getPhaseStats(FramePhase phase) const;
+
+		// Writes the stats to the console every interval seconds from nextFrame, 0 turns it off
+		void setLogInterval(float seconds);
+		void log(std::ostream& out) const;
+
+		static uint64_t GetTicks();
+		static float TicksToMilliseconds(uint64_t ticks);
+		static const char* GetPhaseName(FramePhase phase);
+	private:
+		// Rolling window of frame times, with a histogram of 50us buckets up to 100ms alongside it
+		class Series
+		{
+		public:
+			Series(unsigned int window);
+			void add(float ms);
+			FrameTimeStats getStats() const;
+		private:
+			unsigned int GetBucket(float ms) const;
+			float GetPercentile(float percentile, float max) const;
+
+			std::vector<float> m_samples;
+			std::vector<unsigned int> m_buckets;
+			unsigned int m_next = 0;
+			unsigned int m_count = 0;
+			double m_total = 0.0;
+		};
+
+		Series m_frame;
+		std::vector<Series> m_phases;
+		// Ticks spent in each phase since the last nextFrame
+		std::atomic<uint64_t> m_phase_ticks[static_cast<int>(FramePhase::COUNT)];
+		uint64_t m_phase_start[static_cast<int>(FramePhase::COUNT)];
+		uint64_t m_frame_start = 0;
+		uint64_t m_log_interval = 0;
+		uint64_t m_last_log = 0;
+	};
+}
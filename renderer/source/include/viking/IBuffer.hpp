@@ -8,7 +8,10 @@ namespace viking
 	class IBuffer
 	{
 	public:
+		virtual ~IBuffer() {}
 
+		// Call after changing the memory the buffer was created with, the renderer only sends what these mark.
+		// count and startIndex are in elements
 		virtual void setData() {};
 		virtual void setData(unsigned int count) {};
 		virtual void setData(unsigned int startIndex, unsigned int count) {};
@@ -3,7 +3,9 @@
 #include <viking/VertexBufferBase.hpp>
 #include <viking/ShaderStage.hpp>
 #include <viking/IModelPool.hpp>
+#include <viking/IMeshBatch.hpp>
 #include <map>
+#include <vector>
 
 namespace viking
 {
@@ -13,9 +15,18 @@ namespace viking
 		IGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths);
 
 		virtual void attachModelPool(IModelPool* pool) = 0;
+		virtual void detachModelPool(IModelPool* pool) = 0;
+		// Replace every attached pool with the given list, for callers that cull their pools and hand over a new draw list each frame
+		virtual void setModelPools(const std::vector<IModelPool*>& pools) = 0;
+		// Batches are drawn along with the pools, each with as few draw calls as the backend allows
+		virtual void attachMeshBatch(IMeshBatch* batch) = 0;
+		virtual void detachMeshBatch(IMeshBatch* batch) = 0;
 		virtual void build() = 0;
 		virtual void attachVertexBinding(VertexBufferBase vertex) = 0;
+		// Pipeline field of RenderQueue keys, pipelines are numbered in the order they are created
+		unsigned int getSortId() const;
 	protected:
 		std::map<ShaderStage, const char*> m_shader_paths;
+		unsigned int m_sort_id;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <viking/VertexBufferBase.hpp>
+#include <viking/IUniformBuffer.hpp>
+#include <viking/ITextureBuffer.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace viking
+{
+	// Many meshes sharing one vertex buffer and one index buffer, so the visible ones are drawn together
+	// instead of switching buffers and issuing draws mesh by mesh like separate model pools.
+	// Indices are 16 bit and local to their mesh.
+	class IMeshBatch
+	{
+	public:
+		// instance is the layout of the data handed to addMesh for each mesh, nullptr for none
+		IMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance) : m_vertex(vertex), m_instance(instance){}
+		virtual ~IMeshBatch() {}
+
+		// Copies a mesh into the batch, instance points at one element of the instance layout.
+		// Returns the id used to refer to the mesh afterwards
+		virtual unsigned int addMesh(const void* vertices, unsigned int vertex_count, const uint16_t* indices, unsigned int index_count, const void* instance) = 0;
+		virtual void removeMesh(unsigned int mesh) = 0;
+
+		// The meshes drawn until the next call, in this order
+		virtual void setVisible(const std::vector<unsigned int>& meshes) = 0;
+
+		virtual void attachBuffer(IUniformBuffer* buffer) = 0;
+		virtual void attachBuffer(ITextureBuffer* buffer) = 0;
+		// Texture field of the batch's RenderQueue key, the first attached texture
+		virtual unsigned int GetSortTexture() = 0;
+	protected:
+		VertexBufferBase* m_vertex;
+		VertexBufferBase* m_instance;
+	};
+}
@@ -18,6 +18,12 @@ namespace viking
 		virtual void attachBuffer(unsigned int index, IUniformBuffer * buffer) = 0;
 		virtual void attachBuffer(IUniformBuffer * buffer) = 0;
 		virtual void attachBuffer(ITextureBuffer * buffer) = 0;
+		// Replace the geometry drawn by the pool, the old buffers are no longer referenced afterwards
+		virtual void setBuffers(IBuffer* vertex_data, IBuffer* index_data) = 0;
+		// Attributes read once per model instead of once per vertex, element i of instance_data belongs to the
+		// i-th model created by the pool. Cheaper than a matrix per model in an indexed uniform buffer and not
+		// limited by the uniform block size, which stays available for models that need full matrices
+		virtual void setInstanceBuffer(viking::VertexBufferBase* instance, IBuffer* instance_data) = 0;
 	protected:
 		viking::VertexBufferBase* m_base;
 		IBuffer* m_vertex_data;
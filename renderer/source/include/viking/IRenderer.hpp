@@ -7,11 +7,18 @@
 #include <viking/IGraphicsPipeline.hpp>
 #include <viking/ITextureBuffer.hpp>
 #include <viking/IModelPool.hpp>
+#include <viking/IMeshBatch.hpp>
 #include <viking/IBuffer.hpp>
 #include <viking/ShaderStage.hpp>
 #include <viking/API.hpp>
+#include <viking/RenderQueue.hpp>
+#include <viking/FrameProfiler.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
 
 namespace viking 
 {
@@ -20,18 +27,62 @@ namespace viking
 	public:
 
 		static IRenderer* createRenderer(const RenderingAPI& api);
+		// Stops the render thread. Backends stop it in their own destructor first, so a frame still being drawn never
+		// runs render on a half destroyed backend
+		virtual ~IRenderer();
 		void addWindow(IWindow* window);
+		// Draws recorded here are sorted and drawn by the next submitFrame, along with every pool and batch
+		// attached to a pipeline
+		RenderQueue* getRenderQueue();
 		virtual void start() = 0;
+		// Draws the frame handed over by the last submitFrame
 		virtual void render() = 0;
+
+		// Ends the game side of a frame. Everything render reads from the game's memory is copied into the renderer's
+		// frame packet, then the frame is drawn and the window's buffers swapped, right away or on the render thread.
+		// With a render thread the game runs at most one frame ahead: this waits for the previous frame to be drawn
+		// before handing over the next one, and the next frame's game work overlaps with this one being drawn
+		void submitFrame();
+
+		// Draws on a thread of its own from now on, the window's context moves there. Pipelines, pools, batches and
+		// buffers have to be created and set up before, only recording, addMesh, removeMesh, setVisible and setData
+		// are allowed meanwhile. Returns false without a window or with the thread already running.
+		// SDL windows can only be drawn to from another thread on Windows and Linux
+		bool startRenderThread();
+		// Waits for the frame being drawn and gives the context back to the calling thread
+		void stopRenderThread();
+		bool isRenderThreadRunning();
+		// submitFrame is timed into the profiler's SUBMIT phase and swaps into SWAP from here on, swaps on whichever
+		// thread draws. nullptr stops it
+		void setFrameProfiler(FrameProfiler* profiler);
 		virtual IComputePipeline* createComputePipeline(const char* path, unsigned int x, unsigned int y, unsigned int z) = 0;
 		virtual IComputeProgram* createComputeProgram() = 0;
 		virtual IGraphicsPipeline* createGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths) = 0;
 		virtual IModelPool* createModelPool(VertexBufferBase* vertex, IBuffer* vertex_data, IBuffer*index_data) = 0;
+		virtual IMeshBatch* createMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance) = 0;
 		virtual IBuffer* createBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount) = 0;
 		virtual IUniformBuffer* createUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, ShaderStage shader_stage, unsigned int binding) = 0;
 		virtual ITextureBuffer* createTextureBuffer(void* dataPtr, unsigned int width, unsigned int height) = 0;
 	protected:
+		// Fills the frame packet for the next render, called with the render thread idle. Without a render thread
+		// the game's memory stays untouched until render, so copy can be false and render read it in place
+		virtual void prepareFrame(bool copy) = 0;
+
 		// Just storing a single window for now
-		IWindow * m_window;
+		IWindow * m_window = nullptr;
+		RenderQueue m_queue;
+	private:
+		void RenderThread();
+		void SwapBuffers();
+		void AddPhaseTime(FramePhase phase, uint64_t start);
+
+		std::thread m_render_thread;
+		std::mutex m_frame_mutex;
+		std::condition_variable m_frame_ready;
+		std::condition_variable m_frame_done;
+		// A prepared frame the render thread has not finished drawing yet
+		bool m_frame_pending = false;
+		bool m_stop_render_thread = false;
+		std::atomic<FrameProfiler*> m_profiler{ nullptr };
 	};
 }
\ No newline at end of file
@@ -4,10 +4,16 @@
 #include <viking/IBuffer.hpp>
 #include <viking/IDescriptor.hpp>
 
+#include <map>
+
 namespace viking
 {
 	class IRenderer;
 	class IUniformBuffer : public virtual IBuffer, public virtual IDescriptor
 	{
+	protected:
+		// Adds the elements from start to end to ranges of changed elements, start of each range to its end.
+		// Overlapping and touching ranges are merged
+		static void AddRange(std::map<unsigned int, unsigned int>& ranges, unsigned int start, unsigned int end);
 	};
 }
\ No newline at end of file
@@ -12,6 +12,10 @@ namespace viking
 		virtual void swapBuffers() = 0;
 		virtual bool isRunning() = 0;
 		virtual void GetSize(int& width, int& height) = 0;
+		// Moves the window's rendering context to the calling thread or lets go of it, so the renderer can draw from
+		// a thread of its own. Windows whose rendering API has no per thread context do nothing
+		virtual void makeContextCurrent() {}
+		virtual void releaseContext() {}
 		WindowingAPI GetWindowingAPI();
 	protected:
 		IWindow(WindowingAPI windowing_api);
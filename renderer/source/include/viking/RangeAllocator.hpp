@@ -0,0 +1,28 @@
+#pragma once
+
+#include <map>
+
+namespace viking
+{
+	// Hands out ranges of a linear buffer, first fit, with freed ranges merged back with their neighbours.
+	// Only the bookkeeping, the buffer itself is up to the caller
+	class RangeAllocator
+	{
+	public:
+		RangeAllocator(unsigned int capacity = 0);
+
+		// Finds room for count elements, false when there is no free range that large
+		bool allocate(unsigned int count, unsigned int& offset);
+		void free(unsigned int offset, unsigned int count);
+		// Adds room at the end, capacity can only grow
+		void grow(unsigned int capacity);
+
+		unsigned int getCapacity() const;
+		unsigned int getUsed() const;
+	private:
+		// Start of each free range to its length
+		std::map<unsigned int, unsigned int> m_free;
+		unsigned int m_capacity;
+		unsigned int m_used;
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace viking
+{
+	class IGraphicsPipeline;
+	class IModelPool;
+	class IMeshBatch;
+
+	enum class RenderCommandType
+	{
+		MODEL_POOL,
+		MESH_BATCH
+	};
+
+	// One draw, replayed by the backend in key order
+	struct RenderCommand
+	{
+		uint64_t key;
+		IGraphicsPipeline* pipeline;
+		// IModelPool or IMeshBatch, depending on type
+		void* drawable;
+		RenderCommandType type;
+	};
+
+	// The draws of one frame, sorted by a 64 bit key so draws sharing a pipeline and texture end up next to each
+	// other whatever order they were recorded in. Draws with equal keys keep the order they were recorded in.
+	// Each thread records into its own Recorder, so culling and meshing workers can submit without locking,
+	// as long as they are done before the frame is rendered
+	class RenderQueue
+	{
+	public:
+		// Key fields from most to least significant
+		static const unsigned int PASS_BITS = 8;
+		static const unsigned int PIPELINE_BITS = 16;
+		static const unsigned int TEXTURE_BITS = 16;
+		static const unsigned int DEPTH_BITS = 24;
+
+		class Recorder
+		{
+		public:
+			void draw(uint64_t key, IGraphicsPipeline* pipeline, IModelPool* pool);
+			void draw(uint64_t key, IGraphicsPipeline* pipeline, IMeshBatch* batch);
+		private:
+			friend class RenderQueue;
+			std::vector<RenderCommand> m_commands;
+		};
+
+		// Fields wider than their bits are cut off, which only costs sorting quality
+		static uint64_t MakeKey(unsigned int pass, unsigned int pipeline, unsigned int texture, unsigned int depth);
+		// Distance from the camera as a depth field, near to far. Use the largest bucket minus this for back to front
+		static unsigned int DepthBucket(float distance, float max_distance);
+
+		// Recorders live as long as the queue, make one per thread up front rather than every frame
+		Recorder* createRecorder();
+
+		// Moves every recorder's commands into one list sorted by key, no recorder may be recording meanwhile.
+		// The list stays valid until the next sort or clear
+		const std::vector<RenderCommand>& sort();
+		// Drops everything recorded so far
+		void clear();
+	private:
+		// Least significant byte first, bytes every key has in common are skipped
+		void RadixSort();
+
+		std::mutex m_recorders_mutex;
+		std::vector<std::unique_ptr<Recorder>> m_recorders;
+		std::vector<RenderCommand> m_commands;
+		std::vector<RenderCommand> m_scratch;
+	};
+}
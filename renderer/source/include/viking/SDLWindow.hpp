@@ -23,7 +23,6 @@ namespace viking
 		SDL_Window * m_window;
 		SDL_GLContext m_context;
 		bool m_running;
-		float m_last_tick;
 	private:
 
 	};
@@ -4,10 +4,36 @@
 
 namespace viking
 {
+	// Type of each component of a vertex attribute as it is stored in the vertex buffer
+	enum class VertexType
+	{
+		FLOAT,
+		HALF_FLOAT,
+		BYTE,
+		UNSIGNED_BYTE,
+		SHORT,
+		UNSIGNED_SHORT,
+		INT,
+		UNSIGNED_INT
+	};
+
+	// How the shader sees an attribute
+	enum class VertexMode
+	{
+		// Converted straight to float, 200 reads as 200.0
+		CONVERTED,
+		// Integers mapped to 0..1 (or -1..1 when signed), 255 reads as 1.0
+		NORMALIZED,
+		// Kept as integers, read through int / uint / ivecN / uvecN inputs
+		INTEGER
+	};
+
 	struct VertexBinding
 	{
 	public:
-		VertexBinding(unsigned int location, unsigned int size, unsigned int offset) : m_location (location) , m_size(size), m_offset(offset){}
+		// size is in bytes, the number of components is size divided by the size of type
+		VertexBinding(unsigned int location, unsigned int size, unsigned int offset, VertexType type = VertexType::FLOAT, VertexMode mode = VertexMode::CONVERTED) :
+			m_location (location) , m_size(size), m_offset(offset), m_type(type), m_mode(mode){}
 		unsigned int GetLocation()
 		{
 			return m_location;
@@ -20,9 +46,39 @@ namespace viking
 		{
 			return m_size;
 		}
+		VertexType GetType()
+		{
+			return m_type;
+		}
+		VertexMode GetMode()
+		{
+			return m_mode;
+		}
+		unsigned int GetComponentCount()
+		{
+			return m_size / GetTypeSize(m_type);
+		}
+
+		static unsigned int GetTypeSize(VertexType type)
+		{
+			switch (type)
+			{
+			case VertexType::BYTE:
+			case VertexType::UNSIGNED_BYTE:
+				return 1;
+			case VertexType::HALF_FLOAT:
+			case VertexType::SHORT:
+			case VertexType::UNSIGNED_SHORT:
+				return 2;
+			default:
+				return 4;
+			}
+		}
 	private:
 		unsigned int m_location;
 		unsigned int m_offset;
 		unsigned int m_size;
+		VertexType m_type;
+		VertexMode m_mode;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <viking/IBuffer.hpp>
+
+namespace viking
+{
+	namespace null
+	{
+		// Only describes the game's memory, pools copy what they need from it like the other backends
+		class NullBuffer : public virtual IBuffer
+		{
+		public:
+			NullBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount);
+		};
+	}
+}
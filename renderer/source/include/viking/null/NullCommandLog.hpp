@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		enum class NullCommandType
+		{
+			// A renderer object was made, bytes is what it copied in, texture pixels or pool geometry
+			CREATE,
+			// A pipeline's shaders would be compiled and linked
+			BUILD,
+			// A pool's geometry was replaced, bytes is the new vertex and index data
+			SET_BUFFERS,
+			// A mesh was copied into a batch, count is its index count
+			ADD_MESH,
+			REMOVE_MESH,
+			// A changed range of a uniform buffer was sent before a draw
+			UPLOAD_UNIFORM,
+			// A pool's per model data was sent before its draw, from its instance buffer and indexed buffers
+			UPLOAD_INSTANCES,
+			BIND_PIPELINE,
+			// An instanced draw of a pool, count is the number of models
+			DRAW_POOL,
+			// One multi draw of a batch, count is the number of meshes and bytes the size of the indirect commands
+			DRAW_BATCH,
+			// A compute program was run
+			DISPATCH
+		};
+
+		// One call received by the null backend
+		struct NullCommand
+		{
+			NullCommandType type;
+			// The object the call was made on, numbered from 1 in the order objects are made
+			unsigned int object;
+			unsigned int count;
+			size_t bytes;
+		};
+
+		// Totals of one frame's commands
+		struct NullFrameStats
+		{
+			unsigned int commands;
+			unsigned int draw_calls;
+			// Models drawn by pools plus meshes drawn by batches
+			unsigned int instances;
+			unsigned int pipeline_binds;
+			size_t upload_bytes;
+		};
+
+		// Every call the null backend receives, kept frame by frame.
+		// Calls made outside of render land in the frame being built, so with a render thread a call from the
+		// game thread is counted in whichever frame is drawn when it is made
+		class NullCommandLog
+		{
+		public:
+			// Hands out the number the next object is known by
+			unsigned int createObject();
+			void record(NullCommandType type, unsigned int object, unsigned int count = 0, size_t bytes = 0);
+			// Ends the frame being built, it becomes the last frame
+			void nextFrame();
+
+			// Frames ended so far
+			unsigned int getFrameCount() const;
+			std::vector<NullCommand> getLastFrame() const;
+			NullFrameStats getLastFrameStats() const;
+			// Writes the last frame's commands one per line
+			void dumpLastFrame(std::ostream& out) const;
+
+			static const char* GetTypeName(NullCommandType type);
+		private:
+			mutable std::mutex m_mutex;
+			unsigned int m_objects = 0;
+			unsigned int m_frames = 0;
+			std::vector<NullCommand> m_frame;
+			NullFrameStats m_frame_stats = {};
+			std::vector<NullCommand> m_last_frame;
+			NullFrameStats m_last_frame_stats = {};
+		};
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <viking/IComputePipeline.hpp>
+#include <viking/null/NullCommandLog.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		class NullComputePipeline : public IComputePipeline
+		{
+		public:
+			NullComputePipeline(const char* path, unsigned int x, unsigned int y, unsigned int z, NullCommandLog* log, unsigned int object);
+			virtual void attachBuffer(IUniformBuffer* buffer);
+			virtual void build();
+		private:
+			NullCommandLog* m_log;
+			unsigned int m_object;
+			std::vector<IUniformBuffer*> m_buffers;
+		};
+	}
+}
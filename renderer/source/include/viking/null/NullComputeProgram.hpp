@@ -0,0 +1,22 @@
+#pragma once
+
+#include <viking/IComputeProgram.hpp>
+#include <viking/null/NullCommandLog.hpp>
+
+namespace viking
+{
+	namespace null
+	{
+		class NullComputeProgram : public IComputeProgram
+		{
+		public:
+			NullComputeProgram(NullCommandLog* log, unsigned int object);
+			virtual void build();
+			// Records one dispatch per attached pipeline
+			virtual void run();
+		private:
+			NullCommandLog* m_log;
+			unsigned int m_object;
+		};
+	}
+}
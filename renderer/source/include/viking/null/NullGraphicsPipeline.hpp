@@ -0,0 +1,38 @@
+#pragma once
+
+#include <viking/IGraphicsPipeline.hpp>
+#include <viking/RenderQueue.hpp>
+#include <viking/null/NullCommandLog.hpp>
+#include <viking/null/NullModelPool.hpp>
+#include <viking/null/NullMeshBatch.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		// Shaders are never read, the pipeline only records its pools and batches like the OpenGL one
+		class NullGraphicsPipeline : public IGraphicsPipeline
+		{
+		public:
+			NullGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths, NullCommandLog* log, unsigned int object);
+			virtual void build();
+			// Adds a command for every attached pool and batch
+			void record(RenderQueue::Recorder* recorder);
+			void bind();
+			virtual void attachModelPool(IModelPool* pool);
+			virtual void detachModelPool(IModelPool* pool);
+			virtual void setModelPools(const std::vector<IModelPool*>& pools);
+			virtual void attachMeshBatch(IMeshBatch* batch);
+			virtual void detachMeshBatch(IMeshBatch* batch);
+			virtual void attachVertexBinding(VertexBufferBase vertex);
+		private:
+			NullCommandLog* m_log;
+			unsigned int m_object;
+			std::vector<NullModelPool*> m_pools;
+			std::vector<NullMeshBatch*> m_batches;
+			std::vector<VertexBufferBase> m_vertex_bases;
+		};
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <viking/IMeshBatch.hpp>
+#include <viking/RangeAllocator.hpp>
+#include <viking/null/NullCommandLog.hpp>
+#include <viking/null/NullUniformBuffer.hpp>
+#include <viking/null/NullTextureBuffer.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		// Keeps the meshes in CPU side arenas laid out like the OpenGL batch's and records one multi draw per frame
+		class NullMeshBatch : public IMeshBatch
+		{
+		public:
+			NullMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance, NullCommandLog* log, unsigned int object);
+			virtual unsigned int addMesh(const void* vertices, unsigned int vertex_count, const uint16_t* indices, unsigned int index_count, const void* instance);
+			virtual void removeMesh(unsigned int mesh);
+			virtual void setVisible(const std::vector<unsigned int>& meshes);
+			virtual void attachBuffer(IUniformBuffer* buffer);
+			virtual void attachBuffer(ITextureBuffer* buffer);
+			virtual unsigned int GetSortTexture();
+			// Counts the visible meshes the next render draws
+			void prepare();
+			void render();
+		private:
+			struct Mesh
+			{
+				unsigned int first_vertex;
+				unsigned int vertex_count;
+				unsigned int first_index;
+				unsigned int index_count;
+				bool used;
+			};
+
+			// Finds room for count elements, growing the allocator and its arena when it is full
+			unsigned int Allocate(RangeAllocator& allocator, std::vector<char>& arena, unsigned int element_size, unsigned int count);
+
+			NullCommandLog* m_log;
+			unsigned int m_object;
+			RangeAllocator m_vertices;
+			RangeAllocator m_indices;
+			std::vector<char> m_vertex_data;
+			std::vector<char> m_index_data;
+			std::vector<char> m_instance_data;
+
+			std::vector<Mesh> m_meshes;
+			std::vector<unsigned int> m_free_meshes;
+			std::vector<unsigned int> m_visible;
+			unsigned int m_frame_meshes = 0;
+
+			std::vector<NullUniformBuffer*> m_buffers;
+			std::vector<NullTextureBuffer*> m_textureBuffers;
+		};
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <viking/IModelPool.hpp>
+#include <viking/null/NullCommandLog.hpp>
+#include <viking/null/NullUniformBuffer.hpp>
+#include <viking/null/NullTextureBuffer.hpp>
+
+#include <map>
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		// Copies geometry and per model data to the CPU when the OpenGL backend would send it to the GPU,
+		// and records one instanced draw per frame
+		class NullModelPool : public IModelPool
+		{
+		public:
+			NullModelPool(VertexBufferBase* base, IBuffer* vertex_data, IBuffer* index_data, NullCommandLog* log, unsigned int object);
+			~NullModelPool();
+			// Texture field of the pool's RenderQueue key, the first attached texture
+			unsigned int GetSortTexture();
+			// Copies the instance data and the indexed buffers' elements of every model for the next render
+			void prepare();
+			void render();
+			virtual IModel* createModel();
+			virtual void attachBuffer(unsigned int index, IUniformBuffer * buffer);
+			virtual void attachBuffer(IUniformBuffer * buffer);
+			virtual void attachBuffer(ITextureBuffer * buffer);
+			virtual void setBuffers(IBuffer* vertex_data, IBuffer* index_data);
+			virtual void setInstanceBuffer(VertexBufferBase* instance, IBuffer* instance_data);
+		private:
+			NullCommandLog* m_log;
+			unsigned int m_object;
+			std::map<unsigned int, IModel*> m_models;
+			std::map<unsigned int, IUniformBuffer*> m_indexed_buffers;
+			std::vector<NullUniformBuffer*> m_buffers;
+			std::vector<NullTextureBuffer*> m_textureBuffers;
+			VertexBufferBase* m_instance_base = nullptr;
+			IBuffer* m_instance_data = nullptr;
+
+			std::vector<char> m_vertices;
+			std::vector<char> m_indices;
+			std::vector<char> m_instances;
+			unsigned int m_frame_models = 0;
+		};
+	}
+}
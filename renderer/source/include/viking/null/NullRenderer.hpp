@@ -0,0 +1,47 @@
+#pragma once
+
+#include <viking/IRenderer.hpp>
+#include <viking/null/NullCommandLog.hpp>
+#include <viking/null/NullGraphicsPipeline.hpp>
+
+#include <ostream>
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		// Runs everything the OpenGL backend does on the CPU, without a GPU or a display. Buffers keep CPU side
+		// copies and every call is recorded with the bytes it would send, so the game's side of rendering can be
+		// benchmarked on its own and draw call counts checked.
+		// Pair it with a NullWindow, or call render without one
+		class NullRenderer : public IRenderer
+		{
+		public:
+			NullRenderer();
+			virtual ~NullRenderer();
+			virtual void start();
+			virtual void render();
+			virtual IComputePipeline* createComputePipeline(const char* path, unsigned int x, unsigned int y, unsigned int z);
+			virtual IComputeProgram* createComputeProgram();
+			virtual IGraphicsPipeline* createGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths);
+			virtual IModelPool* createModelPool(VertexBufferBase* vertex, IBuffer* vertex_data, IBuffer*index_data);
+			virtual IMeshBatch* createMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance);
+			virtual IBuffer* createBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount);
+			virtual IUniformBuffer* createUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, ShaderStage shader_stage, unsigned int binding);
+			virtual ITextureBuffer* createTextureBuffer(void* dataPtr, unsigned int width, unsigned int height);
+			// Every call so far, frame by frame, each render ends a frame
+			const NullCommandLog& getCommandLog() const;
+			NullFrameStats getLastFrameStats() const;
+			void dumpLastFrame(std::ostream& out) const;
+		protected:
+			// Every drawable copies what it reads on the CPU already, so copy makes no difference
+			virtual void prepareFrame(bool copy);
+		private:
+			NullCommandLog m_log;
+			RenderQueue::Recorder* m_recorder;
+			const std::vector<RenderCommand>* m_commands = nullptr;
+			std::vector<NullGraphicsPipeline*> m_graphics_pipeline;
+		};
+	}
+}
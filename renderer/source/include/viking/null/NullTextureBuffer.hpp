@@ -0,0 +1,23 @@
+#pragma once
+
+#include <viking/ITextureBuffer.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		// Keeps a copy of the 24 bit pixels, as the OpenGL backend would send them
+		class NullTextureBuffer : public ITextureBuffer
+		{
+		public:
+			NullTextureBuffer(void* dataPtr, unsigned int width, unsigned int height, unsigned int object);
+			// Texture field of RenderQueue keys
+			unsigned int GetObject();
+		private:
+			unsigned int m_object;
+			std::vector<char> m_pixels;
+		};
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <viking/IUniformBuffer.hpp>
+#include <viking/null/NullCommandLog.hpp>
+
+#include <map>
+#include <vector>
+
+namespace viking
+{
+	namespace null
+	{
+		// Tracks changed elements like the OpenGL uniform buffer, sending them to a CPU side copy of the buffer
+		class NullUniformBuffer : public IUniformBuffer
+		{
+		public:
+			NullUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, unsigned int binding, NullCommandLog* log, unsigned int object);
+			// Copies the elements changed since the last prepare into the buffer's copy for the next bind
+			void prepare();
+			// Records an upload for every range the last prepare copied
+			void bind();
+			virtual void setData();
+			virtual void setData(unsigned int count);
+			virtual void setData(unsigned int startIndex, unsigned int count);
+		private:
+			NullCommandLog* m_log;
+			unsigned int m_object;
+			bool m_prepared = false;
+			std::map<unsigned int, unsigned int> m_dirty;
+			std::map<unsigned int, unsigned int> m_frame;
+			std::vector<char> m_storage;
+		};
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <viking/IWindow.hpp>
+#include <viking/WindowDescriptor.hpp>
+
+#include <atomic>
+
+namespace viking
+{
+	namespace null
+	{
+		// A window with nothing on screen for the null backend, so the renderer can run without a display
+		class NullWindow : public IWindow
+		{
+		public:
+			NullWindow(WindowDescriptor descriptor);
+			virtual void poll();
+			// Only counts frames
+			virtual void swapBuffers();
+			virtual bool isRunning();
+			virtual void GetSize(int& width, int& height);
+			// Stops running once frame_limit frames were swapped, 0 runs until close
+			void setFrameLimit(unsigned int frame_limit);
+			void close();
+			unsigned int getFrameCount();
+		private:
+			int m_width;
+			int m_height;
+			// swapBuffers runs on the render thread when there is one
+			std::atomic<bool> m_running;
+			std::atomic<unsigned int> m_frames;
+			std::atomic<unsigned int> m_frame_limit;
+		};
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <viking/opengl/glad.h>
+
+// glad.h only covers GL 3.3 core, the few newer enums the backend uses are declared here
+#ifndef GL_VERSION_4_0
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_VERSION_4_3
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_MAX_SHADER_STORAGE_BLOCK_SIZE 0x90DE
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+#endif
+
+#ifndef GL_VERSION_4_4
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+#endif
+
+namespace viking
+{
+	namespace opengl
+	{
+		// Where per model data attached with IModelPool::attachBuffer(index, ...) lives on the GPU
+		enum class InstanceStorage
+		{
+			// A slice of the models per draw, limited by GL_MAX_UNIFORM_BLOCK_SIZE (often 512 matrices)
+			UNIFORM_BUFFER,
+			// GL 3.1, read with texelFetch from a samplerBuffer of RGBA32F texels
+			TEXTURE_BUFFER,
+			// GL 4.3 or ARB_shader_storage_buffer_object, read from a std430 buffer block
+			SHADER_STORAGE_BUFFER
+		};
+
+		// What the current context supports, filled once by OpenGLRenderer::start
+		struct OpenGLCapabilities
+		{
+			int major_version = 3;
+			int minor_version = 3;
+			bool texture_buffer = false;
+			bool shader_storage_buffer = false;
+			// GL 4.3, or ARB_multi_draw_indirect together with ARB_base_instance
+			bool multi_draw_indirect = false;
+			// GL 4.4 or ARB_buffer_storage, buffers can stay mapped while the GPU reads them
+			bool buffer_storage = false;
+
+			GLint max_uniform_block_size = 16384;
+			// In texels
+			GLint max_texture_buffer_size = 65536;
+			GLint max_shader_storage_block_size = 0;
+			// Offsets given to glBindBufferRange must be multiples of these
+			GLint uniform_buffer_alignment = 256;
+			GLint shader_storage_alignment = 256;
+
+			InstanceStorage instance_storage = InstanceStorage::UNIFORM_BUFFER;
+
+			// Entry points newer than glad.h, nullptr when not supported
+			PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = nullptr;
+			PFNGLBUFFERSTORAGEPROC BufferStorage = nullptr;
+
+			// Needs a current context, load is used to look up the entry points glad.h does not know about
+			void query(GLADloadproc load);
+			bool hasVersion(int major, int minor) const;
+			bool hasExtension(const char* name) const;
+
+			// How many elements of index_size bytes one draw can read from instance_storage
+			unsigned int getMaxInstances(unsigned int index_size) const;
+			// Lines added after #version so shaders can pick the matching way of reading instance data,
+			// VIKING_INSTANCE_SSBO, VIKING_INSTANCE_TBO or VIKING_INSTANCE_UBO is defined
+			const char* getShaderDefines() const;
+		};
+	}
+}
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <viking/IGraphicsPipeline.hpp>
+#include <viking/RenderQueue.hpp>
 #include <viking/opengl/OpenGLModelPool.hpp>
+#include <viking/opengl/OpenGLMeshBatch.hpp>
+#include <viking/opengl/OpenGLCapabilities.hpp>
+#include <viking/opengl/OpenGLStateCache.hpp>
 #include <viking/opengl/glad.h>
+#include <string>
 
 namespace viking
 {
@@ -11,16 +16,28 @@ namespace viking
         class OpenGLGraphicsPipeline : public IGraphicsPipeline
         {
         public:
-			OpenGLGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths);
+			OpenGLGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths, const OpenGLCapabilities* capabilities, OpenGLStateCache* state);
 			void build();
-			void render();
+			// Adds a command for every attached pool and batch
+			void record(RenderQueue::Recorder* recorder);
+			void bind();
+			GLuint GetProgram();
 			virtual void attachModelPool(IModelPool* pool);
+			virtual void detachModelPool(IModelPool* pool);
+			virtual void setModelPools(const std::vector<IModelPool*>& pools);
+			virtual void attachMeshBatch(IMeshBatch* batch);
+			virtual void detachMeshBatch(IMeshBatch* batch);
 			virtual void attachVertexBinding(VertexBufferBase vertex);
 		private:
 			int GetGLShader(ShaderStage stage);
 			std::string getFile(const char* path);
+			// Adds the capability defines straight after the #version line
+			std::string addDefines(const std::string& code);
+			const OpenGLCapabilities* m_capabilities;
+			OpenGLStateCache* m_state;
 			GLuint program_id;
 			std::vector<OpenGLModelPool*> m_pools;
+			std::vector<OpenGLMeshBatch*> m_batches;
 			std::map<ShaderStage, GLuint> m_shaders;
 			std::vector<VertexBufferBase> m_vertex_bases;
         };
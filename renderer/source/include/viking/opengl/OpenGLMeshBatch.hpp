@@ -0,0 +1,119 @@
+#pragma once
+
+#include <viking/opengl/glad.h>
+#include <viking/IMeshBatch.hpp>
+#include <viking/RangeAllocator.hpp>
+#include <viking/opengl/OpenGLCapabilities.hpp>
+#include <viking/opengl/OpenGLStreamBuffer.hpp>
+#include <viking/opengl/OpenGLStateCache.hpp>
+#include <viking/opengl/OpenGLUniformBuffer.hpp>
+#include <viking/opengl/OpenGLTextureBuffer.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace opengl
+	{
+		// Every mesh lives in one vertex arena and one index arena that grow as needed.
+		// The visible meshes are drawn with a single glMultiDrawElementsIndirect, each command's base instance
+		// selecting the mesh's instance data. Without it a single glMultiDrawElementsBaseVertex is used, or one
+		// glDrawElementsBaseVertex per mesh when there is instance data, still without any buffer switches.
+		// Mesh data is written to the stream buffer and copied into the arenas on the GPU, so adding a mesh
+		// never waits for draws still reading the arenas.
+		// addMesh, removeMesh and setVisible make no GL calls: meshes are kept until prepare hands them to the next
+		// render, which grows the arenas and uploads them, so they can be used while render runs on another thread
+		class OpenGLMeshBatch : public IMeshBatch
+		{
+		public:
+			OpenGLMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance, const OpenGLCapabilities* capabilities, OpenGLStreamBuffer* stream, OpenGLStateCache* state);
+			~OpenGLMeshBatch();
+			virtual unsigned int addMesh(const void* vertices, unsigned int vertex_count, const uint16_t* indices, unsigned int index_count, const void* instance);
+			virtual void removeMesh(unsigned int mesh);
+			virtual void setVisible(const std::vector<unsigned int>& meshes);
+			virtual void attachBuffer(IUniformBuffer* buffer);
+			virtual void attachBuffer(ITextureBuffer* buffer);
+			// Builds the draw commands of the visible meshes and hands them and the meshes added since the last
+			// prepare to the next render
+			void prepare(bool copy);
+			void render();
+			virtual GLuint GetSortTexture();
+		private:
+			struct Mesh
+			{
+				unsigned int first_vertex;
+				unsigned int vertex_count;
+				unsigned int first_index;
+				unsigned int index_count;
+				bool used;
+			};
+
+			// Layout of the DrawElementsIndirectCommand read by glMultiDrawElementsIndirect
+			struct DrawCommand
+			{
+				GLuint count;
+				GLuint instance_count;
+				GLuint first_index;
+				GLint base_vertex;
+				GLuint base_instance;
+			};
+
+			// A copy into one of the arenas waiting for render, data is an offset into the staged bytes
+			struct StagedUpload
+			{
+				GLuint* buffer;
+				unsigned int offset;
+				unsigned int size;
+				size_t data;
+			};
+
+			// Finds room for count elements in an arena, growing it when it is full. The buffer follows in render
+			unsigned int Allocate(RangeAllocator& allocator, unsigned int count);
+			// Copies data for render to upload to buffer at offset
+			void Stage(GLuint* buffer, unsigned int offset, unsigned int size, const void* data);
+			// Grows buffer from capacity to at least required elements, capacity is updated
+			void Grow(GLuint& buffer, unsigned int& capacity, unsigned int required, unsigned int element_size);
+			// Moves the contents of buffer into a new buffer of new_size bytes and deletes the old one
+			GLuint Resize(GLuint buffer, unsigned int old_size, unsigned int new_size);
+			void Upload(GLuint buffer, unsigned int offset, unsigned int size, const void* data);
+			// Points the attributes at the bound array buffer, they are enabled once when the VAO is set up
+			void SetAttributes(VertexBufferBase* base, size_t offset);
+
+			const OpenGLCapabilities* m_capabilities;
+			OpenGLStreamBuffer* m_stream;
+			OpenGLStateCache* m_state;
+			GLuint vao;
+			GLuint m_vertex_buffer;
+			GLuint m_index_buffer;
+			GLuint m_instance_buffer;
+			RangeAllocator m_vertices;
+			RangeAllocator m_indices;
+			// The VAO still points at arena buffers that have since been resized
+			bool m_attributes_dirty;
+			// Elements the arena buffers hold, behind the allocators until render grows them
+			unsigned int m_vertex_capacity;
+			unsigned int m_index_capacity;
+			unsigned int m_instance_capacity;
+
+			std::vector<Mesh> m_meshes;
+			std::vector<unsigned int> m_free_meshes;
+			std::vector<unsigned int> m_visible;
+			std::vector<StagedUpload> m_staged;
+			std::vector<char> m_staged_data;
+
+			// Filled by prepare and read by render, the arena sizes the uploads and commands need
+			unsigned int m_frame_vertices;
+			unsigned int m_frame_indices;
+			unsigned int m_frame_instances;
+			std::vector<StagedUpload> m_uploads;
+			std::vector<char> m_upload_data;
+			std::vector<DrawCommand> m_commands;
+			std::vector<GLsizei> m_counts;
+			std::vector<const void*> m_offsets;
+			std::vector<GLint> m_base_vertices;
+
+			std::vector<OpenGLUniformBuffer*> m_buffers;
+			std::vector<OpenGLTextureBuffer*> m_textureBuffers;
+		};
+	}
+}
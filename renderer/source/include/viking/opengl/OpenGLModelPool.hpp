@@ -5,6 +5,9 @@
 #include <viking/opengl/OpenGLModel.hpp>
 #include <viking/opengl/OpenGLUniformBuffer.hpp>
 #include <viking/opengl/OpenGLTextureBuffer.hpp>
+#include <viking/opengl/OpenGLCapabilities.hpp>
+#include <viking/opengl/OpenGLStreamBuffer.hpp>
+#include <viking/opengl/OpenGLStateCache.hpp>
 
 namespace viking
 {
@@ -13,23 +16,60 @@ namespace viking
         class OpenGLModelPool : public IModelPool
         {
         public:
-			OpenGLModelPool(viking::VertexBufferBase* base, IBuffer* vertex_data, IBuffer* index_data);
+			OpenGLModelPool(viking::VertexBufferBase* base, IBuffer* vertex_data, IBuffer* index_data, const OpenGLCapabilities* capabilities, OpenGLStreamBuffer* stream, OpenGLStateCache* state);
 			GLuint GetVAO();
+			// Texture field of the pool's RenderQueue key, the first attached texture
+			GLuint GetSortTexture();
+			// Takes what the next render reads from the game's memory, the model count, instance data and indexed
+			// buffers, copying the data when copy is set
+			void prepare(bool copy);
 			void render(GLuint programID);
 			virtual IModel* createModel();
 			virtual void attachBuffer(unsigned int index, IUniformBuffer * buffer);
 			virtual void attachBuffer(IUniformBuffer * buffer);
 			virtual void attachBuffer(ITextureBuffer * buffer);
+			virtual void setBuffers(IBuffer* vertex_data, IBuffer* index_data);
+			virtual void setInstanceBuffer(viking::VertexBufferBase* instance, IBuffer* instance_data);
+			// GL enum for the component type of a VertexBinding
+			static GLenum GetGLType(VertexType type);
+			// Points an attribute at the currently bound array buffer, offset is added to the binding's own offset
+			static void SetAttribute(VertexBinding& binding, unsigned int stride, size_t offset);
 		private:
+			// GL side copy of an indexed buffer when it is read from a texture buffer
+			struct IndexedStorage
+			{
+				GLuint buffer;
+				GLuint texture;
+			};
+
+			// Data read by render, the game's memory itself or prepare's copy of it
+			struct FrameData
+			{
+				const char* data;
+				std::vector<char> copy;
+			};
+
+			static void SetFrameData(FrameData& frame, const void* data, size_t size, bool copy);
+			// Sends count elements of an indexed buffer starting at first and binds them for the next draw
+			void UploadIndexed(unsigned int index, OpenGLUniformBuffer* buffer, unsigned int first, unsigned int count);
 			unsigned int m_current_index;
 			viking::VertexBufferBase* m_base;
 			std::map<unsigned int, OpenGLModel*> m_models;
 			std::map<unsigned int, OpenGLUniformBuffer*> m_indexed_buffers;
+			std::map<unsigned int, IndexedStorage> m_instance_storage;
+			const OpenGLCapabilities* m_capabilities;
+			OpenGLStreamBuffer* m_stream;
+			OpenGLStateCache* m_state;
 			std::vector<OpenGLUniformBuffer*> m_buffers;
 			std::vector<OpenGLTextureBuffer*> m_textureBuffers;
 			GLuint vao;
 			GLuint vbo;
 			GLuint ibo;
+			viking::VertexBufferBase* m_instance_base = nullptr;
+			IBuffer* m_instance_data = nullptr;
+			unsigned int m_frame_models = 0;
+			FrameData m_frame_instance = {};
+			std::map<unsigned int, FrameData> m_frame_indexed;
         };
     }
 }
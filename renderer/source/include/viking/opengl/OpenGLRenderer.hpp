@@ -6,6 +6,10 @@
 #include <viking/IComputeProgram.hpp>
 #include <viking/opengl/OpenGLModelPool.hpp>
 #include <viking/opengl/OpenGLGraphicsPipeline.hpp>
+#include <viking/opengl/OpenGLMeshBatch.hpp>
+#include <viking/opengl/OpenGLCapabilities.hpp>
+#include <viking/opengl/OpenGLStreamBuffer.hpp>
+#include <viking/opengl/OpenGLStateCache.hpp>
 
 namespace viking
 {
@@ -14,16 +18,37 @@ namespace viking
         class OpenGLRenderer : public IRenderer
         {
         public:
+            virtual ~OpenGLRenderer();
             virtual void start();
 			virtual void render();
 			virtual IComputePipeline* createComputePipeline(const char* path, unsigned int x, unsigned int y, unsigned int z);
 			virtual IComputeProgram* createComputeProgram();
 			virtual IGraphicsPipeline* createGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths);
 			virtual IModelPool* createModelPool(VertexBufferBase* vertex, IBuffer* vertex_data, IBuffer*index_data);
+			virtual IMeshBatch* createMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance);
 			virtual IBuffer* createBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount);
 			virtual IUniformBuffer* createUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, ShaderStage shader_stage, unsigned int binding);
 			virtual ITextureBuffer* createTextureBuffer(void* dataPtr, unsigned int width, unsigned int height);
+			const OpenGLCapabilities& getCapabilities() const;
+			// What the last rendered frame sent to the GPU, as of the last submitFrame
+			const OpenGLUploadStats& getUploadStats() const;
+			// GL state calls the last rendered frame issued and skipped, as of the last submitFrame
+			const OpenGLStateStats& getStateStats() const;
+		protected:
+			virtual void prepareFrame(bool copy);
 		private:
+			OpenGLCapabilities m_capabilities;
+			// Every bind in the backend goes through here
+			OpenGLStateCache m_state;
+			// Every per frame upload goes through here, created in start once the capabilities are known
+			OpenGLStreamBuffer* m_stream = nullptr;
+			// Records the pools and batches attached to pipelines each frame
+			RenderQueue::Recorder* m_recorder = nullptr;
+			// The sorted draws of the frame packet, owned by m_queue until the next prepareFrame
+			const std::vector<RenderCommand>* m_commands = nullptr;
+			// Stats are only written by render, these copies are taken by prepareFrame so reading them never races it
+			OpenGLUploadStats m_upload_stats = {};
+			OpenGLStateStats m_state_stats = {};
 			std::vector<OpenGLGraphicsPipeline*> m_graphics_pipeline;
 			std::vector<OpenGLModelPool*> m_model_pool;
         };
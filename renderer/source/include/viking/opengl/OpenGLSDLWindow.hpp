@@ -12,6 +12,8 @@ namespace viking
         {
         public:
             OpenGLSDLWindow(WindowDescriptor descriptor);
+            virtual void makeContextCurrent();
+            virtual void releaseContext();
         };
     }
 }
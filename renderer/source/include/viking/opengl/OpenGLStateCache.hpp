@@ -0,0 +1,85 @@
+#pragma once
+
+#include <viking/opengl/glad.h>
+#include <viking/opengl/OpenGLCapabilities.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace opengl
+	{
+		// GL state calls in one frame
+		struct OpenGLStateStats
+		{
+			unsigned int issued = 0;
+			// Calls skipped because they would have set what was already set
+			unsigned int elided = 0;
+		};
+
+		// Shadow copy of the GL binding state, calls that would change nothing are skipped.
+		// Only works while every bind in the backend goes through it, state changed behind its back
+		// has to be followed by invalidate.
+		// GL_ELEMENT_ARRAY_BUFFER belongs to the bound vertex array, so it and any other target the cache
+		// does not know are always passed on
+		class OpenGLStateCache
+		{
+		public:
+			OpenGLStateCache();
+			void useProgram(GLuint program);
+			void bindVertexArray(GLuint vao);
+			void bindBuffer(GLenum target, GLuint buffer);
+			// Also binds the buffer to the generic target, as glBindBufferRange does
+			void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+			// Leaves unit as the active texture unit, also when the texture was already bound there
+			void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+			// Deleting an object unbinds it, so the cache has to forget it before the name can be reused
+			void deleteBuffers(GLsizei count, const GLuint* buffers);
+			void deleteVertexArrays(GLsizei count, const GLuint* arrays);
+			void deleteTextures(GLsizei count, const GLuint* textures);
+
+			// Forgets everything, the next call of each kind is always issued
+			void invalidate();
+
+			// Counters for the frame being recorded, and for the last one nextFrame finished
+			const OpenGLStateStats& getStats() const;
+			const OpenGLStateStats& getLastFrameStats() const;
+			void nextFrame();
+		private:
+			struct BufferRange
+			{
+				GLuint buffer;
+				GLintptr offset;
+				GLsizeiptr size;
+			};
+
+			struct TextureUnit
+			{
+				GLuint texture_2d;
+				GLuint texture_buffer;
+			};
+
+			// Slot in m_buffers for a target, -1 for targets that are not cached
+			static int BufferSlot(GLenum target);
+			// Range bindings of an indexed target, nullptr when it is not cached
+			std::vector<BufferRange>* Ranges(GLenum target);
+			// Binding of target in unit, nullptr when the target is not cached
+			GLuint* Texture(GLuint unit, GLenum target);
+
+			// Names are never ~0u, so it marks a binding the cache does not know
+			static const GLuint UNKNOWN = ~0u;
+			static const int BUFFER_SLOTS = 7;
+
+			GLuint m_program;
+			GLuint m_vao;
+			GLuint m_buffers[BUFFER_SLOTS];
+			std::vector<BufferRange> m_uniform_ranges;
+			std::vector<BufferRange> m_storage_ranges;
+			GLuint m_active_unit;
+			std::vector<TextureUnit> m_textures;
+			OpenGLStateStats m_stats;
+			OpenGLStateStats m_last_stats;
+		};
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <viking/opengl/glad.h>
+#include <viking/opengl/OpenGLCapabilities.hpp>
+#include <viking/opengl/OpenGLStateCache.hpp>
+
+#include <vector>
+
+namespace viking
+{
+	namespace opengl
+	{
+		// Bytes sent to the GPU in one frame
+		struct OpenGLUploadStats
+		{
+			// Everything written to the stream buffer, including the uniform ranges
+			unsigned int stream_bytes = 0;
+			// Changed ranges of uniform buffers, buffers nobody called setData on add nothing
+			unsigned int uniform_bytes = 0;
+			unsigned int uniform_ranges = 0;
+		};
+
+		// One buffer for everything sent to the GPU every frame, split into a region per frame in flight.
+		// With buffer storage it stays persistently mapped and writes are plain copies, a fence at the end of
+		// each frame keeps a region from being written again while the GPU may still read it.
+		// On GL 3.3 there is a single region that is orphaned with glBufferData(NULL) every frame instead
+		class OpenGLStreamBuffer
+		{
+		public:
+			OpenGLStreamBuffer(const OpenGLCapabilities* capabilities, OpenGLStateCache* state, unsigned int region_size = 4 << 20, unsigned int regions = 3);
+			~OpenGLStreamBuffer();
+			// Copies size bytes into this frame's region and returns where they start in getBuffer().
+			// A full region is replaced by a larger buffer, so getBuffer() has to be read right after writing,
+			// the buffer it returns then stays valid until the end of the frame
+			GLintptr write(const void* data, unsigned int size, unsigned int alignment = 4);
+			GLuint getBuffer() const;
+			// Counts frames, offsets written in an earlier frame must not be used again
+			unsigned int getFrame() const;
+			// Call once every command of the frame reading the buffer has been issued
+			void nextFrame();
+			bool isPersistent() const;
+			// Counters for the frame being recorded, and for the last one nextFrame finished
+			OpenGLUploadStats& getStats();
+			const OpenGLUploadStats& getLastFrameStats() const;
+		private:
+			void Create(unsigned int region_size);
+			// Unmaps the buffer and keeps it around until nextFrame, draws issued this frame may still read it
+			void Retire();
+
+			const OpenGLCapabilities* m_capabilities;
+			OpenGLStateCache* m_state;
+			GLuint m_buffer;
+			char* m_mapped;
+			unsigned int m_region_size;
+			unsigned int m_regions;
+			unsigned int m_region;
+			unsigned int m_offset;
+			unsigned int m_frame;
+			std::vector<GLsync> m_fences;
+			// Buffers replaced by a larger one this frame, deleted once the frame is over
+			std::vector<GLuint> m_retired;
+			OpenGLUploadStats m_stats;
+			OpenGLUploadStats m_last_stats;
+		};
+	}
+}
@@ -3,6 +3,7 @@
 #include <viking/opengl/glad.h>
 #include <viking/ITextureBuffer.hpp>
 #include <viking/opengl/OpenGLBuffer.hpp>
+#include <viking/opengl/OpenGLStateCache.hpp>
 
 namespace viking
 {
@@ -11,7 +12,7 @@ namespace viking
         class OpenGLTextureBuffer : public virtual ITextureBuffer , public virtual OpenGLBuffer
         {
         public:
-			OpenGLTextureBuffer(void* dataPtr, unsigned int width, unsigned int height);
+			OpenGLTextureBuffer(void* dataPtr, unsigned int width, unsigned int height, OpenGLStateCache* state);
 			GLuint GetId();
 		private:
 			GLuint m_texutre_id;
@@ -2,6 +2,10 @@
 
 #include <viking/opengl/glad.h>
 #include <viking/IUniformBuffer.hpp>
+#include <viking/opengl/OpenGLStreamBuffer.hpp>
+
+#include <map>
+#include <vector>
 
 namespace viking
 {
@@ -10,8 +14,15 @@ namespace viking
         class OpenGLUniformBuffer : public IUniformBuffer
         {
         public:
-			OpenGLUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, unsigned int binding);
-			GLuint getUBO();
+			OpenGLUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, unsigned int binding, OpenGLStateCache* state);
+			~OpenGLUniformBuffer();
+			// Hands the elements changed since the last prepare to the next bind, copying them out of the game's memory
+			// when copy is set
+			void prepare(bool copy);
+			// Uploads the elements handed over by prepare through the stream and binds the buffer,
+			// a buffer with nothing changed is only bound
+			void bind(OpenGLStreamBuffer* stream, const OpenGLCapabilities* capabilities);
+			// These only record which elements changed, the upload happens in bind
 			virtual void setData();
 			virtual void setData(unsigned int count);
 			virtual void setData(unsigned int startIndex, unsigned int count);
@@ -19,7 +30,14 @@ namespace viking
 			void* getDataPtr(unsigned int startIndex);
 
 		private:
+			OpenGLStateCache* m_state;
 			GLuint ubo = 0;
+			// Changed elements not prepared yet, start of each range to its end
+			std::map<unsigned int, unsigned int> m_dirty;
+			// Changed elements the next bind uploads, read from m_copy when m_copied is set
+			std::map<unsigned int, unsigned int> m_frame;
+			std::vector<char> m_copy;
+			bool m_copied = false;
         };
     }
 }
@@ -25,12 +25,15 @@ namespace viking { namespace vulkan
 		virtual IComputeProgram* createComputeProgram();
 		virtual IGraphicsPipeline* createGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths);
 		virtual IModelPool* createModelPool(VertexBufferBase* vertex, IBuffer* vertex_data, IBuffer*index_data);
+		virtual IMeshBatch* createMeshBatch(VertexBufferBase* vertex, VertexBufferBase* instance);
 		virtual IBuffer* createBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount);
 		virtual IUniformBuffer* createUniformBuffer(void* dataPtr, unsigned int indexSize, unsigned int elementCount, ShaderStage shader_stage, unsigned int binding);
 		virtual ITextureBuffer* createTextureBuffer(void* dataPtr, unsigned int width, unsigned int height);
 		VulkanPhysicalDevice* GetPhysicalDevice();
 		VulkanDevice* GetDevice();
 		IVulkanSurface* GetSurface();
+	protected:
+		virtual void prepareFrame(bool copy);
     private:
         void setupVulkan();
         VulkanInstance * m_instance;
@@ -0,0 +1,196 @@
+#include <viking/FrameProfiler.hpp>
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace viking;
+
+namespace
+{
+	const float BUCKET_MS = 0.05f;
+	// One more bucket holds everything over 100ms
+	const unsigned int BUCKET_COUNT = 2000;
+}
+
+viking::FrameProfiler::FrameProfiler(unsigned int window) : m_frame(window),
+	m_phases(static_cast<int>(FramePhase::COUNT), Series(window))
+{
+	for (int i = 0; i < static_cast<int>(FramePhase::COUNT); i++)
+	{
+		m_phase_ticks[i] = 0;
+		m_phase_start[i] = 0;
+	}
+}
+
+void viking::FrameProfiler::nextFrame()
+{
+	const uint64_t now = GetTicks();
+	if (m_frame_start != 0)
+	{
+		m_frame.add(TicksToMilliseconds(now - m_frame_start));
+		for (int i = 0; i < static_cast<int>(FramePhase::COUNT); i++)
+		{
+			m_phases[i].add(TicksToMilliseconds(m_phase_ticks[i].exchange(0)));
+		}
+	}
+	else
+	{
+		for (int i = 0; i < static_cast<int>(FramePhase::COUNT); i++)
+		{
+			m_phase_ticks[i] = 0;
+		}
+		m_last_log = now;
+	}
+	m_frame_start = now;
+
+	if (m_log_interval != 0 && now - m_last_log >= m_log_interval)
+	{
+		log(std::cout);
+		m_last_log = now;
+	}
+}
+
+void viking::FrameProfiler::beginPhase(FramePhase phase)
+{
+	m_phase_start[static_cast<int>(phase)] = GetTicks();
+}
+
+void viking::FrameProfiler::endPhase(FramePhase phase)
+{
+	addPhaseTime(phase, GetTicks() - m_phase_start[static_cast<int>(phase)]);
+}
+
+void viking::FrameProfiler::addPhaseTime(FramePhase phase, uint64_t ticks)
+{
+	m_phase_ticks[static_cast<int>(phase)] += ticks;
+}
+
+FrameTimeStats viking::FrameProfiler::getFrameStats() const
+{
+	return m_frame.getStats();
+}
+
+FrameTimeStats viking::FrameProfiler::getPhaseStats(FramePhase phase) const
+{
+	return m_phases[static_cast<int>(phase)].getStats();
+}
+
+void viking::FrameProfiler::setLogInterval(float seconds)
+{
+	m_log_interval = static_cast<uint64_t>(seconds * SDL_GetPerformanceFrequency());
+	m_last_log = GetTicks();
+}
+
+void viking::FrameProfiler::log(std::ostream & out) const
+{
+	const FrameTimeStats frame = m_frame.getStats();
+	out << std::fixed << std::setprecision(2) << "frame ms p50 " << frame.p50 << " p95 " << frame.p95 << " p99 " << frame.p99
+		<< " max " << frame.max << " over " << frame.frames << " frames";
+	if (frame.average > 0.0f)
+	{
+		out << " (" << std::setprecision(0) << 1000.0f / frame.average << " fps)" << std::setprecision(2);
+	}
+	// Phases as p50/p99
+	for (int i = 0; i < static_cast<int>(FramePhase::COUNT); i++)
+	{
+		const FrameTimeStats phase = m_phases[i].getStats();
+		out << ", " << GetPhaseName(static_cast<FramePhase>(i)) << " " << phase.p50 << "/" << phase.p99;
+	}
+	out << std::defaultfloat << "\n";
+}
+
+uint64_t viking::FrameProfiler::GetTicks()
+{
+	return SDL_GetPerformanceCounter();
+}
+
+float viking::FrameProfiler::TicksToMilliseconds(uint64_t ticks)
+{
+	return static_cast<float>(ticks * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+const char * viking::FrameProfiler::GetPhaseName(FramePhase phase)
+{
+	switch (phase)
+	{
+	case FramePhase::UPDATE:
+		return "update";
+	case FramePhase::CULL:
+		return "cull";
+	case FramePhase::SUBMIT:
+		return "submit";
+	case FramePhase::SWAP:
+		return "swap";
+	default:
+		return "unknown";
+	}
+}
+
+viking::FrameProfiler::Series::Series(unsigned int window) : m_samples(std::max(window, 1u)), m_buckets(BUCKET_COUNT + 1)
+{
+}
+
+void viking::FrameProfiler::Series::add(float ms)
+{
+	if (m_count == m_samples.size())
+	{
+		// The oldest frame leaves the window
+		const float oldest = m_samples[m_next];
+		m_buckets[GetBucket(oldest)]--;
+		m_total -= oldest;
+	}
+	else
+	{
+		m_count++;
+	}
+
+	m_samples[m_next] = ms;
+	m_buckets[GetBucket(ms)]++;
+	m_total += ms;
+	m_next = (m_next + 1) % m_samples.size();
+}
+
+FrameTimeStats viking::FrameProfiler::Series::getStats() const
+{
+	FrameTimeStats stats = {};
+	if (m_count == 0)
+	{
+		return stats;
+	}
+
+	for (unsigned int i = 0; i < m_count; i++)
+	{
+		stats.max = std::max(stats.max, m_samples[i]);
+	}
+	stats.p50 = GetPercentile(0.50f, stats.max);
+	stats.p95 = GetPercentile(0.95f, stats.max);
+	stats.p99 = GetPercentile(0.99f, stats.max);
+	stats.average = static_cast<float>(m_total / m_count);
+	stats.frames = m_count;
+	return stats;
+}
+
+unsigned int viking::FrameProfiler::Series::GetBucket(float ms) const
+{
+	return std::min(static_cast<unsigned int>(std::max(ms, 0.0f) / BUCKET_MS), BUCKET_COUNT);
+}
+
+float viking::FrameProfiler::Series::GetPercentile(float percentile, float max) const
+{
+	// The first bucket that takes the count past the percentile, reported as its upper edge
+	const unsigned int rank = std::max(static_cast<unsigned int>(std::ceil(percentile * m_count)), 1u);
+	unsigned int seen = 0;
+	for (unsigned int i = 0; i < BUCKET_COUNT; i++)
+	{
+		seen += m_buckets[i];
+		if (seen >= rank)
+		{
+			return std::min((i + 1) * BUCKET_MS, max);
+		}
+	}
+	return max;
+}
@@ -1,9 +1,18 @@
 #include <viking/IGraphicsPipeline.hpp>
 #include <viking/VertexBufferBase.hpp>
 
+#include <atomic>
+
 using namespace viking;
 
 viking::IGraphicsPipeline::IGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths) :
 	m_shader_paths(shader_paths)
 {
+	static std::atomic<unsigned int> next_sort_id(0);
+	m_sort_id = next_sort_id++;
+}
+
+unsigned int viking::IGraphicsPipeline::getSortId() const
+{
+	return m_sort_id;
 }
@@ -8,6 +8,8 @@
 	#include <viking/opengl/OpenGLRenderer.hpp>
 #endif
 
+#include <viking/null/NullRenderer.hpp>
+
 using namespace viking;
 
 IRenderer* IRenderer::createRenderer(const RenderingAPI& api)
@@ -24,12 +26,130 @@ IRenderer* IRenderer::createRenderer(const RenderingAPI& api)
 			case RenderingAPI::Vulkan:
 				return new vulkan::VulkanRenderer();
 		#endif
+
+		case RenderingAPI::Null:
+			return new null::NullRenderer();
 	}
 
 	return nullptr;
 }
 
+IRenderer::~IRenderer()
+{
+	stopRenderThread();
+}
+
 void IRenderer::addWindow(IWindow* window)
 {
 	m_window = window;
 }
+
+RenderQueue* IRenderer::getRenderQueue()
+{
+	return &m_queue;
+}
+
+void IRenderer::submitFrame()
+{
+	const uint64_t start = FrameProfiler::GetTicks();
+	if (!m_render_thread.joinable())
+	{
+		prepareFrame(false);
+		render();
+		AddPhaseTime(FramePhase::SUBMIT, start);
+		if (m_window != nullptr)
+		{
+			SwapBuffers();
+		}
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_frame_mutex);
+	m_frame_done.wait(lock, [this] { return !m_frame_pending; });
+	prepareFrame(true);
+	m_frame_pending = true;
+	m_frame_ready.notify_one();
+	AddPhaseTime(FramePhase::SUBMIT, start);
+}
+
+bool IRenderer::startRenderThread()
+{
+	if (m_window == nullptr || m_render_thread.joinable())
+	{
+		return false;
+	}
+
+	m_window->releaseContext();
+	m_frame_pending = false;
+	m_stop_render_thread = false;
+	m_render_thread = std::thread(&IRenderer::RenderThread, this);
+	return true;
+}
+
+void IRenderer::stopRenderThread()
+{
+	if (!m_render_thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_frame_mutex);
+		m_stop_render_thread = true;
+	}
+	m_frame_ready.notify_one();
+	m_render_thread.join();
+	m_window->makeContextCurrent();
+}
+
+bool IRenderer::isRenderThreadRunning()
+{
+	return m_render_thread.joinable();
+}
+
+void IRenderer::setFrameProfiler(FrameProfiler* profiler)
+{
+	m_profiler = profiler;
+}
+
+void IRenderer::RenderThread()
+{
+	m_window->makeContextCurrent();
+
+	std::unique_lock<std::mutex> lock(m_frame_mutex);
+	while (true)
+	{
+		// A frame submitted before stopping is still drawn
+		m_frame_ready.wait(lock, [this] { return m_frame_pending || m_stop_render_thread; });
+		if (!m_frame_pending)
+		{
+			break;
+		}
+
+		lock.unlock();
+		render();
+		SwapBuffers();
+		lock.lock();
+
+		m_frame_pending = false;
+		m_frame_done.notify_one();
+	}
+
+	m_window->releaseContext();
+}
+
+void IRenderer::SwapBuffers()
+{
+	const uint64_t start = FrameProfiler::GetTicks();
+	m_window->swapBuffers();
+	AddPhaseTime(FramePhase::SWAP, start);
+}
+
+void IRenderer::AddPhaseTime(FramePhase phase, uint64_t start)
+{
+	FrameProfiler* profiler = m_profiler;
+	if (profiler != nullptr)
+	{
+		profiler->addPhaseTime(phase, FrameProfiler::GetTicks() - start);
+	}
+}
@@ -1,8 +1,32 @@
 #include <viking/IUniformBuffer.hpp>
 #include <viking/IRenderer.hpp>
 
+#include <iterator>
+
 #ifdef VIKING_SUPPORTS_VULKAN
 	#include <viking/vulkan/VulkanRenderer.hpp>
 #endif
 
 using namespace viking;
+
+void viking::IUniformBuffer::AddRange(std::map<unsigned int, unsigned int>& ranges, unsigned int start, unsigned int end)
+{
+	// Swallow the range before this one if it reaches start, then every range starting up to end
+	auto it = ranges.upper_bound(start);
+	if (it != ranges.begin())
+	{
+		auto previous = std::prev(it);
+		if (previous->second >= start)
+		{
+			start = previous->first;
+			end = previous->second > end ? previous->second : end;
+			it = ranges.erase(previous);
+		}
+	}
+	while (it != ranges.end() && it->first <= end)
+	{
+		end = it->second > end ? it->second : end;
+		it = ranges.erase(it);
+	}
+	ranges[start] = end;
+}
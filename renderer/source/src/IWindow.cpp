@@ -1,5 +1,6 @@
 #include <viking/IWindow.hpp>
 #include <viking/SDLWindow.hpp>
+#include <viking/null/NullWindow.hpp>
 
 using namespace viking;
 
@@ -10,6 +11,8 @@ IWindow * viking::IWindow::createWindow(WindowDescriptor descriptor, WindowingAP
 	case WindowingAPI::SDL:
 		return SDLWindow::createWindow(descriptor,renderingApi);
 		break;
+	case WindowingAPI::Null:
+		return new null::NullWindow(descriptor);
 	}
 	return nullptr;
 }
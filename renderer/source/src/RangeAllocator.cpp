@@ -0,0 +1,81 @@
+#include <viking/RangeAllocator.hpp>
+
+using namespace viking;
+
+viking::RangeAllocator::RangeAllocator(unsigned int capacity) : m_capacity(0), m_used(0)
+{
+	grow(capacity);
+}
+
+bool viking::RangeAllocator::allocate(unsigned int count, unsigned int & offset)
+{
+	for (auto range = m_free.begin(); range != m_free.end(); range++)
+	{
+		if (range->second < count)
+		{
+			continue;
+		}
+
+		offset = range->first;
+		const unsigned int remaining = range->second - count;
+		m_free.erase(range);
+		if (remaining > 0)
+		{
+			m_free[offset + count] = remaining;
+		}
+		m_used += count;
+		return true;
+	}
+	return false;
+}
+
+void viking::RangeAllocator::free(unsigned int offset, unsigned int count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	m_used -= count;
+
+	auto next = m_free.lower_bound(offset);
+	if (next != m_free.end() && offset + count == next->first)
+	{
+		count += next->second;
+		next = m_free.erase(next);
+	}
+	if (next != m_free.begin())
+	{
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += count;
+			return;
+		}
+	}
+	m_free[offset] = count;
+}
+
+void viking::RangeAllocator::grow(unsigned int capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+	const unsigned int added = capacity - m_capacity;
+	const unsigned int offset = m_capacity;
+	m_capacity = capacity;
+
+	// Treated as a range being freed so it joins a free range at the old end
+	m_used += added;
+	free(offset, added);
+}
+
+unsigned int viking::RangeAllocator::getCapacity() const
+{
+	return m_capacity;
+}
+
+unsigned int viking::RangeAllocator::getUsed() const
+{
+	return m_used;
+}
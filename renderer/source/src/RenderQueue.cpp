@@ -0,0 +1,118 @@
+#include <viking/RenderQueue.hpp>
+
+#include <cstring>
+#include <utility>
+
+using namespace viking;
+
+void viking::RenderQueue::Recorder::draw(uint64_t key, IGraphicsPipeline * pipeline, IModelPool * pool)
+{
+	m_commands.push_back({key, pipeline, pool, RenderCommandType::MODEL_POOL});
+}
+
+void viking::RenderQueue::Recorder::draw(uint64_t key, IGraphicsPipeline * pipeline, IMeshBatch * batch)
+{
+	m_commands.push_back({key, pipeline, batch, RenderCommandType::MESH_BATCH});
+}
+
+uint64_t viking::RenderQueue::MakeKey(unsigned int pass, unsigned int pipeline, unsigned int texture, unsigned int depth)
+{
+	uint64_t key = pass & ((1u << PASS_BITS) - 1);
+	key = (key << PIPELINE_BITS) | (pipeline & ((1u << PIPELINE_BITS) - 1));
+	key = (key << TEXTURE_BITS) | (texture & ((1u << TEXTURE_BITS) - 1));
+	key = (key << DEPTH_BITS) | (depth & ((1u << DEPTH_BITS) - 1));
+	return key;
+}
+
+unsigned int viking::RenderQueue::DepthBucket(float distance, float max_distance)
+{
+	const unsigned int buckets = (1u << DEPTH_BITS) - 1;
+	if (!(distance > 0.0f) || max_distance <= 0.0f)
+	{
+		return 0;
+	}
+	if (distance >= max_distance)
+	{
+		return buckets;
+	}
+	return (unsigned int)(distance / max_distance * buckets);
+}
+
+RenderQueue::Recorder * viking::RenderQueue::createRecorder()
+{
+	std::lock_guard<std::mutex> lock(m_recorders_mutex);
+	m_recorders.emplace_back(new Recorder());
+	return m_recorders.back().get();
+}
+
+const std::vector<RenderCommand>& viking::RenderQueue::sort()
+{
+	m_commands.clear();
+	for (auto& recorder : m_recorders)
+	{
+		m_commands.insert(m_commands.end(), recorder->m_commands.begin(), recorder->m_commands.end());
+		recorder->m_commands.clear();
+	}
+	RadixSort();
+	return m_commands;
+}
+
+void viking::RenderQueue::clear()
+{
+	for (auto& recorder : m_recorders)
+	{
+		recorder->m_commands.clear();
+	}
+	m_commands.clear();
+}
+
+void viking::RenderQueue::RadixSort()
+{
+	const size_t count = m_commands.size();
+	if (count < 2)
+	{
+		return;
+	}
+	m_scratch.resize(count);
+
+	// All eight histograms in one pass over the keys
+	size_t histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+	for (const RenderCommand& command : m_commands)
+	{
+		for (int digit = 0; digit < 8; digit++)
+		{
+			histograms[digit][(command.key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+
+	RenderCommand* source = m_commands.data();
+	RenderCommand* destination = m_scratch.data();
+	for (int digit = 0; digit < 8; digit++)
+	{
+		size_t* histogram = histograms[digit];
+		// Every key has the same byte here, the pass would not move anything
+		if (histogram[(source[0].key >> (digit * 8)) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			const size_t bucket_count = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucket_count;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			destination[histogram[(source[i].key >> (digit * 8)) & 0xFF]++] = source[i];
+		}
+		std::swap(source, destination);
+	}
+
+	if (source != m_commands.data())
+	{
+		m_commands.swap(m_scratch);
+	}
+}
@@ -31,6 +31,10 @@ SDLWindow * viking::SDLWindow::createWindow(WindowDescriptor descriptor, Renderi
 		case RenderingAPI::GL11:
 			return new opengl::OpenGLSDLWindow(descriptor);
 	#endif
+
+		// Headless runs use a NullWindow, not an SDL window
+		case RenderingAPI::Null:
+			return nullptr;
 	}
 
 	return nullptr;
@@ -45,12 +49,8 @@ void SDLWindow::poll()
 			m_running = false;
 	}
 }
-#include <iostream>
 void SDLWindow::swapBuffers()
 {
-	float current_tick = SDL_GetTicks();
-	std::cout << (int)(1000 / (current_tick - m_last_tick)) << " FPS"<<std::endl; 
-	m_last_tick = current_tick;
 	SDL_GL_SwapWindow(m_window);
 }
 
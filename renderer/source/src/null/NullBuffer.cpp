@@ -0,0 +1,12 @@
+#include <viking/null/NullBuffer.hpp>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullBuffer::NullBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount)
+{
+	m_dataPtr = dataPtr;
+	m_indexSize = indexSize;
+	m_elementCount = elementCount;
+	m_bufferSize = indexSize * elementCount;
+}
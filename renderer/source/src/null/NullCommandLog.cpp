@@ -0,0 +1,107 @@
+#include <viking/null/NullCommandLog.hpp>
+
+using namespace viking::null;
+
+unsigned int viking::null::NullCommandLog::createObject()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return ++m_objects;
+}
+
+void viking::null::NullCommandLog::record(NullCommandType type, unsigned int object, unsigned int count, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_frame.push_back({type, object, count, bytes});
+
+	m_frame_stats.commands++;
+	switch (type)
+	{
+	case NullCommandType::CREATE:
+	case NullCommandType::SET_BUFFERS:
+	case NullCommandType::ADD_MESH:
+	case NullCommandType::UPLOAD_UNIFORM:
+	case NullCommandType::UPLOAD_INSTANCES:
+		m_frame_stats.upload_bytes += bytes;
+		break;
+	case NullCommandType::BIND_PIPELINE:
+		m_frame_stats.pipeline_binds++;
+		break;
+	case NullCommandType::DRAW_POOL:
+	case NullCommandType::DRAW_BATCH:
+		m_frame_stats.draw_calls++;
+		m_frame_stats.instances += count;
+		break;
+	default:
+		break;
+	}
+}
+
+void viking::null::NullCommandLog::nextFrame()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_last_frame.swap(m_frame);
+	m_frame.clear();
+	m_last_frame_stats = m_frame_stats;
+	m_frame_stats = {};
+	m_frames++;
+}
+
+unsigned int viking::null::NullCommandLog::getFrameCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_frames;
+}
+
+std::vector<NullCommand> viking::null::NullCommandLog::getLastFrame() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_last_frame;
+}
+
+NullFrameStats viking::null::NullCommandLog::getLastFrameStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_last_frame_stats;
+}
+
+void viking::null::NullCommandLog::dumpLastFrame(std::ostream & out) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	out << "frame " << m_frames << ": " << m_last_frame_stats.commands << " commands, " << m_last_frame_stats.draw_calls << " draw calls, "
+		<< m_last_frame_stats.instances << " instances, " << m_last_frame_stats.pipeline_binds << " pipeline binds, "
+		<< m_last_frame_stats.upload_bytes << " bytes uploaded\n";
+	for (const NullCommand& command : m_last_frame)
+	{
+		out << "  " << GetTypeName(command.type) << " object " << command.object << " count " << command.count << " bytes " << command.bytes << "\n";
+	}
+}
+
+const char * viking::null::NullCommandLog::GetTypeName(NullCommandType type)
+{
+	switch (type)
+	{
+	case NullCommandType::CREATE:
+		return "CREATE";
+	case NullCommandType::BUILD:
+		return "BUILD";
+	case NullCommandType::SET_BUFFERS:
+		return "SET_BUFFERS";
+	case NullCommandType::ADD_MESH:
+		return "ADD_MESH";
+	case NullCommandType::REMOVE_MESH:
+		return "REMOVE_MESH";
+	case NullCommandType::UPLOAD_UNIFORM:
+		return "UPLOAD_UNIFORM";
+	case NullCommandType::UPLOAD_INSTANCES:
+		return "UPLOAD_INSTANCES";
+	case NullCommandType::BIND_PIPELINE:
+		return "BIND_PIPELINE";
+	case NullCommandType::DRAW_POOL:
+		return "DRAW_POOL";
+	case NullCommandType::DRAW_BATCH:
+		return "DRAW_BATCH";
+	case NullCommandType::DISPATCH:
+		return "DISPATCH";
+	}
+	return "UNKNOWN";
+}
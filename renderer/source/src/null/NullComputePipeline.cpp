@@ -0,0 +1,19 @@
+#include <viking/null/NullComputePipeline.hpp>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullComputePipeline::NullComputePipeline(const char * path, unsigned int x, unsigned int y, unsigned int z, NullCommandLog * log, unsigned int object) :
+	IComputePipeline(path, x, y, z), m_log(log), m_object(object)
+{
+}
+
+void viking::null::NullComputePipeline::attachBuffer(IUniformBuffer * buffer)
+{
+	m_buffers.push_back(buffer);
+}
+
+void viking::null::NullComputePipeline::build()
+{
+	m_log->record(NullCommandType::BUILD, m_object, 1);
+}
@@ -0,0 +1,22 @@
+#include <viking/null/NullComputeProgram.hpp>
+#include <viking/IComputePipeline.hpp>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullComputeProgram::NullComputeProgram(NullCommandLog * log, unsigned int object) : m_log(log), m_object(object)
+{
+}
+
+void viking::null::NullComputeProgram::build()
+{
+	m_log->record(NullCommandType::BUILD, m_object, static_cast<unsigned int>(m_pipelines.size()));
+}
+
+void viking::null::NullComputeProgram::run()
+{
+	for (auto pipeline : m_pipelines)
+	{
+		m_log->record(NullCommandType::DISPATCH, m_object, pipeline->getX() * pipeline->getY() * pipeline->getZ());
+	}
+}
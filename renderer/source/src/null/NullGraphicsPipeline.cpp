@@ -0,0 +1,67 @@
+#include <viking/null/NullGraphicsPipeline.hpp>
+
+#include <algorithm>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullGraphicsPipeline::NullGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths, NullCommandLog * log, unsigned int object) :
+	IGraphicsPipeline(shader_paths), m_log(log), m_object(object)
+{
+}
+
+void viking::null::NullGraphicsPipeline::build()
+{
+	m_log->record(NullCommandType::BUILD, m_object, static_cast<unsigned int>(m_shader_paths.size()));
+}
+
+void viking::null::NullGraphicsPipeline::record(RenderQueue::Recorder * recorder)
+{
+	for (auto pool : m_pools)
+	{
+		recorder->draw(RenderQueue::MakeKey(0, m_sort_id, pool->GetSortTexture(), 0), this, pool);
+	}
+	for (auto batch : m_batches)
+	{
+		recorder->draw(RenderQueue::MakeKey(0, m_sort_id, batch->GetSortTexture(), 0), this, batch);
+	}
+}
+
+void viking::null::NullGraphicsPipeline::bind()
+{
+	m_log->record(NullCommandType::BIND_PIPELINE, m_object);
+}
+
+void viking::null::NullGraphicsPipeline::attachModelPool(IModelPool * pool)
+{
+	m_pools.push_back(static_cast<NullModelPool*>(pool));
+}
+
+void viking::null::NullGraphicsPipeline::detachModelPool(IModelPool * pool)
+{
+	m_pools.erase(std::remove(m_pools.begin(), m_pools.end(), static_cast<NullModelPool*>(pool)), m_pools.end());
+}
+
+void viking::null::NullGraphicsPipeline::setModelPools(const std::vector<IModelPool*>& pools)
+{
+	m_pools.clear();
+	for (auto pool : pools)
+	{
+		m_pools.push_back(static_cast<NullModelPool*>(pool));
+	}
+}
+
+void viking::null::NullGraphicsPipeline::attachMeshBatch(IMeshBatch * batch)
+{
+	m_batches.push_back(static_cast<NullMeshBatch*>(batch));
+}
+
+void viking::null::NullGraphicsPipeline::detachMeshBatch(IMeshBatch * batch)
+{
+	m_batches.erase(std::remove(m_batches.begin(), m_batches.end(), static_cast<NullMeshBatch*>(batch)), m_batches.end());
+}
+
+void viking::null::NullGraphicsPipeline::attachVertexBinding(VertexBufferBase vertex)
+{
+	m_vertex_bases.push_back(vertex);
+}
@@ -0,0 +1,129 @@
+#include <viking/null/NullMeshBatch.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace viking::null;
+using namespace viking;
+
+// Size of the DrawElementsIndirectCommand the OpenGL batch writes for every mesh it draws
+static const size_t INDIRECT_COMMAND_SIZE = 5 * sizeof(uint32_t);
+
+viking::null::NullMeshBatch::NullMeshBatch(VertexBufferBase * vertex, VertexBufferBase * instance, NullCommandLog * log, unsigned int object) :
+	IMeshBatch(vertex, instance), m_log(log), m_object(object)
+{
+}
+
+unsigned int viking::null::NullMeshBatch::addMesh(const void * vertices, unsigned int vertex_count, const uint16_t * indices, unsigned int index_count, const void * instance)
+{
+	unsigned int id;
+	if (m_free_meshes.empty())
+	{
+		id = static_cast<unsigned int>(m_meshes.size());
+		m_meshes.push_back(Mesh());
+	}
+	else
+	{
+		id = m_free_meshes.back();
+		m_free_meshes.pop_back();
+	}
+
+	Mesh& mesh = m_meshes[id];
+	mesh.vertex_count = vertex_count;
+	mesh.index_count = index_count;
+	mesh.first_vertex = Allocate(m_vertices, m_vertex_data, m_vertex->size, vertex_count);
+	mesh.first_index = Allocate(m_indices, m_index_data, sizeof(uint16_t), index_count);
+	mesh.used = true;
+
+	size_t bytes = (size_t)vertex_count * m_vertex->size + (size_t)index_count * sizeof(uint16_t);
+	memcpy(m_vertex_data.data() + (size_t)mesh.first_vertex * m_vertex->size, vertices, (size_t)vertex_count * m_vertex->size);
+	memcpy(m_index_data.data() + (size_t)mesh.first_index * sizeof(uint16_t), indices, (size_t)index_count * sizeof(uint16_t));
+	if (m_instance != nullptr)
+	{
+		if (m_instance_data.size() < m_meshes.size() * m_instance->size)
+		{
+			m_instance_data.resize(m_meshes.size() * m_instance->size);
+		}
+		memcpy(m_instance_data.data() + (size_t)id * m_instance->size, instance, m_instance->size);
+		bytes += m_instance->size;
+	}
+
+	m_log->record(NullCommandType::ADD_MESH, m_object, index_count, bytes);
+	return id;
+}
+
+void viking::null::NullMeshBatch::removeMesh(unsigned int mesh)
+{
+	Mesh& removed = m_meshes[mesh];
+	m_vertices.free(removed.first_vertex, removed.vertex_count);
+	m_indices.free(removed.first_index, removed.index_count);
+	removed.used = false;
+	m_free_meshes.push_back(mesh);
+
+	m_log->record(NullCommandType::REMOVE_MESH, m_object, removed.index_count);
+}
+
+void viking::null::NullMeshBatch::setVisible(const std::vector<unsigned int>& meshes)
+{
+	m_visible = meshes;
+}
+
+void viking::null::NullMeshBatch::attachBuffer(IUniformBuffer * buffer)
+{
+	m_buffers.push_back(dynamic_cast<NullUniformBuffer*>(buffer));
+}
+
+void viking::null::NullMeshBatch::attachBuffer(ITextureBuffer * buffer)
+{
+	m_textureBuffers.push_back(dynamic_cast<NullTextureBuffer*>(buffer));
+}
+
+unsigned int viking::null::NullMeshBatch::GetSortTexture()
+{
+	return m_textureBuffers.empty() ? 0 : m_textureBuffers.front()->GetObject();
+}
+
+void viking::null::NullMeshBatch::prepare()
+{
+	// Meshes removed since setVisible are skipped, as the OpenGL batch does
+	m_frame_meshes = 0;
+	for (unsigned int id : m_visible)
+	{
+		const Mesh& mesh = m_meshes[id];
+		if (mesh.used && mesh.index_count > 0)
+		{
+			m_frame_meshes++;
+		}
+	}
+
+	for (auto buffer : m_buffers)
+	{
+		buffer->prepare();
+	}
+}
+
+void viking::null::NullMeshBatch::render()
+{
+	if (m_frame_meshes == 0)
+	{
+		return;
+	}
+	for (auto buffer : m_buffers)
+	{
+		buffer->bind();
+	}
+	m_log->record(NullCommandType::DRAW_BATCH, m_object, m_frame_meshes, m_frame_meshes * INDIRECT_COMMAND_SIZE);
+}
+
+unsigned int viking::null::NullMeshBatch::Allocate(RangeAllocator & allocator, std::vector<char>& arena, unsigned int element_size, unsigned int count)
+{
+	unsigned int offset = 0;
+	if (!allocator.allocate(count, offset))
+	{
+		const unsigned int old_capacity = allocator.getCapacity();
+		allocator.grow(std::max(old_capacity * 2, old_capacity + count));
+		allocator.allocate(count, offset);
+		arena.resize((size_t)allocator.getCapacity() * element_size);
+	}
+	return offset;
+}
@@ -0,0 +1,106 @@
+#include <viking/null/NullModelPool.hpp>
+
+#include <cstring>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullModelPool::NullModelPool(VertexBufferBase * base, IBuffer * vertex_data, IBuffer * index_data, NullCommandLog * log, unsigned int object) :
+	IModelPool(base, vertex_data, index_data), m_log(log), m_object(object)
+{
+	m_vertices.assign((char*)vertex_data->getPtr(), (char*)vertex_data->getPtr() + vertex_data->getBufferSize());
+	m_indices.assign((char*)index_data->getPtr(), (char*)index_data->getPtr() + index_data->getBufferSize());
+}
+
+viking::null::NullModelPool::~NullModelPool()
+{
+	for (auto model : m_models)
+	{
+		delete model.second;
+	}
+}
+
+unsigned int viking::null::NullModelPool::GetSortTexture()
+{
+	return m_textureBuffers.empty() ? 0 : m_textureBuffers.front()->GetObject();
+}
+
+void viking::null::NullModelPool::prepare()
+{
+	m_frame_models = static_cast<unsigned int>(m_models.size());
+
+	m_instances.clear();
+	if (m_instance_base != nullptr)
+	{
+		m_instances.insert(m_instances.end(), (char*)m_instance_data->getPtr(), (char*)m_instance_data->getPtr() + m_instance_data->getBufferSize());
+	}
+	for (auto buffer : m_indexed_buffers)
+	{
+		const char* data = (char*)buffer.second->getPtr();
+		m_instances.insert(m_instances.end(), data, data + (size_t)m_frame_models * buffer.second->getIndexSize());
+	}
+
+	for (auto buffer : m_buffers)
+	{
+		buffer->prepare();
+	}
+}
+
+void viking::null::NullModelPool::render()
+{
+	for (auto buffer : m_buffers)
+	{
+		buffer->bind();
+	}
+	if (!m_instances.empty())
+	{
+		m_log->record(NullCommandType::UPLOAD_INSTANCES, m_object, m_frame_models, m_instances.size());
+	}
+	if (m_frame_models > 0)
+	{
+		m_log->record(NullCommandType::DRAW_POOL, m_object, m_frame_models);
+	}
+}
+
+IModel * viking::null::NullModelPool::createModel()
+{
+	const unsigned int index = static_cast<unsigned int>(m_models.size());
+	IModel* model = new IModel(index);
+	m_models[index] = model;
+
+	for (auto buffer : m_indexed_buffers)
+	{
+		model->SetDataPointer(buffer.first, (char*)buffer.second->getPtr() + buffer.second->getIndexSize() * index);
+	}
+	return model;
+}
+
+void viking::null::NullModelPool::attachBuffer(unsigned int index, IUniformBuffer * buffer)
+{
+	m_indexed_buffers[index] = buffer;
+}
+
+void viking::null::NullModelPool::attachBuffer(IUniformBuffer * buffer)
+{
+	m_buffers.push_back(dynamic_cast<NullUniformBuffer*>(buffer));
+}
+
+void viking::null::NullModelPool::attachBuffer(ITextureBuffer * buffer)
+{
+	m_textureBuffers.push_back(dynamic_cast<NullTextureBuffer*>(buffer));
+}
+
+void viking::null::NullModelPool::setBuffers(IBuffer * vertex_data, IBuffer * index_data)
+{
+	m_vertex_data = vertex_data;
+	m_index_data = index_data;
+	m_vertices.assign((char*)vertex_data->getPtr(), (char*)vertex_data->getPtr() + vertex_data->getBufferSize());
+	m_indices.assign((char*)index_data->getPtr(), (char*)index_data->getPtr() + index_data->getBufferSize());
+	m_log->record(NullCommandType::SET_BUFFERS, m_object, 0, m_vertices.size() + m_indices.size());
+}
+
+void viking::null::NullModelPool::setInstanceBuffer(VertexBufferBase * instance, IBuffer * instance_data)
+{
+	m_instance_base = instance;
+	m_instance_data = instance_data;
+}
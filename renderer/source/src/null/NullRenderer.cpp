@@ -0,0 +1,148 @@
+#include <viking/null/NullRenderer.hpp>
+#include <viking/null/NullBuffer.hpp>
+#include <viking/null/NullUniformBuffer.hpp>
+#include <viking/null/NullTextureBuffer.hpp>
+#include <viking/null/NullModelPool.hpp>
+#include <viking/null/NullMeshBatch.hpp>
+#include <viking/null/NullComputePipeline.hpp>
+#include <viking/null/NullComputeProgram.hpp>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullRenderer::NullRenderer()
+{
+	m_recorder = m_queue.createRecorder();
+}
+
+viking::null::NullRenderer::~NullRenderer()
+{
+	stopRenderThread();
+}
+
+void viking::null::NullRenderer::start()
+{
+}
+
+void viking::null::NullRenderer::prepareFrame(bool /*copy*/)
+{
+	for (auto pipeline : m_graphics_pipeline)
+	{
+		pipeline->record(m_recorder);
+	}
+
+	m_commands = &m_queue.sort();
+	for (const RenderCommand& command : *m_commands)
+	{
+		switch (command.type)
+		{
+		case RenderCommandType::MODEL_POOL:
+			static_cast<NullModelPool*>(static_cast<IModelPool*>(command.drawable))->prepare();
+			break;
+		case RenderCommandType::MESH_BATCH:
+			static_cast<NullMeshBatch*>(static_cast<IMeshBatch*>(command.drawable))->prepare();
+			break;
+		}
+	}
+}
+
+void viking::null::NullRenderer::render()
+{
+	if (m_commands != nullptr)
+	{
+		NullGraphicsPipeline* bound = nullptr;
+		for (const RenderCommand& command : *m_commands)
+		{
+			NullGraphicsPipeline* pipeline = static_cast<NullGraphicsPipeline*>(command.pipeline);
+			if (pipeline != bound)
+			{
+				pipeline->bind();
+				bound = pipeline;
+			}
+
+			switch (command.type)
+			{
+			case RenderCommandType::MODEL_POOL:
+				static_cast<NullModelPool*>(static_cast<IModelPool*>(command.drawable))->render();
+				break;
+			case RenderCommandType::MESH_BATCH:
+				static_cast<NullMeshBatch*>(static_cast<IMeshBatch*>(command.drawable))->render();
+				break;
+			}
+		}
+	}
+
+	m_log.nextFrame();
+}
+
+IComputePipeline * viking::null::NullRenderer::createComputePipeline(const char * path, unsigned int x, unsigned int y, unsigned int z)
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object);
+	return new NullComputePipeline(path, x, y, z, &m_log, object);
+}
+
+IComputeProgram * viking::null::NullRenderer::createComputeProgram()
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object);
+	return new NullComputeProgram(&m_log, object);
+}
+
+IGraphicsPipeline * viking::null::NullRenderer::createGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths)
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object);
+	NullGraphicsPipeline* pipeline = new NullGraphicsPipeline(shader_paths, &m_log, object);
+	m_graphics_pipeline.push_back(pipeline);
+	return pipeline;
+}
+
+IModelPool * viking::null::NullRenderer::createModelPool(VertexBufferBase * vertex, IBuffer * vertex_data, IBuffer * index_data)
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object, 0, vertex_data->getBufferSize() + index_data->getBufferSize());
+	return new NullModelPool(vertex, vertex_data, index_data, &m_log, object);
+}
+
+IMeshBatch * viking::null::NullRenderer::createMeshBatch(VertexBufferBase * vertex, VertexBufferBase * instance)
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object);
+	return new NullMeshBatch(vertex, instance, &m_log, object);
+}
+
+IBuffer * viking::null::NullRenderer::createBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount)
+{
+	m_log.record(NullCommandType::CREATE, m_log.createObject());
+	return new NullBuffer(dataPtr, indexSize, elementCount);
+}
+
+IUniformBuffer * viking::null::NullRenderer::createUniformBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount, ShaderStage /*shader_stage*/, unsigned int binding)
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object);
+	return new NullUniformBuffer(dataPtr, indexSize, elementCount, binding, &m_log, object);
+}
+
+ITextureBuffer * viking::null::NullRenderer::createTextureBuffer(void * dataPtr, unsigned int width, unsigned int height)
+{
+	const unsigned int object = m_log.createObject();
+	m_log.record(NullCommandType::CREATE, object, 0, (size_t)width * height * 3);
+	return new NullTextureBuffer(dataPtr, width, height, object);
+}
+
+const NullCommandLog & viking::null::NullRenderer::getCommandLog() const
+{
+	return m_log;
+}
+
+NullFrameStats viking::null::NullRenderer::getLastFrameStats() const
+{
+	return m_log.getLastFrameStats();
+}
+
+void viking::null::NullRenderer::dumpLastFrame(std::ostream & out) const
+{
+	m_log.dumpLastFrame(out);
+}
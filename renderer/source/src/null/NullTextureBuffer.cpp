@@ -0,0 +1,19 @@
+#include <viking/null/NullTextureBuffer.hpp>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullTextureBuffer::NullTextureBuffer(void * dataPtr, unsigned int width, unsigned int height, unsigned int object) :
+	m_object(object)
+{
+	m_dataPtr = dataPtr;
+	m_indexSize = 3;
+	m_elementCount = width * height;
+	m_bufferSize = m_indexSize * m_elementCount;
+	m_pixels.assign((char*)dataPtr, (char*)dataPtr + m_bufferSize);
+}
+
+unsigned int viking::null::NullTextureBuffer::GetObject()
+{
+	return m_object;
+}
@@ -0,0 +1,61 @@
+#include <viking/null/NullUniformBuffer.hpp>
+
+#include <cstring>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullUniformBuffer::NullUniformBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount, unsigned int binding, NullCommandLog * log, unsigned int object) :
+	IDescriptor(DescriptorType::UNIFORM, ShaderStage::VERTEX_SHADER, binding), m_log(log), m_object(object)
+{
+	m_dataPtr = dataPtr;
+	m_bufferSize = indexSize * elementCount;
+	m_indexSize = indexSize;
+	m_elementCount = elementCount;
+	m_storage.resize(m_bufferSize);
+}
+
+void viking::null::NullUniformBuffer::prepare()
+{
+	// The first bind fills the whole buffer
+	if (!m_prepared)
+	{
+		setData();
+		m_prepared = true;
+	}
+
+	for (auto range : m_dirty)
+	{
+		memcpy(m_storage.data() + range.first * m_indexSize, (char*)m_dataPtr + range.first * m_indexSize, (range.second - range.first) * m_indexSize);
+		AddRange(m_frame, range.first, range.second);
+	}
+	m_dirty.clear();
+}
+
+void viking::null::NullUniformBuffer::bind()
+{
+	for (auto range : m_frame)
+	{
+		m_log->record(NullCommandType::UPLOAD_UNIFORM, m_object, range.second - range.first, (range.second - range.first) * m_indexSize);
+	}
+	m_frame.clear();
+}
+
+void viking::null::NullUniformBuffer::setData()
+{
+	setData(0, m_elementCount);
+}
+
+void viking::null::NullUniformBuffer::setData(unsigned int count)
+{
+	setData(0, count);
+}
+
+void viking::null::NullUniformBuffer::setData(unsigned int startIndex, unsigned int count)
+{
+	const unsigned int end = startIndex + count < m_elementCount ? startIndex + count : m_elementCount;
+	if (startIndex < end)
+	{
+		AddRange(m_dirty, startIndex, end);
+	}
+}
@@ -0,0 +1,49 @@
+#include <viking/null/NullWindow.hpp>
+
+using namespace viking::null;
+using namespace viking;
+
+viking::null::NullWindow::NullWindow(WindowDescriptor descriptor) : IWindow(WindowingAPI::Null),
+	m_width(descriptor.width), m_height(descriptor.height), m_running(true), m_frames(0), m_frame_limit(0)
+{
+}
+
+void viking::null::NullWindow::poll()
+{
+}
+
+void viking::null::NullWindow::swapBuffers()
+{
+	const unsigned int frames = ++m_frames;
+	const unsigned int frame_limit = m_frame_limit;
+	if (frame_limit != 0 && frames >= frame_limit)
+	{
+		m_running = false;
+	}
+}
+
+bool viking::null::NullWindow::isRunning()
+{
+	return m_running;
+}
+
+void viking::null::NullWindow::GetSize(int & width, int & height)
+{
+	width = m_width;
+	height = m_height;
+}
+
+void viking::null::NullWindow::setFrameLimit(unsigned int frame_limit)
+{
+	m_frame_limit = frame_limit;
+}
+
+void viking::null::NullWindow::close()
+{
+	m_running = false;
+}
+
+unsigned int viking::null::NullWindow::getFrameCount()
+{
+	return m_frames;
+}
@@ -0,0 +1,101 @@
+#include <viking/opengl/OpenGLCapabilities.hpp>
+
+#include <cstring>
+
+using namespace viking::opengl;
+using namespace viking;
+
+void viking::opengl::OpenGLCapabilities::query(GLADloadproc load)
+{
+	glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+	glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+
+	texture_buffer = hasVersion(3, 1);
+	shader_storage_buffer = hasVersion(4, 3) || hasExtension("GL_ARB_shader_storage_buffer_object");
+	multi_draw_indirect = hasVersion(4, 3) || (hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance"));
+
+	if (multi_draw_indirect)
+	{
+		MultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+		multi_draw_indirect = MultiDrawElementsIndirect != nullptr;
+	}
+
+	buffer_storage = hasVersion(4, 4) || hasExtension("GL_ARB_buffer_storage");
+	if (buffer_storage)
+	{
+		BufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+		buffer_storage = BufferStorage != nullptr;
+	}
+
+	glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &max_uniform_block_size);
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer_alignment);
+	if (texture_buffer)
+	{
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texture_buffer_size);
+	}
+	if (shader_storage_buffer)
+	{
+		glGetIntegerv(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &max_shader_storage_block_size);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &shader_storage_alignment);
+	}
+
+	if (shader_storage_buffer)
+	{
+		instance_storage = InstanceStorage::SHADER_STORAGE_BUFFER;
+	}
+	else if (texture_buffer)
+	{
+		instance_storage = InstanceStorage::TEXTURE_BUFFER;
+	}
+	else
+	{
+		instance_storage = InstanceStorage::UNIFORM_BUFFER;
+	}
+}
+
+bool viking::opengl::OpenGLCapabilities::hasVersion(int major, int minor) const
+{
+	return major_version > major || (major_version == major && minor_version >= minor);
+}
+
+bool viking::opengl::OpenGLCapabilities::hasExtension(const char * name) const
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != nullptr && strcmp(extension, name) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int viking::opengl::OpenGLCapabilities::getMaxInstances(unsigned int index_size) const
+{
+	switch (instance_storage)
+	{
+	case InstanceStorage::SHADER_STORAGE_BUFFER:
+		return (unsigned int)max_shader_storage_block_size / index_size;
+	case InstanceStorage::TEXTURE_BUFFER:
+		// Every element takes whole RGBA32F texels
+		return (unsigned int)max_texture_buffer_size / ((index_size + 15) / 16);
+	default:
+		return (unsigned int)max_uniform_block_size / index_size;
+	}
+}
+
+const char * viking::opengl::OpenGLCapabilities::getShaderDefines() const
+{
+	switch (instance_storage)
+	{
+	case InstanceStorage::SHADER_STORAGE_BUFFER:
+		return "#extension GL_ARB_shader_storage_buffer_object : enable\n#define VIKING_INSTANCE_SSBO 1\n";
+	case InstanceStorage::TEXTURE_BUFFER:
+		return "#define VIKING_INSTANCE_TBO 1\n";
+	default:
+		return "#define VIKING_INSTANCE_UBO 1\n";
+	}
+}
@@ -3,13 +3,14 @@
 #include <viking/opengl/glad.h>
 #include <fstream>
 #include <string>
+#include <algorithm>
 
 
 using namespace viking::opengl;
 using namespace viking;
 
-viking::opengl::OpenGLGraphicsPipeline::OpenGLGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths)
-	: IGraphicsPipeline(shader_paths)
+viking::opengl::OpenGLGraphicsPipeline::OpenGLGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths, const OpenGLCapabilities* capabilities, OpenGLStateCache* state)
+	: IGraphicsPipeline(shader_paths), m_capabilities(capabilities), m_state(state)
 {
 	
 }
@@ -21,7 +22,7 @@ void viking::opengl::OpenGLGraphicsPipeline::build()
 	for (auto it = m_shader_paths.begin();it!= m_shader_paths.end(); it++)
 	{
 		m_shaders[it->first] = glCreateShader(GetGLShader(it->first));
-		std::string codeString = getFile(it->second);
+		std::string codeString = addDefines(getFile(it->second));
 		char const * code = codeString.c_str();
 
 		glShaderSource(m_shaders[it->first], 1, &code, NULL);
@@ -66,13 +67,26 @@ void viking::opengl::OpenGLGraphicsPipeline::build()
 
 }
 
-void viking::opengl::OpenGLGraphicsPipeline::render()
+void viking::opengl::OpenGLGraphicsPipeline::record(RenderQueue::Recorder * recorder)
 {
-	glUseProgram(program_id);
 	for (auto pool : m_pools)
 	{
-		pool->render(program_id);
+		recorder->draw(RenderQueue::MakeKey(0, m_sort_id, pool->GetSortTexture(), 0), this, pool);
 	}
+	for (auto batch : m_batches)
+	{
+		recorder->draw(RenderQueue::MakeKey(0, m_sort_id, batch->GetSortTexture(), 0), this, batch);
+	}
+}
+
+void viking::opengl::OpenGLGraphicsPipeline::bind()
+{
+	m_state->useProgram(program_id);
+}
+
+GLuint viking::opengl::OpenGLGraphicsPipeline::GetProgram()
+{
+	return program_id;
 }
 
 void viking::opengl::OpenGLGraphicsPipeline::attachModelPool(IModelPool * pool)
@@ -80,6 +94,30 @@ void viking::opengl::OpenGLGraphicsPipeline::attachModelPool(IModelPool * pool)
 	m_pools.push_back(static_cast<OpenGLModelPool*>(pool));
 }
 
+void viking::opengl::OpenGLGraphicsPipeline::detachModelPool(IModelPool * pool)
+{
+	m_pools.erase(std::remove(m_pools.begin(), m_pools.end(), static_cast<OpenGLModelPool*>(pool)), m_pools.end());
+}
+
+void viking::opengl::OpenGLGraphicsPipeline::setModelPools(const std::vector<IModelPool*>& pools)
+{
+	m_pools.resize(pools.size());
+	for (size_t i = 0; i < pools.size(); i++)
+	{
+		m_pools[i] = static_cast<OpenGLModelPool*>(pools[i]);
+	}
+}
+
+void viking::opengl::OpenGLGraphicsPipeline::attachMeshBatch(IMeshBatch * batch)
+{
+	m_batches.push_back(static_cast<OpenGLMeshBatch*>(batch));
+}
+
+void viking::opengl::OpenGLGraphicsPipeline::detachMeshBatch(IMeshBatch * batch)
+{
+	m_batches.erase(std::remove(m_batches.begin(), m_batches.end(), static_cast<OpenGLMeshBatch*>(batch)), m_batches.end());
+}
+
 void viking::opengl::OpenGLGraphicsPipeline::attachVertexBinding(VertexBufferBase vertex)
 {
 	m_vertex_bases.push_back(vertex);
@@ -120,3 +158,18 @@ std::string viking::opengl::OpenGLGraphicsPipeline::getFile(const char * path)
 	}
 	return finalLine;
 }
+
+std::string viking::opengl::OpenGLGraphicsPipeline::addDefines(const std::string & code)
+{
+	size_t version = code.find("#version");
+	if (version == std::string::npos)
+	{
+		return m_capabilities->getShaderDefines() + code;
+	}
+	size_t line_end = code.find('\n', version);
+	if (line_end == std::string::npos)
+	{
+		return code + "\n" + m_capabilities->getShaderDefines();
+	}
+	return code.substr(0, line_end + 1) + m_capabilities->getShaderDefines() + code.substr(line_end + 1);
+}
@@ -0,0 +1,301 @@
+#include <viking/opengl/OpenGLMeshBatch.hpp>
+#include <viking/opengl/OpenGLModelPool.hpp>
+
+#include <algorithm>
+
+using namespace viking::opengl;
+using namespace viking;
+
+// Starting sizes of the arenas, in elements, they double whenever they run out of room
+static const unsigned int INITIAL_VERTICES = 1 << 16;
+static const unsigned int INITIAL_INDICES = 1 << 17;
+static const unsigned int INITIAL_INSTANCES = 256;
+
+viking::opengl::OpenGLMeshBatch::OpenGLMeshBatch(VertexBufferBase * vertex, VertexBufferBase * instance, const OpenGLCapabilities * capabilities, OpenGLStreamBuffer * stream, OpenGLStateCache * state) :
+	IMeshBatch(vertex, instance), m_capabilities(capabilities), m_stream(stream), m_state(state), m_instance_buffer(0), m_attributes_dirty(true),
+	m_vertex_capacity(0), m_index_capacity(0), m_instance_capacity(0), m_frame_vertices(0), m_frame_indices(0), m_frame_instances(0)
+{
+	glGenVertexArrays(1, &vao);
+
+	m_vertex_buffer = 0;
+	m_index_buffer = 0;
+	Grow(m_vertex_buffer, m_vertex_capacity, INITIAL_VERTICES, m_vertex->size);
+	m_vertices.grow(INITIAL_VERTICES);
+	Grow(m_index_buffer, m_index_capacity, INITIAL_INDICES, sizeof(uint16_t));
+	m_indices.grow(INITIAL_INDICES);
+
+	if (m_instance != nullptr)
+	{
+		Grow(m_instance_buffer, m_instance_capacity, INITIAL_INSTANCES, m_instance->size);
+	}
+}
+
+viking::opengl::OpenGLMeshBatch::~OpenGLMeshBatch()
+{
+	m_state->deleteBuffers(1, &m_vertex_buffer);
+	m_state->deleteBuffers(1, &m_index_buffer);
+	if (m_instance_buffer != 0)
+	{
+		m_state->deleteBuffers(1, &m_instance_buffer);
+	}
+	m_state->deleteVertexArrays(1, &vao);
+}
+
+unsigned int viking::opengl::OpenGLMeshBatch::addMesh(const void * vertices, unsigned int vertex_count, const uint16_t * indices, unsigned int index_count, const void * instance)
+{
+	unsigned int id;
+	if (m_free_meshes.empty())
+	{
+		id = static_cast<unsigned int>(m_meshes.size());
+		m_meshes.push_back(Mesh());
+	}
+	else
+	{
+		id = m_free_meshes.back();
+		m_free_meshes.pop_back();
+	}
+
+	Mesh& mesh = m_meshes[id];
+	mesh.vertex_count = vertex_count;
+	mesh.index_count = index_count;
+	mesh.first_vertex = Allocate(m_vertices, vertex_count);
+	mesh.first_index = Allocate(m_indices, index_count);
+	mesh.used = true;
+
+	Stage(&m_vertex_buffer, mesh.first_vertex * m_vertex->size, vertex_count * m_vertex->size, vertices);
+	Stage(&m_index_buffer, mesh.first_index * sizeof(uint16_t), index_count * sizeof(uint16_t), indices);
+	if (m_instance != nullptr)
+	{
+		Stage(&m_instance_buffer, id * m_instance->size, m_instance->size, instance);
+	}
+	return id;
+}
+
+void viking::opengl::OpenGLMeshBatch::removeMesh(unsigned int mesh)
+{
+	Mesh& removed = m_meshes[mesh];
+	m_vertices.free(removed.first_vertex, removed.vertex_count);
+	m_indices.free(removed.first_index, removed.index_count);
+	removed.used = false;
+	m_free_meshes.push_back(mesh);
+}
+
+void viking::opengl::OpenGLMeshBatch::setVisible(const std::vector<unsigned int>& meshes)
+{
+	m_visible = meshes;
+}
+
+void viking::opengl::OpenGLMeshBatch::attachBuffer(IUniformBuffer * buffer)
+{
+	m_buffers.push_back(dynamic_cast<OpenGLUniformBuffer*>(buffer));
+}
+
+void viking::opengl::OpenGLMeshBatch::attachBuffer(ITextureBuffer * buffer)
+{
+	m_textureBuffers.push_back(dynamic_cast<OpenGLTextureBuffer*>(buffer));
+}
+
+GLuint viking::opengl::OpenGLMeshBatch::GetSortTexture()
+{
+	return m_textureBuffers.empty() ? 0 : m_textureBuffers.front()->GetId();
+}
+
+void viking::opengl::OpenGLMeshBatch::prepare(bool copy)
+{
+	// Meshes removed since setVisible are skipped, their ranges may already hold another mesh
+	m_commands.clear();
+	for (unsigned int id : m_visible)
+	{
+		const Mesh& mesh = m_meshes[id];
+		if (mesh.used && mesh.index_count > 0)
+		{
+			m_commands.push_back({mesh.index_count, 1, mesh.first_index, (GLint)mesh.first_vertex, id});
+		}
+	}
+
+	m_frame_vertices = m_vertices.getCapacity();
+	m_frame_indices = m_indices.getCapacity();
+	m_frame_instances = static_cast<unsigned int>(m_meshes.size());
+
+	// Uploads are only left over when render was not called since the last prepare
+	if (m_uploads.empty())
+	{
+		m_uploads.swap(m_staged);
+		m_upload_data.swap(m_staged_data);
+	}
+	else
+	{
+		const size_t base = m_upload_data.size();
+		for (StagedUpload upload : m_staged)
+		{
+			upload.data += base;
+			m_uploads.push_back(upload);
+		}
+		m_upload_data.insert(m_upload_data.end(), m_staged_data.begin(), m_staged_data.end());
+	}
+	m_staged.clear();
+	m_staged_data.clear();
+
+	for (auto buffer : m_buffers)
+	{
+		buffer->prepare(copy);
+	}
+}
+
+void viking::opengl::OpenGLMeshBatch::render()
+{
+	Grow(m_vertex_buffer, m_vertex_capacity, m_frame_vertices, m_vertex->size);
+	Grow(m_index_buffer, m_index_capacity, m_frame_indices, sizeof(uint16_t));
+	if (m_instance != nullptr)
+	{
+		Grow(m_instance_buffer, m_instance_capacity, m_frame_instances, m_instance->size);
+	}
+
+	for (const StagedUpload& upload : m_uploads)
+	{
+		Upload(*upload.buffer, upload.offset, upload.size, m_upload_data.data() + upload.data);
+	}
+	m_uploads.clear();
+	m_upload_data.clear();
+
+	if (m_commands.empty())
+	{
+		return;
+	}
+
+	// The arenas only move when they grow, so the VAO is usually already set up
+	m_state->bindVertexArray(vao);
+	if (m_attributes_dirty)
+	{
+		m_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
+		m_state->bindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+		for (auto b : m_vertex->vertex_bindings)
+		{
+			glEnableVertexAttribArray(b.GetLocation());
+		}
+		SetAttributes(m_vertex, 0);
+
+		if (m_instance != nullptr)
+		{
+			m_state->bindBuffer(GL_ARRAY_BUFFER, m_instance_buffer);
+			for (auto b : m_instance->vertex_bindings)
+			{
+				glEnableVertexAttribArray(b.GetLocation());
+				glVertexAttribDivisor(b.GetLocation(), 1);
+			}
+			SetAttributes(m_instance, 0);
+		}
+		m_attributes_dirty = false;
+	}
+
+	for (auto buffer : m_buffers)
+	{
+		buffer->bind(m_stream, m_capabilities);
+	}
+
+	for (auto tex_buffer : m_textureBuffers)
+	{
+		m_state->bindTexture(0, GL_TEXTURE_2D, tex_buffer->GetId());
+	}
+
+	if (m_capabilities->multi_draw_indirect)
+	{
+		const GLintptr offset = m_stream->write(m_commands.data(), (unsigned int)(m_commands.size() * sizeof(DrawCommand)));
+		m_state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_stream->getBuffer());
+		m_capabilities->MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (const void*)offset, (GLsizei)m_commands.size(), 0);
+	}
+	else if (m_instance == nullptr)
+	{
+		m_counts.clear();
+		m_offsets.clear();
+		m_base_vertices.clear();
+		for (const DrawCommand& command : m_commands)
+		{
+			m_counts.push_back(command.count);
+			m_offsets.push_back((const void*)(command.first_index * sizeof(uint16_t)));
+			m_base_vertices.push_back(command.base_vertex);
+		}
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_counts.data(), GL_UNSIGNED_SHORT, m_offsets.data(), (GLsizei)m_commands.size(), m_base_vertices.data());
+	}
+	else
+	{
+		// Without a base instance the instance attributes are pointed at each mesh in turn
+		m_state->bindBuffer(GL_ARRAY_BUFFER, m_instance_buffer);
+		for (const DrawCommand& command : m_commands)
+		{
+			SetAttributes(m_instance, (size_t)command.base_instance * m_instance->size);
+			glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_SHORT, (const void*)(command.first_index * sizeof(uint16_t)), command.base_vertex);
+		}
+	}
+}
+
+unsigned int viking::opengl::OpenGLMeshBatch::Allocate(RangeAllocator & allocator, unsigned int count)
+{
+	unsigned int offset = 0;
+	if (!allocator.allocate(count, offset))
+	{
+		const unsigned int old_capacity = allocator.getCapacity();
+		allocator.grow(std::max(old_capacity * 2, old_capacity + count));
+		allocator.allocate(count, offset);
+	}
+	return offset;
+}
+
+void viking::opengl::OpenGLMeshBatch::Stage(GLuint * buffer, unsigned int offset, unsigned int size, const void * data)
+{
+	if (size == 0)
+	{
+		return;
+	}
+	m_staged.push_back({buffer, offset, size, m_staged_data.size()});
+	m_staged_data.insert(m_staged_data.end(), (const char*)data, (const char*)data + size);
+}
+
+void viking::opengl::OpenGLMeshBatch::Grow(GLuint & buffer, unsigned int & capacity, unsigned int required, unsigned int element_size)
+{
+	if (required <= capacity)
+	{
+		return;
+	}
+	const unsigned int grown = std::max(capacity * 2, required);
+	buffer = Resize(buffer, capacity * element_size, grown * element_size);
+	capacity = grown;
+}
+
+GLuint viking::opengl::OpenGLMeshBatch::Resize(GLuint buffer, unsigned int old_size, unsigned int new_size)
+{
+	// The copy targets leave the VAO's element buffer and the array buffer binding alone
+	GLuint resized;
+	glGenBuffers(1, &resized);
+	m_state->bindBuffer(GL_COPY_WRITE_BUFFER, resized);
+	glBufferData(GL_COPY_WRITE_BUFFER, new_size, nullptr, GL_STATIC_DRAW);
+
+	if (buffer != 0)
+	{
+		m_state->bindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_size);
+		m_state->deleteBuffers(1, &buffer);
+	}
+	m_attributes_dirty = true;
+	return resized;
+}
+
+void viking::opengl::OpenGLMeshBatch::Upload(GLuint buffer, unsigned int offset, unsigned int size, const void * data)
+{
+	if (size == 0)
+	{
+		return;
+	}
+	const GLintptr source = m_stream->write(data, size);
+	m_state->bindBuffer(GL_COPY_READ_BUFFER, m_stream->getBuffer());
+	m_state->bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source, offset, size);
+}
+
+void viking::opengl::OpenGLMeshBatch::SetAttributes(VertexBufferBase * base, size_t offset)
+{
+	for (auto b : base->vertex_bindings)
+	{
+		OpenGLModelPool::SetAttribute(b, base->size, offset);
+	}
+}
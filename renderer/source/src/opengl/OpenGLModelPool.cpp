@@ -3,102 +3,205 @@
 #include <viking/opengl/OpenGLUniformBuffer.hpp>
 #include <viking/opengl/glad.h>
 
+#include <cstring>
+
 using namespace viking::opengl;
 using namespace viking;
 
-viking::opengl::OpenGLModelPool::OpenGLModelPool(viking::VertexBufferBase* base, IBuffer * vertex_data, IBuffer * index_data) :
+viking::opengl::OpenGLModelPool::OpenGLModelPool(viking::VertexBufferBase* base, IBuffer * vertex_data, IBuffer * index_data, const OpenGLCapabilities* capabilities, OpenGLStreamBuffer* stream, OpenGLStateCache* state) :
 	IModelPool(base, vertex_data, index_data)
 {
 	m_current_index = 0;
 	m_base = base;
+	m_capabilities = capabilities;
+	m_stream = stream;
+	m_state = state;
 
 	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	m_state->bindVertexArray(vao);
 
 	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	m_state->bindBuffer(GL_ARRAY_BUFFER, vbo);
 	glBufferData(GL_ARRAY_BUFFER, vertex_data->getBufferSize(), vertex_data->getPtr(), GL_STATIC_DRAW);
-	
+
+	// Attribute pointers and enables are part of the VAO, so they are only set once
+	for (auto b : m_base->vertex_bindings)
+	{
+		glEnableVertexAttribArray(b.GetLocation());
+		SetAttribute(b, m_base->size, 0);
+	}
 
 	glGenBuffers(1, &ibo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	m_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_data->getBufferSize(), index_data->getPtr(), GL_STATIC_DRAW);
 }
 
+GLenum viking::opengl::OpenGLModelPool::GetGLType(VertexType type)
+{
+	switch (type)
+	{
+	case VertexType::HALF_FLOAT:
+		return GL_HALF_FLOAT;
+	case VertexType::BYTE:
+		return GL_BYTE;
+	case VertexType::UNSIGNED_BYTE:
+		return GL_UNSIGNED_BYTE;
+	case VertexType::SHORT:
+		return GL_SHORT;
+	case VertexType::UNSIGNED_SHORT:
+		return GL_UNSIGNED_SHORT;
+	case VertexType::INT:
+		return GL_INT;
+	case VertexType::UNSIGNED_INT:
+		return GL_UNSIGNED_INT;
+	default:
+		return GL_FLOAT;
+	}
+}
+
 GLuint viking::opengl::OpenGLModelPool::GetVAO()
 {
 	return vao;
 }
 
+GLuint viking::opengl::OpenGLModelPool::GetSortTexture()
+{
+	return m_textureBuffers.empty() ? 0 : m_textureBuffers.front()->GetId();
+}
+
+void viking::opengl::OpenGLModelPool::prepare(bool copy)
+{
+	m_frame_models = static_cast<unsigned int>(m_models.size());
+
+	if (m_instance_base != nullptr)
+	{
+		SetFrameData(m_frame_instance, m_instance_data->getPtr(), m_instance_data->getBufferSize(), copy);
+	}
+	for (auto buffer : m_indexed_buffers)
+	{
+		SetFrameData(m_frame_indexed[buffer.first], buffer.second->getPtr(), (size_t)m_frame_models * buffer.second->getIndexSize(), copy);
+	}
+
+	for (auto buffer : m_buffers)
+	{
+		buffer->prepare(copy);
+	}
+}
+
+void viking::opengl::OpenGLModelPool::SetFrameData(FrameData & frame, const void * data, size_t size, bool copy)
+{
+	if (!copy)
+	{
+		frame.data = (const char*)data;
+		return;
+	}
+	frame.copy.resize(size);
+	memcpy(frame.copy.data(), data, size);
+	frame.data = frame.copy.data();
+}
+
 void viking::opengl::OpenGLModelPool::render(GLuint programID)
 {
-	for (auto b : m_base->vertex_bindings)
+	m_state->bindVertexArray(vao);
+
+	GLintptr instance_offset = 0;
+	GLuint instance_buffer = 0;
+	if (m_instance_base != nullptr)
 	{
-		glEnableVertexAttribArray(b.GetLocation());
-		glVertexAttribPointer(b.GetLocation(), b.GetSize() / sizeof(float), GL_FLOAT, GL_FALSE, m_base->size, (GLvoid*)b.GetOffset());
+		// Instance data is small, so it is simply sent again every frame
+		instance_offset = m_stream->write(m_frame_instance.data, m_instance_data->getBufferSize(), m_instance_base->size);
+		instance_buffer = m_stream->getBuffer();
 	}
 //	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
 	for (auto buffer : m_buffers)
 	{
-		glBindBuffer(GL_UNIFORM_BUFFER, buffer->getUBO());
-		glBufferSubData(GL_UNIFORM_BUFFER, 0, buffer->getBufferSize(), buffer->getPtr());
-		glBindBufferRange(GL_UNIFORM_BUFFER, buffer->GetBinding(), buffer->getUBO(), 0, buffer->getBufferSize() * m_models.size());
+		buffer->bind(m_stream, m_capabilities);
 	}
 
 	for (auto tex_buffer : m_textureBuffers)
 	{
-		glBindTexture(GL_TEXTURE_2D, tex_buffer->GetId());
-		
+		m_state->bindTexture(0, GL_TEXTURE_2D, tex_buffer->GetId());
 	}
 
-	GLint max_buffer_size;
-	glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &max_buffer_size);
-
-	int totalToDraw = m_models.size();
+	int totalToDraw = m_frame_models;
 	int maxPerDraw = totalToDraw;
 
+	// Uniform buffers only hold a slice of the models, the storage and texture buffer paths fit them all
 	for (auto buffer = m_indexed_buffers.begin(); buffer != m_indexed_buffers.end(); buffer++)
 	{
-		if (buffer->second->getBufferSize() > max_buffer_size)
+		int currentMax = m_capabilities->getMaxInstances(buffer->second->getIndexSize());
+		if (currentMax < maxPerDraw)
 		{
-			if (buffer->second->getBufferSize() > max_buffer_size)
-			{
-				int currentMax = max_buffer_size / buffer->second->getIndexSize();
-
-				if (currentMax < maxPerDraw)
-				{
-					maxPerDraw = currentMax;
-				}
-
-			}
+			maxPerDraw = currentMax;
 		}
 	}
 
-	int itterations = totalToDraw / maxPerDraw;
+	int itterations = maxPerDraw > 0 ? (totalToDraw + maxPerDraw - 1) / maxPerDraw : 0;
 
 	for (int i = 0; i < itterations; i++)
 	{
-
+		const int count = totalToDraw < maxPerDraw ? totalToDraw : maxPerDraw;
 
 		for (auto buffer = m_indexed_buffers.begin(); buffer != m_indexed_buffers.end(); buffer++)
 		{
-			glBindBuffer(GL_UNIFORM_BUFFER, buffer->second->getUBO());
-			glBufferSubData(GL_UNIFORM_BUFFER, 0, maxPerDraw * buffer->second->getIndexSize(), buffer->second->getDataPtr(i * maxPerDraw));
-			glBindBufferRange(GL_UNIFORM_BUFFER, buffer->second->GetBinding(), buffer->second->getUBO(), 0, maxPerDraw * buffer->second->getIndexSize());
+			UploadIndexed(buffer->first, buffer->second, i * maxPerDraw, count);
 		}
 
-		glBindVertexArray(vao);
+		// Instance attributes start at the first model of this batch
+		if (m_instance_base != nullptr)
+		{
+			m_state->bindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+			for (auto b : m_instance_base->vertex_bindings)
+			{
+				SetAttribute(b, m_instance_base->size, (size_t)instance_offset + (size_t)i * maxPerDraw * m_instance_base->size);
+			}
+		}
 
-		glDrawElementsInstanced(GL_TRIANGLES, m_index_data->getElementCount(), GL_UNSIGNED_SHORT, 0, totalToDraw < maxPerDraw ? totalToDraw : maxPerDraw);
+		glDrawElementsInstanced(GL_TRIANGLES, m_index_data->getElementCount(), GL_UNSIGNED_SHORT, 0, count);
 
 		totalToDraw -= maxPerDraw;
 	}
+}
 
+void viking::opengl::OpenGLModelPool::UploadIndexed(unsigned int index, OpenGLUniformBuffer * buffer, unsigned int first, unsigned int count)
+{
+	const GLsizeiptr size = count * buffer->getIndexSize();
+	const GLuint binding = buffer->GetBinding();
+	const char* data = m_frame_indexed[index].data + (size_t)first * buffer->getIndexSize();
 
-	for (auto b : m_base->vertex_bindings)
+	GLintptr offset;
+
+	switch (m_capabilities->instance_storage)
 	{
-		glDisableVertexAttribArray(b.GetLocation());
+	case InstanceStorage::SHADER_STORAGE_BUFFER:
+		offset = m_stream->write(data, size, m_capabilities->shader_storage_alignment);
+		m_state->bindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, m_stream->getBuffer(), offset, size);
+		break;
+	case InstanceStorage::TEXTURE_BUFFER:
+		// The samplerBuffer for binding N is read from texture unit N. Pointing the texture at a range of the
+		// stream needs glTexBufferRange from GL 4.3, where storage buffers are used instead, so it is orphaned
+		m_state->bindBuffer(GL_TEXTURE_BUFFER, m_instance_storage[index].buffer);
+		glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+		m_state->bindTexture(binding, GL_TEXTURE_BUFFER, m_instance_storage[index].texture);
+		break;
+	default:
+		offset = m_stream->write(data, size, m_capabilities->uniform_buffer_alignment);
+		m_state->bindBufferRange(GL_UNIFORM_BUFFER, binding, m_stream->getBuffer(), offset, size);
+		break;
+	}
+}
+
+void viking::opengl::OpenGLModelPool::SetAttribute(VertexBinding & binding, unsigned int stride, size_t offset)
+{
+	GLvoid* pointer = (GLvoid*)(binding.GetOffset() + offset);
+	if (binding.GetMode() == VertexMode::INTEGER)
+	{
+		glVertexAttribIPointer(binding.GetLocation(), binding.GetComponentCount(), GetGLType(binding.GetType()), stride, pointer);
+	}
+	else
+	{
+		glVertexAttribPointer(binding.GetLocation(), binding.GetComponentCount(), GetGLType(binding.GetType()), binding.GetMode() == VertexMode::NORMALIZED ? GL_TRUE : GL_FALSE, stride, pointer);
 	}
 }
 
@@ -120,6 +223,20 @@ IModel * viking::opengl::OpenGLModelPool::createModel()
 void viking::opengl::OpenGLModelPool::attachBuffer(unsigned int index, IUniformBuffer * buffer)
 {
 	m_indexed_buffers[index] = dynamic_cast<OpenGLUniformBuffer*>(buffer);
+
+	if (m_capabilities->instance_storage != InstanceStorage::TEXTURE_BUFFER || m_instance_storage.count(index) != 0)
+	{
+		return;
+	}
+
+	IndexedStorage storage = {};
+	glGenBuffers(1, &storage.buffer);
+	m_state->bindBuffer(GL_TEXTURE_BUFFER, storage.buffer);
+	glBufferData(GL_TEXTURE_BUFFER, buffer->getBufferSize(), nullptr, GL_STREAM_DRAW);
+	glGenTextures(1, &storage.texture);
+	m_state->bindTexture(buffer->GetBinding(), GL_TEXTURE_BUFFER, storage.texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, storage.buffer);
+	m_instance_storage[index] = storage;
 }
 
 void viking::opengl::OpenGLModelPool::attachBuffer(IUniformBuffer * buffer)
@@ -131,3 +248,31 @@ void viking::opengl::OpenGLModelPool::attachBuffer(ITextureBuffer * buffer)
 {
 	m_textureBuffers.push_back(dynamic_cast<OpenGLTextureBuffer*>(buffer));
 }
+
+void viking::opengl::OpenGLModelPool::setBuffers(IBuffer * vertex_data, IBuffer * index_data)
+{
+	m_vertex_data = vertex_data;
+	m_index_data = index_data;
+
+	m_state->bindVertexArray(vao);
+
+	m_state->bindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertex_data->getBufferSize(), vertex_data->getPtr(), GL_STATIC_DRAW);
+
+	m_state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_data->getBufferSize(), index_data->getPtr(), GL_STATIC_DRAW);
+}
+
+void viking::opengl::OpenGLModelPool::setInstanceBuffer(viking::VertexBufferBase * instance, IBuffer * instance_data)
+{
+	m_instance_base = instance;
+	m_instance_data = instance_data;
+
+	// The pointers move with the instance data every frame, only the enables and divisors are set here
+	m_state->bindVertexArray(vao);
+	for (auto b : instance->vertex_bindings)
+	{
+		glEnableVertexAttribArray(b.GetLocation());
+		glVertexAttribDivisor(b.GetLocation(), 1);
+	}
+}
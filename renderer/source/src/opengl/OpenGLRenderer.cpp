@@ -9,14 +9,70 @@
 using namespace viking::opengl;
 using namespace viking;
 
+OpenGLRenderer::~OpenGLRenderer()
+{
+	stopRenderThread();
+}
+
+void OpenGLRenderer::prepareFrame(bool copy)
+{
+	for (auto pipeline : m_graphics_pipeline)
+	{
+		pipeline->record(m_recorder);
+	}
+
+	// A drawable recorded more than once is prepared more than once, which only repeats the same work
+	m_commands = &m_queue.sort();
+	for (const RenderCommand& command : *m_commands)
+	{
+		switch (command.type)
+		{
+		case RenderCommandType::MODEL_POOL:
+			static_cast<OpenGLModelPool*>(static_cast<IModelPool*>(command.drawable))->prepare(copy);
+			break;
+		case RenderCommandType::MESH_BATCH:
+			static_cast<OpenGLMeshBatch*>(static_cast<IMeshBatch*>(command.drawable))->prepare(copy);
+			break;
+		}
+	}
+
+	m_upload_stats = m_stream->getLastFrameStats();
+	m_state_stats = m_state.getLastFrameStats();
+}
+
 void OpenGLRenderer::render()
 {
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	for (auto pipeline : m_graphics_pipeline)
+	if (m_commands == nullptr)
+	{
+		return;
+	}
+
+	// Sorted by pipeline first, so the program only changes when the pipeline does
+	OpenGLGraphicsPipeline* bound = nullptr;
+	for (const RenderCommand& command : *m_commands)
 	{
-		pipeline->render();
+		OpenGLGraphicsPipeline* pipeline = static_cast<OpenGLGraphicsPipeline*>(command.pipeline);
+		if (pipeline != bound)
+		{
+			pipeline->bind();
+			bound = pipeline;
+		}
+
+		switch (command.type)
+		{
+		case RenderCommandType::MODEL_POOL:
+			static_cast<OpenGLModelPool*>(static_cast<IModelPool*>(command.drawable))->render(pipeline->GetProgram());
+			break;
+		case RenderCommandType::MESH_BATCH:
+			static_cast<OpenGLMeshBatch*>(static_cast<IMeshBatch*>(command.drawable))->render();
+			break;
+		}
 	}
+
+	m_stream->nextFrame();
+	m_state.nextFrame();
 }
 
 IComputePipeline * viking::opengl::OpenGLRenderer::createComputePipeline(const char* path, unsigned int x, unsigned int y, unsigned int z)
@@ -31,18 +87,23 @@ IComputeProgram * viking::opengl::OpenGLRenderer::createComputeProgram()
 
 IGraphicsPipeline * viking::opengl::OpenGLRenderer::createGraphicsPipeline(std::map<ShaderStage, const char*> shader_paths)
 {
-	OpenGLGraphicsPipeline* m_pipeline = new OpenGLGraphicsPipeline(shader_paths);
+	OpenGLGraphicsPipeline* m_pipeline = new OpenGLGraphicsPipeline(shader_paths, &m_capabilities, &m_state);
 	m_graphics_pipeline.push_back(m_pipeline);
 	return m_pipeline;
 }
 
 IModelPool * viking::opengl::OpenGLRenderer::createModelPool(VertexBufferBase* base, IBuffer* vertex_data, IBuffer*index_data)
 {
-	OpenGLModelPool* pool = new OpenGLModelPool(base, vertex_data, index_data);
+	OpenGLModelPool* pool = new OpenGLModelPool(base, vertex_data, index_data, &m_capabilities, m_stream, &m_state);
 	m_model_pool.push_back(pool);
 	return pool;
 }
 
+IMeshBatch * viking::opengl::OpenGLRenderer::createMeshBatch(VertexBufferBase * vertex, VertexBufferBase * instance)
+{
+	return new OpenGLMeshBatch(vertex, instance, &m_capabilities, m_stream, &m_state);
+}
+
 IBuffer * viking::opengl::OpenGLRenderer::createBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount)
 {
 	return new OpenGLBuffer(dataPtr, indexSize, elementCount);
@@ -50,16 +111,36 @@ IBuffer * viking::opengl::OpenGLRenderer::createBuffer(void * dataPtr, unsigned
 
 IUniformBuffer * viking::opengl::OpenGLRenderer::createUniformBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount, ShaderStage shader_stage, unsigned int binding)
 {
-	return new OpenGLUniformBuffer(dataPtr,indexSize,elementCount,binding);
+	return new OpenGLUniformBuffer(dataPtr, indexSize, elementCount, binding, &m_state);
 }
 
 ITextureBuffer * viking::opengl::OpenGLRenderer::createTextureBuffer(void * dataPtr, unsigned int width, unsigned int height)
 {
-	return new OpenGLTextureBuffer(dataPtr, width, height);
+	return new OpenGLTextureBuffer(dataPtr, width, height, &m_state);
+}
+
+const OpenGLStateStats & viking::opengl::OpenGLRenderer::getStateStats() const
+{
+	return m_state_stats;
+}
+
+const OpenGLCapabilities & viking::opengl::OpenGLRenderer::getCapabilities() const
+{
+	return m_capabilities;
+}
+
+const OpenGLUploadStats & viking::opengl::OpenGLRenderer::getUploadStats() const
+{
+	return m_upload_stats;
 }
 
 void OpenGLRenderer::start()
 {
+	// Pipelines and pools read the capabilities, so they have to be created after start
+	m_capabilities.query((GLADloadproc)SDL_GL_GetProcAddress);
+	m_stream = new OpenGLStreamBuffer(&m_capabilities, &m_state);
+	m_recorder = m_queue.createRecorder();
+
     glClearColor(0.2f, 0.2f, 0.2f, 1.f);
 	glEnable(GL_DEPTH_TEST);
 	glCullFace(GL_FRONT);
@@ -23,3 +23,13 @@ OpenGLSDLWindow::OpenGLSDLWindow(WindowDescriptor descriptor): SDLWindow(Windowi
 	// You may need to change this to 16 or 32 for your system
 	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 }
+
+void OpenGLSDLWindow::makeContextCurrent()
+{
+	SDL_GL_MakeCurrent(m_window, m_context);
+}
+
+void OpenGLSDLWindow::releaseContext()
+{
+	SDL_GL_MakeCurrent(m_window, nullptr);
+}
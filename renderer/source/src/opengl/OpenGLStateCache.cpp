@@ -0,0 +1,235 @@
+#include <viking/opengl/OpenGLStateCache.hpp>
+
+using namespace viking::opengl;
+using namespace viking;
+
+viking::opengl::OpenGLStateCache::OpenGLStateCache()
+{
+	invalidate();
+}
+
+void viking::opengl::OpenGLStateCache::useProgram(GLuint program)
+{
+	if (m_program == program)
+	{
+		m_stats.elided++;
+		return;
+	}
+	glUseProgram(program);
+	m_program = program;
+	m_stats.issued++;
+}
+
+void viking::opengl::OpenGLStateCache::bindVertexArray(GLuint vao)
+{
+	if (m_vao == vao)
+	{
+		m_stats.elided++;
+		return;
+	}
+	glBindVertexArray(vao);
+	m_vao = vao;
+	m_stats.issued++;
+}
+
+void viking::opengl::OpenGLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	const int slot = BufferSlot(target);
+	if (slot >= 0 && m_buffers[slot] == buffer)
+	{
+		m_stats.elided++;
+		return;
+	}
+	glBindBuffer(target, buffer);
+	if (slot >= 0)
+	{
+		m_buffers[slot] = buffer;
+	}
+	m_stats.issued++;
+}
+
+void viking::opengl::OpenGLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	std::vector<BufferRange>* ranges = Ranges(target);
+	if (ranges != nullptr)
+	{
+		if (index >= ranges->size())
+		{
+			ranges->resize(index + 1, {UNKNOWN, 0, 0});
+		}
+		BufferRange& range = (*ranges)[index];
+		if (range.buffer == buffer && range.offset == offset && range.size == size)
+		{
+			m_stats.elided++;
+			return;
+		}
+		range = {buffer, offset, size};
+	}
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	const int slot = BufferSlot(target);
+	if (slot >= 0)
+	{
+		m_buffers[slot] = buffer;
+	}
+	m_stats.issued++;
+}
+
+void viking::opengl::OpenGLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+	// Switched even when the bind is skipped, callers follow up with calls like glTexBuffer that act on the active unit
+	if (m_active_unit != unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		m_active_unit = unit;
+		m_stats.issued++;
+	}
+	GLuint* bound = Texture(unit, target);
+	if (bound != nullptr && *bound == texture)
+	{
+		m_stats.elided++;
+		return;
+	}
+	glBindTexture(target, texture);
+	if (bound != nullptr)
+	{
+		*bound = texture;
+	}
+	m_stats.issued++;
+}
+
+void viking::opengl::OpenGLStateCache::deleteBuffers(GLsizei count, const GLuint * buffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (GLuint& bound : m_buffers)
+		{
+			if (bound == buffers[i])
+			{
+				bound = 0;
+			}
+		}
+		for (std::vector<BufferRange>* ranges : {&m_uniform_ranges, &m_storage_ranges})
+		{
+			for (BufferRange& range : *ranges)
+			{
+				// Whether indexed bindings are reset differs between drivers
+				if (range.buffer == buffers[i])
+				{
+					range = {UNKNOWN, 0, 0};
+				}
+			}
+		}
+	}
+	glDeleteBuffers(count, buffers);
+}
+
+void viking::opengl::OpenGLStateCache::deleteVertexArrays(GLsizei count, const GLuint * arrays)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (m_vao == arrays[i])
+		{
+			m_vao = 0;
+		}
+	}
+	glDeleteVertexArrays(count, arrays);
+}
+
+void viking::opengl::OpenGLStateCache::deleteTextures(GLsizei count, const GLuint * textures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (TextureUnit& unit : m_textures)
+		{
+			if (unit.texture_2d == textures[i])
+			{
+				unit.texture_2d = 0;
+			}
+			if (unit.texture_buffer == textures[i])
+			{
+				unit.texture_buffer = 0;
+			}
+		}
+	}
+	glDeleteTextures(count, textures);
+}
+
+void viking::opengl::OpenGLStateCache::invalidate()
+{
+	m_program = UNKNOWN;
+	m_vao = UNKNOWN;
+	for (GLuint& bound : m_buffers)
+	{
+		bound = UNKNOWN;
+	}
+	m_uniform_ranges.clear();
+	m_storage_ranges.clear();
+	m_active_unit = UNKNOWN;
+	m_textures.clear();
+}
+
+const OpenGLStateStats & viking::opengl::OpenGLStateCache::getStats() const
+{
+	return m_stats;
+}
+
+const OpenGLStateStats & viking::opengl::OpenGLStateCache::getLastFrameStats() const
+{
+	return m_last_stats;
+}
+
+void viking::opengl::OpenGLStateCache::nextFrame()
+{
+	m_last_stats = m_stats;
+	m_stats = OpenGLStateStats();
+}
+
+int viking::opengl::OpenGLStateCache::BufferSlot(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:
+		return 0;
+	case GL_COPY_READ_BUFFER:
+		return 1;
+	case GL_COPY_WRITE_BUFFER:
+		return 2;
+	case GL_UNIFORM_BUFFER:
+		return 3;
+	case GL_TEXTURE_BUFFER:
+		return 4;
+	case GL_DRAW_INDIRECT_BUFFER:
+		return 5;
+	case GL_SHADER_STORAGE_BUFFER:
+		return 6;
+	default:
+		return -1;
+	}
+}
+
+std::vector<OpenGLStateCache::BufferRange>* viking::opengl::OpenGLStateCache::Ranges(GLenum target)
+{
+	switch (target)
+	{
+	case GL_UNIFORM_BUFFER:
+		return &m_uniform_ranges;
+	case GL_SHADER_STORAGE_BUFFER:
+		return &m_storage_ranges;
+	default:
+		return nullptr;
+	}
+}
+
+GLuint * viking::opengl::OpenGLStateCache::Texture(GLuint unit, GLenum target)
+{
+	if (target != GL_TEXTURE_2D && target != GL_TEXTURE_BUFFER)
+	{
+		return nullptr;
+	}
+	if (unit >= m_textures.size())
+	{
+		m_textures.resize(unit + 1, {UNKNOWN, UNKNOWN});
+	}
+	return target == GL_TEXTURE_2D ? &m_textures[unit].texture_2d : &m_textures[unit].texture_buffer;
+}
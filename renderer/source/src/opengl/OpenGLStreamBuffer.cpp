@@ -0,0 +1,161 @@
+#include <viking/opengl/OpenGLStreamBuffer.hpp>
+
+#include <cstring>
+
+using namespace viking::opengl;
+using namespace viking;
+
+viking::opengl::OpenGLStreamBuffer::OpenGLStreamBuffer(const OpenGLCapabilities * capabilities, OpenGLStateCache * state, unsigned int region_size, unsigned int regions) :
+	m_capabilities(capabilities), m_state(state), m_buffer(0), m_mapped(nullptr), m_region_size(0), m_regions(1), m_region(0), m_offset(0), m_frame(0)
+{
+	// Orphaning hands the driver a fresh copy of the storage each frame, so one region is enough
+	if (m_capabilities->buffer_storage)
+	{
+		m_regions = regions;
+	}
+	Create(region_size);
+}
+
+viking::opengl::OpenGLStreamBuffer::~OpenGLStreamBuffer()
+{
+	Retire();
+	m_state->deleteBuffers((GLsizei)m_retired.size(), m_retired.data());
+}
+
+GLintptr viking::opengl::OpenGLStreamBuffer::write(const void * data, unsigned int size, unsigned int alignment)
+{
+	unsigned int offset = (m_offset + alignment - 1) / alignment * alignment;
+	if (offset + size > m_region_size)
+	{
+		// The new buffer has no frames in flight to wait for
+		unsigned int region_size = m_region_size * 2;
+		while (region_size < size)
+		{
+			region_size *= 2;
+		}
+		Retire();
+		Create(region_size);
+		offset = 0;
+	}
+
+	const GLintptr start = (GLintptr)m_region * m_region_size + offset;
+	if (m_mapped != nullptr)
+	{
+		memcpy(m_mapped + start, data, size);
+	}
+	else
+	{
+		m_state->bindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, start, size, data);
+	}
+	m_offset = offset + size;
+	m_stats.stream_bytes += size;
+	return start;
+}
+
+GLuint viking::opengl::OpenGLStreamBuffer::getBuffer() const
+{
+	return m_buffer;
+}
+
+unsigned int viking::opengl::OpenGLStreamBuffer::getFrame() const
+{
+	return m_frame;
+}
+
+void viking::opengl::OpenGLStreamBuffer::nextFrame()
+{
+	m_offset = 0;
+	m_frame++;
+	m_last_stats = m_stats;
+	m_stats = OpenGLUploadStats();
+
+	if (!m_retired.empty())
+	{
+		m_state->deleteBuffers((GLsizei)m_retired.size(), m_retired.data());
+		m_retired.clear();
+	}
+
+	if (m_mapped == nullptr)
+	{
+		m_state->bindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, m_region_size, nullptr, GL_STREAM_DRAW);
+		return;
+	}
+
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_region = (m_region + 1) % m_regions;
+
+	GLsync fence = m_fences[m_region];
+	if (fence != nullptr)
+	{
+		// Only blocks when the GPU is more than m_regions - 1 frames behind
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		GLenum result;
+		do
+		{
+			result = glClientWaitSync(fence, flags, 1000000000);
+			flags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		m_fences[m_region] = nullptr;
+	}
+}
+
+bool viking::opengl::OpenGLStreamBuffer::isPersistent() const
+{
+	return m_mapped != nullptr;
+}
+
+OpenGLUploadStats & viking::opengl::OpenGLStreamBuffer::getStats()
+{
+	return m_stats;
+}
+
+const OpenGLUploadStats & viking::opengl::OpenGLStreamBuffer::getLastFrameStats() const
+{
+	return m_last_stats;
+}
+
+void viking::opengl::OpenGLStreamBuffer::Create(unsigned int region_size)
+{
+	m_region_size = region_size;
+	m_region = 0;
+	m_offset = 0;
+	m_fences.assign(m_regions, nullptr);
+
+	const GLsizeiptr size = (GLsizeiptr)m_region_size * m_regions;
+	glGenBuffers(1, &m_buffer);
+	m_state->bindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+	if (m_capabilities->buffer_storage)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		m_capabilities->BufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+		m_mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+void viking::opengl::OpenGLStreamBuffer::Retire()
+{
+	for (GLsync fence : m_fences)
+	{
+		if (fence != nullptr)
+		{
+			glDeleteSync(fence);
+		}
+	}
+	m_fences.clear();
+
+	if (m_mapped != nullptr)
+	{
+		m_state->bindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		m_mapped = nullptr;
+	}
+	m_retired.push_back(m_buffer);
+	m_buffer = 0;
+}
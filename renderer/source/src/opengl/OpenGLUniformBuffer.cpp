@@ -1,47 +1,106 @@
 #include <viking/opengl/OpenGLUniformBuffer.hpp>
 
+#include <cstring>
+
 using namespace viking::opengl;
 using namespace viking;
 
-viking::opengl::OpenGLUniformBuffer::OpenGLUniformBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount, unsigned int binding) :
+viking::opengl::OpenGLUniformBuffer::OpenGLUniformBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount, unsigned int binding, OpenGLStateCache * state) :
 	IDescriptor(DescriptorType::UNIFORM, ShaderStage::VERTEX_SHADER, binding) // DescriptorType and Shader stage not needed for GL
 {
 	m_dataPtr = dataPtr;
 	m_bufferSize = indexSize * elementCount;
 	m_indexSize = indexSize;
 	m_elementCount = elementCount;
+	m_state = state;
+}
+
+viking::opengl::OpenGLUniformBuffer::~OpenGLUniformBuffer()
+{
+	if (ubo != 0)
+	{
+		m_state->deleteBuffers(1, &ubo);
+	}
+}
 
-	GLint max_buffer_size;
-	glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &max_buffer_size);
+void viking::opengl::OpenGLUniformBuffer::prepare(bool copy)
+{
+	// The GL buffer is made by the first bind, which has to fill all of it
+	if (ubo == 0)
+	{
+		setData();
+	}
+
+	for (auto range : m_dirty)
+	{
+		AddRange(m_frame, range.first, range.second);
+	}
+	m_dirty.clear();
 
-	glGenBuffers(1, &ubo);
-	glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-	glBufferData(GL_UNIFORM_BUFFER, m_bufferSize > max_buffer_size ? max_buffer_size : m_bufferSize, 0, GL_STREAM_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	// Ranges a bind has not consumed yet are copied again, they may come from a prepare that did not copy
+	m_copied = copy;
+	if (copy && !m_frame.empty())
+	{
+		m_copy.resize(m_bufferSize);
+		for (auto range : m_frame)
+		{
+			memcpy(m_copy.data() + range.first * m_indexSize, getDataPtr(range.first), (range.second - range.first) * m_indexSize);
+		}
+	}
 }
 
-GLuint viking::opengl::OpenGLUniformBuffer::getUBO()
+void viking::opengl::OpenGLUniformBuffer::bind(OpenGLStreamBuffer * stream, const OpenGLCapabilities * capabilities)
 {
-	return ubo;
+	// Indexed buffers only ever go through the stream, so the GL buffer is made on first bind
+	if (ubo == 0)
+	{
+		glGenBuffers(1, &ubo);
+		m_state->bindBuffer(GL_COPY_WRITE_BUFFER, ubo);
+		glBufferData(GL_COPY_WRITE_BUFFER, m_bufferSize, nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	if (!m_frame.empty())
+	{
+		OpenGLUploadStats& stats = stream->getStats();
+		for (auto range : m_frame)
+		{
+			const unsigned int offset = range.first * m_indexSize;
+			const unsigned int size = (range.second - range.first) * m_indexSize;
+			const void* data = m_copied ? (const void*)(m_copy.data() + offset) : getDataPtr(range.first);
+			const GLintptr source = stream->write(data, size);
+			m_state->bindBuffer(GL_COPY_READ_BUFFER, stream->getBuffer());
+			m_state->bindBuffer(GL_COPY_WRITE_BUFFER, ubo);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source, offset, size);
+			stats.uniform_bytes += size;
+			stats.uniform_ranges++;
+		}
+		m_frame.clear();
+	}
+
+	const GLsizeiptr size = m_bufferSize < (unsigned int)capabilities->max_uniform_block_size ? m_bufferSize : capabilities->max_uniform_block_size;
+	m_state->bindBufferRange(GL_UNIFORM_BUFFER, GetBinding(), ubo, 0, size);
 }
 
 void viking::opengl::OpenGLUniformBuffer::setData()
 {
-	/*glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-	GLvoid* p = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
-	memcpy(p, &m_dataPtr, m_bufferSize);
-	glUnmapBuffer(GL_UNIFORM_BUFFER);*/
+	setData(0, m_elementCount);
 }
 
 void viking::opengl::OpenGLUniformBuffer::setData(unsigned int count)
 {
+	setData(0, count);
 }
 
 void viking::opengl::OpenGLUniformBuffer::setData(unsigned int startIndex, unsigned int count)
 {
+	const unsigned int end = startIndex + count < m_elementCount ? startIndex + count : m_elementCount;
+	if (startIndex < end)
+	{
+		AddRange(m_dirty, startIndex, end);
+	}
 }
 
 void * viking::opengl::OpenGLUniformBuffer::getDataPtr(unsigned int startIndex)
 {
 	return (char*)m_dataPtr + (m_indexSize * startIndex);
-}
\ No newline at end of file
+}
@@ -14,12 +14,19 @@ VulkanRenderer::VulkanRenderer()
 
 VulkanRenderer::~VulkanRenderer()
 {
+	stopRenderThread();
 	delete m_swapchain;
 	delete m_device;
     delete m_pdevice;
     delete m_instance;
 }
 
+void VulkanRenderer::prepareFrame(bool copy)
+{
+	// No graphics pipelines on this backend yet, so there is nothing to replay
+	m_queue.clear();
+}
+
 void VulkanRenderer::render()
 {
 	m_swapchain->render();
@@ -58,6 +65,11 @@ IModelPool * viking::vulkan::VulkanRenderer::createModelPool(VertexBufferBase* b
 	return nullptr;
 }
 
+IMeshBatch * viking::vulkan::VulkanRenderer::createMeshBatch(VertexBufferBase * vertex, VertexBufferBase * instance)
+{
+	return nullptr;
+}
+
 IBuffer * viking::vulkan::VulkanRenderer::createBuffer(void * dataPtr, unsigned int indexSize, unsigned int elementCount)
 {
 	return nullptr;